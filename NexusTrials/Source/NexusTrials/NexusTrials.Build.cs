@@ -15,6 +15,8 @@ public class NexusTrials : ModuleRules
                         "InputCore",
                         "EnhancedInput",
                         "AIModule",
+                        "NavigationSystem",
+                        "GameplayTags",
                         "StateTreeModule",
                         "GameplayStateTreeModule",
                         "UMG",
@@ -5,4 +5,6 @@
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, NexusTrials, "NexusTrials" );
 
-DEFINE_LOG_CATEGORY(LogNexusTrials)
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogNexusTrials)
+
+CSV_DEFINE_CATEGORY(NexusTrials, true);
\ No newline at end of file
@@ -3,6 +3,14 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
 
 /** Main log category used across the project */
-DECLARE_LOG_CATEGORY_EXTERN(LogNexusTrials, Log, All);
\ No newline at end of file
+DECLARE_LOG_CATEGORY_EXTERN(LogNexusTrials, Log, All);
+
+/** Stat group for the project's gameplay systems. Use "stat NexusTrials" to display it */
+DECLARE_STATS_GROUP(TEXT("NexusTrials"), STATGROUP_NexusTrials, STATCAT_Advanced);
+
+/** CSV profiler category for the project's gameplay systems, read back by the combat benchmark */
+CSV_DECLARE_CATEGORY_EXTERN(NexusTrials);
@@ -10,6 +10,16 @@
 #include "Kismet/GameplayStatics.h"
 #include "Engine/World.h"
 #include "GameFramework/GameModeBase.h"
+#include "GameFramework/Pawn.h"
+#include "CombatMeleeMath.h"
+#include "CombatFaction.h"
+#include "CombatDamageableGrid.h"
+#include "CombatThreatSubsystem.h"
+#include "CombatSwingTracker.h"
+#include "Components/CapsuleComponent.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Performance/NexusFrameScratch.h"
+#include "Performance/NexusAllocationCounter.h"
 
 // ============================================================================
 // CHARACTER HEALTH & DAMAGE TESTS
@@ -456,3 +466,341 @@ NEXUS_PERF_TEST(FDashboardPerformanceShowcaseTest, "NexusTrials.Dashboard.Perfor
     
     return true;
 }
+
+// ============================================================================
+// COMBAT MELEE BROADPHASE TESTS
+// ============================================================================
+
+NEXUS_TEST(FCombatMeleeSweepMathTest, "NexusTrials.Combat.MeleeSweepVsCapsule", ETestPriority::Normal)
+{
+    // Validate the analytic sphere sweep used by the damageable grid against hand-computed cases
+    // Capsule standing at the origin: 35 radius, 90 half height
+    const FVector CapsuleA(0.0f, 0.0f, -55.0f);
+    const FVector CapsuleB(0.0f, 0.0f, 55.0f);
+    const float CapsuleRadius = 35.0f;
+
+    float Time = 0.0f;
+    FVector ImpactPoint, ImpactNormal;
+    bool bAllPassed = true;
+
+    // Sweep passing 100cm to the side with a 75cm sphere: 100 < 75 + 35, so it hits
+    const bool bGrazeHit = FCombatMeleeMath::SphereSweepVsCapsule(FVector(-200.0f, 100.0f, 0.0f), FVector(200.0f, 100.0f, 0.0f), 75.0f,
+        CapsuleA, CapsuleB, CapsuleRadius, Time, ImpactPoint, ImpactNormal);
+
+    if (!bGrazeHit || !FMath::IsNearlyEqual(Time, 0.5f, 0.01f) || !ImpactNormal.Equals(FVector(0.0f, 1.0f, 0.0f), 0.01f)
+        || !ImpactPoint.Equals(FVector(0.0f, 35.0f, 0.0f), 0.1f))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Grazing sweep: Hit=%d Time=%.2f Point=%s Normal=%s"),
+            bGrazeHit, Time, *ImpactPoint.ToString(), *ImpactNormal.ToString());
+        bAllPassed = false;
+    }
+
+    // Same sweep 120cm to the side: 120 > 110, so it misses
+    if (FCombatMeleeMath::SphereSweepVsCapsule(FVector(-200.0f, 120.0f, 0.0f), FVector(200.0f, 120.0f, 0.0f), 75.0f,
+        CapsuleA, CapsuleB, CapsuleRadius, Time, ImpactPoint, ImpactNormal))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Sweep outside the combined radius reported a hit"));
+        bAllPassed = false;
+    }
+
+    // Sweep over the top of the capsule hits the hemisphere, not the cylinder
+    if (!FCombatMeleeMath::SphereSweepVsCapsule(FVector(-200.0f, 0.0f, 150.0f), FVector(200.0f, 0.0f, 150.0f), 75.0f,
+        CapsuleA, CapsuleB, CapsuleRadius, Time, ImpactPoint, ImpactNormal) || !ImpactNormal.Equals(FVector::UpVector, 0.01f))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Sweep over the cap: Normal=%s"), *ImpactNormal.ToString());
+        bAllPassed = false;
+    }
+
+    // Zero length sweep starting inside the capsule still reports an overlap
+    if (!FCombatMeleeMath::SphereSweepVsCapsule(FVector(10.0f, 0.0f, 0.0f), FVector(10.0f, 0.0f, 0.0f), 10.0f,
+        CapsuleA, CapsuleB, CapsuleRadius, Time, ImpactPoint, ImpactNormal) || Time != 0.0f)
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Initial overlap not reported"));
+        bAllPassed = false;
+    }
+
+    if (bAllPassed)
+    {
+        UE_LOG(LogTemp, Display, TEXT("✅ Melee sweep vs capsule math matches expected hits"));
+    }
+
+    return bAllPassed;
+}
+
+// ============================================================================
+// COMBAT FACTION TESTS
+// ============================================================================
+
+NEXUS_TEST(FCombatFactionMatrixTest, "NexusTrials.Combat.FactionHostility", ETestPriority::Normal)
+{
+    // Validate the default hostility matrix keeps the old "Player" tag behavior and supports infighting
+    FCombatFactionMatrix Matrix = FCombatFactionMatrix::MakeDefault();
+    bool bAllPassed = true;
+
+    // Player and enemies fight each other, the player can break neutral props, enemies ignore them
+    if (!Matrix.IsHostile(ECombatFaction::Player, ECombatFaction::Enemy) || !Matrix.IsHostile(ECombatFaction::Enemy, ECombatFaction::Player)
+        || !Matrix.IsHostile(ECombatFaction::Player, ECombatFaction::Neutral) || Matrix.IsHostile(ECombatFaction::Enemy, ECombatFaction::Neutral))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Default player/enemy/neutral hostility is wrong"));
+        bAllPassed = false;
+    }
+
+    // Nobody hits their own faction by default
+    if (Matrix.IsHostile(ECombatFaction::Enemy, ECombatFaction::Enemy) || Matrix.IsHostile(ECombatFaction::Player, ECombatFaction::Player))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Friendly fire enabled by default"));
+        bAllPassed = false;
+    }
+
+    // Rows and columns stay in sync when hostility changes at runtime
+    Matrix.SetHostile(ECombatFaction::Enemy, ECombatFaction::Enemy, true);
+
+    if (!FCombatFactionMatrix::MaskHasFaction(Matrix.GetTargetMask(ECombatFaction::Enemy), ECombatFaction::Enemy)
+        || !FCombatFactionMatrix::MaskHasFaction(Matrix.GetAttackerMask(ECombatFaction::Enemy), ECombatFaction::Enemy))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Enemy infighting not reflected in both masks"));
+        bAllPassed = false;
+    }
+
+    Matrix.SetMutuallyHostile(ECombatFaction::Player, ECombatFaction::Enemy, false);
+
+    if (Matrix.IsHostile(ECombatFaction::Player, ECombatFaction::Enemy) || FCombatFactionMatrix::MaskHasFaction(Matrix.GetAttackerMask(ECombatFaction::Player), ECombatFaction::Enemy))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Clearing hostility left stale bits"));
+        bAllPassed = false;
+    }
+
+    if (bAllPassed)
+    {
+        UE_LOG(LogTemp, Display, TEXT("✅ Faction hostility matrix matches expected rules"));
+    }
+
+    return bAllPassed;
+}
+
+// ============================================================================
+// COMBAT SWING TRACKER TESTS
+// ============================================================================
+
+NEXUS_TEST(FCombatSwingTrackerTest, "NexusTrials.Combat.SwingTracker", ETestPriority::Normal)
+{
+    // Validate the attack window path sampling and the per-swing hit set
+    FCombatSwingTracker Tracker;
+    FCombatSwingTracker::FSwingPath Path;
+    bool bAllPassed = true;
+
+    // Quarter turn around the mesh at a 100cm radius, 141cm of chord: split into the max 8 segments, all on the arc
+    Tracker.Begin(FTransform::Identity, FVector(100.0f, 0.0f, 0.0f));
+    Tracker.Advance(FTransform::Identity, FVector(0.0f, 100.0f, 0.0f), 20.0f, Path);
+
+    bool bOnArc = Path.Num() == FCombatSwingTracker::MaxSubSamples + 1;
+
+    for (int32 PointIndex = 0; bOnArc && PointIndex < Path.Num(); ++PointIndex)
+    {
+        const float ExpectedAngle = UE_HALF_PI * PointIndex / (Path.Num() - 1);
+        bOnArc = Path[PointIndex].Equals(FVector(FMath::Cos(ExpectedAngle), FMath::Sin(ExpectedAngle), 0.0f) * 100.0f, 0.1f);
+    }
+
+    if (!bOnArc)
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Swing arc not sampled in polar coordinates: %d points, midpoint %s"),
+            Path.Num(), Path.IsValidIndex(Path.Num() / 2) ? *Path[Path.Num() / 2].ToString() : TEXT("none"));
+        bAllPassed = false;
+    }
+
+    // The next frame continues from the last sample, and short moves aren't split
+    Tracker.Advance(FTransform::Identity, FVector(0.0f, 110.0f, 0.0f), 20.0f, Path);
+
+    if (Path.Num() != 2 || !Path[0].Equals(FVector(0.0f, 100.0f, 0.0f), 0.1f) || !Path[1].Equals(FVector(0.0f, 110.0f, 0.0f), 0.1f))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Follow-up sample not connected to the previous one: %d points"), Path.Num());
+        bAllPassed = false;
+    }
+
+    // A socket passing through the mesh origin has no angle to follow, so it falls back to a straight line
+    Tracker.Begin(FTransform::Identity, FVector::ZeroVector);
+    Tracker.Advance(FTransform::Identity, FVector(0.0f, 0.0f, 100.0f), 50.0f, Path);
+
+    if (Path.Num() != 3 || !Path[1].Equals(FVector(0.0f, 0.0f, 50.0f), 0.1f))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Straight line fallback: %d points"), Path.Num());
+        bAllPassed = false;
+    }
+
+    // Each actor is hit once per swing, and a new swing starts over
+    const AActor* ActorA = GetDefault<AActor>();
+    const AActor* ActorB = GetDefault<APawn>();
+
+    if (!Tracker.RegisterHit(ActorA) || Tracker.RegisterHit(ActorA) || !Tracker.RegisterHit(ActorB) || Tracker.RegisterHit(nullptr))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Hits not de-duplicated within a swing"));
+        bAllPassed = false;
+    }
+
+    // Shapes of the same actor are separate targets, e.g. the boxes of a box field
+    if (!Tracker.RegisterHit(ActorA, 0) || !Tracker.RegisterHit(ActorA, 1) || Tracker.RegisterHit(ActorA, 1))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Hit items not tracked separately"));
+        bAllPassed = false;
+    }
+
+    Tracker.Begin(FTransform::Identity, FVector::ZeroVector);
+
+    if (!Tracker.RegisterHit(ActorA))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Hit set not cleared for a new swing"));
+        bAllPassed = false;
+    }
+
+    // Reach layers stay within one sphere diameter of each other
+    if (FCombatSwingTracker::GetNumReachLayers(75.0f, 50.0f) != 1 || FCombatSwingTracker::GetNumReachLayers(300.0f, 50.0f) != 3
+        || FCombatSwingTracker::GetNumReachLayers(0.0f, 50.0f) != 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Reach layer count is wrong"));
+        bAllPassed = false;
+    }
+
+    if (bAllPassed)
+    {
+        UE_LOG(LogTemp, Display, TEXT("✅ Swing tracker samples arcs and de-duplicates hits per swing"));
+    }
+
+    return bAllPassed;
+}
+
+// ============================================================================
+// FRAME ALLOCATION BUDGET TESTS
+// ============================================================================
+
+NEXUS_TEST_GAMETHREAD(FCombatFrameAllocationBudgetTest, "NexusTrials.Combat.FrameAllocationBudget", ETestPriority::Normal)
+{
+    // Run a scripted melee brawl for a number of simulated frames and count the game thread heap allocations per frame.
+    // Fails when the worst frame goes over the baseline stored in DefaultGame.ini, so new per-frame allocations in the
+    // melee query path get caught. Run with stat capture off, since the stats system allocates on its own
+    if (!Context.IsValid())
+    {
+        NEXUS_SKIP_TEST("No active game world - run 'Play' in editor first to test with PIE");
+    }
+
+    // Ring of combatants around the origin
+    constexpr int32 NumCombatants = 8;
+    constexpr int32 NumFrames = 30;
+    constexpr int32 SegmentsPerSwing = 6;
+    constexpr float RingRadius = 200.0f;
+
+    TArray<ACharacter*> Combatants;
+
+    for (int32 Index = 0; Index < NumCombatants; ++Index)
+    {
+        const float Angle = UE_TWO_PI * Index / NumCombatants;
+        const FVector Location(FMath::Cos(Angle) * RingRadius, FMath::Sin(Angle) * RingRadius, 100.0f);
+
+        if (ACharacter* Combatant = Cast<ACharacter>(Context.SpawnTestCharacter(ANexusTrialsCharacter::StaticClass(), Location)))
+        {
+            Combatants.Add(Combatant);
+        }
+    }
+
+    UCombatDamageableGrid* Grid = Combatants.Num() > 0 ? UCombatDamageableGrid::Get(Combatants[0]) : nullptr;
+    UCombatThreatSubsystem* ThreatField = Combatants.Num() > 0 ? UCombatThreatSubsystem::Get(Combatants[0]) : nullptr;
+
+    if (!Grid || !ThreatField)
+    {
+        NEXUS_SKIP_TEST("Combat world subsystems unavailable - run in a game or PIE world");
+    }
+
+    for (ACharacter* Combatant : Combatants)
+    {
+        Grid->Register(Combatant, Combatant->GetCapsuleComponent());
+    }
+
+    FCollisionObjectQueryParams ObjectParams;
+    ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+    ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+    // One frame of the brawl: every combatant swings across the ring, publishes its threat and checks for danger
+    auto RunFrame = [&](int32 Frame)
+    {
+        int32 NumHits = 0;
+
+        for (int32 Index = 0; Index < Combatants.Num(); ++Index)
+        {
+            ACharacter* Attacker = Combatants[Index];
+            const FVector Origin = Attacker->GetActorLocation();
+            const FVector Target = Combatants[(Index + Frame + 1) % Combatants.Num()]->GetActorLocation();
+
+            for (int32 Segment = 0; Segment < SegmentsPerSwing; ++Segment)
+            {
+                TNexusFrameArray<FHitResult> Hits;
+                const FVector SegmentStart = FMath::Lerp(Origin, Target, static_cast<float>(Segment) / SegmentsPerSwing);
+                const FVector SegmentEnd = FMath::Lerp(Origin, Target, static_cast<float>(Segment + 1) / SegmentsPerSwing);
+
+                UCombatDamageableGrid::SweepDamageables(Attacker, Hits, SegmentStart, SegmentEnd, 50.0f, ObjectParams, Attacker);
+                NumHits += Hits.Num();
+            }
+
+            ThreatField->PublishThreat(Attacker, Origin, Target - Origin, RingRadius * 2.0f, 100.0f, 1.0f);
+            ThreatField->FindLatestThreat(Origin, 35.0f, Attacker);
+        }
+
+        // Stand in for the end of the frame
+        FNexusFrameScratch::Get().Reset();
+
+        return NumHits;
+    };
+
+    // Warm up until the threat ring has wrapped and every attacker has swung at every target, so the ring slots,
+    // their cell lists, the threat cells and the scratch blocks have all grown to their steady state before counting
+    const int32 WarmupFrames = FMath::DivideAndRoundUp(UCombatThreatSubsystem::GetMaxThreats(), Combatants.Num()) + Combatants.Num();
+
+    for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+    {
+        RunFrame(Frame);
+    }
+
+    int64 WorstFrameAllocations = 0;
+    int32 TotalHits = 0;
+
+    {
+        // Scoped, so GMalloc is restored however this block is left
+        FNexusScopedAllocationCounter AllocationCounter;
+
+        for (int32 Frame = WarmupFrames; Frame < WarmupFrames + NumFrames; ++Frame)
+        {
+            AllocationCounter.ResetCount();
+            TotalHits += RunFrame(Frame);
+            WorstFrameAllocations = FMath::Max(WorstFrameAllocations, AllocationCounter.GetNumAllocations());
+        }
+    }
+
+    for (ACharacter* Combatant : Combatants)
+    {
+        Grid->Unregister(Combatant);
+    }
+
+    // Baseline lives in DefaultGame.ini so it can be tightened as allocations get removed.
+    // A missing baseline fails, so the budget can't silently stop being enforced
+    int32 Baseline = 0;
+
+    if (!GConfig->GetInt(TEXT("NexusTrials.AllocationBaselines"), TEXT("CombatMeleeFrame"), Baseline, GGameIni))
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ No CombatMeleeFrame allocation baseline under [NexusTrials.AllocationBaselines] in DefaultGame.ini: worst frame %lld (%d hits over %d frames)"),
+            WorstFrameAllocations, TotalHits, NumFrames);
+        return false;
+    }
+
+    const bool bWithinBaseline = WorstFrameAllocations <= Baseline;
+
+    if (bWithinBaseline)
+    {
+        UE_LOG(LogTemp, Display, TEXT("✅ Combat frame allocations: worst frame %lld, baseline %d (%d hits over %d frames)"),
+            WorstFrameAllocations, Baseline, TotalHits, NumFrames);
+    }
+    else
+    {
+        UE_LOG(LogTemp, Error, TEXT("❌ Combat frame allocations over baseline: worst frame %lld, baseline %d"),
+            WorstFrameAllocations, Baseline);
+    }
+
+    return bWithinBaseline;
+}
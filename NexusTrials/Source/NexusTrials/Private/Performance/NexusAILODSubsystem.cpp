@@ -0,0 +1,422 @@
+#include "Performance/NexusAILODSubsystem.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "NexusTrials.h"
+#include "AIController.h"
+#include "BrainComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("AI LOD Tick"), STAT_NexusAILODTick, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("AI LOD StateTree Evaluate"), STAT_NexusAILODEvaluate, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Full"), STAT_NexusAILODFull, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Reduced"), STAT_NexusAILODReduced, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Suspended"), STAT_NexusAILODSuspended, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AI LOD Evaluations"), STAT_NexusAILODEvaluations, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarAILODEnabled(
+    TEXT("Nexus.AILOD.Enable"),
+    true,
+    TEXT("If false, every registered AI controller evaluates its StateTree every frame. Use to A/B the AI LOD policy."));
+
+static FAutoConsoleCommandWithWorld CmdAILODReport(
+    TEXT("Nexus.AILOD.Report"),
+    TEXT("Logs the AI LOD distribution and estimated StateTree evaluations saved per second."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(World))
+        {
+            AILOD->LogReport();
+        }
+    }));
+
+namespace NexusAILOD
+{
+    /** Runs one StateTree evaluation outside of the brain's own tick */
+    static void Evaluate(UBrainComponent* Brain, float DeltaTime)
+    {
+        if (!Brain || !Brain->IsRegistered() || DeltaTime <= 0.0f)
+        {
+            return;
+        }
+
+        SCOPE_CYCLE_COUNTER(STAT_NexusAILODEvaluate);
+        INC_DWORD_STAT(STAT_NexusAILODEvaluations);
+
+        Brain->TickComponent(DeltaTime, LEVELTICK_All, &Brain->PrimaryComponentTick);
+    }
+}
+
+UNexusAILODSubsystem* UNexusAILODSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UNexusAILODSubsystem>() : nullptr;
+}
+
+bool UNexusAILODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNexusAILODSubsystem::Deinitialize()
+{
+    // Hand every brain back with its own tick running
+    for (FAILODEntry& Entry : Entries)
+    {
+        ApplyLOD(Entry, ENexusAILOD::Full);
+    }
+
+    Entries.Reset();
+    EntryIndices.Reset();
+
+    Super::Deinitialize();
+}
+
+void UNexusAILODSubsystem::RegisterController(AAIController* Controller)
+{
+    if (!IsValid(Controller) || !Controller->GetBrainComponent() || EntryIndices.Contains(Controller))
+    {
+        return;
+    }
+
+    FAILODEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Controller = Controller;
+    Entry.Key = Controller;
+    Entry.Brain = Controller->GetBrainComponent();
+
+    // Hand out phases in order so reduced evaluations spread evenly over the interval
+    Entry.Phase = NextPhase;
+    NextPhase = (NextPhase + 1) % ReducedFrameInterval;
+
+    EntryIndices.Add(Entry.Key, Entries.Num() - 1);
+}
+
+void UNexusAILODSubsystem::UnregisterController(AAIController* Controller)
+{
+    const int32* Index = EntryIndices.Find(Controller);
+
+    if (!Index)
+    {
+        return;
+    }
+
+    // Restore the brain's tick in case the controller outlives the registration (e.g. pooling).
+    // We may be inside one of its evaluations, so drop the skipped time instead of catching up on it
+    FAILODEntry& Entry = Entries[*Index];
+    Entry.PendingDeltaTime = 0.0f;
+    ApplyLOD(Entry, ENexusAILOD::Full);
+
+    // Unregistering from inside an evaluation can't reshuffle the array we're walking, so the entry is dropped next frame
+    if (bIsTicking)
+    {
+        Entry.Controller.Reset();
+        Entry.Brain.Reset();
+        EntryIndices.Remove(Entry.Key);
+        return;
+    }
+
+    RemoveEntryAt(*Index);
+}
+
+void UNexusAILODSubsystem::RemoveEntryAt(int32 Index)
+{
+    const TObjectKey<AAIController> Key = Entries[Index].Key;
+    const int32 LastIndex = Entries.Num() - 1;
+
+    // The key may already point at a newer entry if the controller registered again
+    if (const int32* Mapped = EntryIndices.Find(Key); Mapped && *Mapped == Index)
+    {
+        EntryIndices.Remove(Key);
+    }
+
+    Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // Fix up the index of the entry that was swapped into the hole
+    if (Index != LastIndex)
+    {
+        if (int32* Mapped = EntryIndices.Find(Entries[Index].Key); Mapped && *Mapped == LastIndex)
+        {
+            *Mapped = Index;
+        }
+    }
+}
+
+const int32* UNexusAILODSubsystem::FindEntryIndex(const AActor* Agent) const
+{
+    const AAIController* Controller = Cast<AAIController>(Agent);
+
+    if (!Controller)
+    {
+        const APawn* Pawn = Cast<APawn>(Agent);
+        Controller = Pawn ? Cast<AAIController>(Pawn->GetController()) : nullptr;
+    }
+
+    return Controller ? EntryIndices.Find(Controller) : nullptr;
+}
+
+void UNexusAILODSubsystem::RequestImmediateEvaluation(const AActor* Agent)
+{
+    if (const int32* Index = FindEntryIndex(Agent))
+    {
+        FAILODEntry& Entry = Entries[*Index];
+        Entry.LastCriticalTime = GetWorld()->GetTimeSeconds();
+
+        // Full rate brains evaluate on their own tick anyway
+        Entry.bEvaluateNow = Entry.LOD != ENexusAILOD::Full;
+    }
+}
+
+ENexusAILOD UNexusAILODSubsystem::GetLOD(const AActor* Agent) const
+{
+    const int32* Index = FindEntryIndex(Agent);
+    return Index ? Entries[*Index].LOD : ENexusAILOD::Full;
+}
+
+int32 UNexusAILODSubsystem::GetLODCount(ENexusAILOD LOD) const
+{
+    int32 Count = 0;
+    for (const FAILODEntry& Entry : Entries)
+    {
+        Count += (Entry.Controller.IsValid() && Entry.LOD == LOD) ? 1 : 0;
+    }
+    return Count;
+}
+
+void UNexusAILODSubsystem::LogReport() const
+{
+    const int32 NumFull = GetLODCount(ENexusAILOD::Full);
+    const int32 NumReduced = GetLODCount(ENexusAILOD::Reduced);
+    const int32 NumSuspended = GetLODCount(ENexusAILOD::Suspended);
+
+    // Reduced brains skip (N - 1) of every N frames, suspended brains skip all of them
+    const float FramesPerSecond = SmoothedDeltaTime > 0.0f ? 1.0f / SmoothedDeltaTime : 0.0f;
+    const float SkippedPerFrame = NumSuspended + NumReduced * (1.0f - 1.0f / ReducedFrameInterval);
+
+    UE_LOG(LogNexusTrials, Display, TEXT("AI LOD: %d registered | Full=%d Reduced=%d Suspended=%d | ~%.0f StateTree evaluations saved/s (%.1f FPS)"),
+        NumFull + NumReduced + NumSuspended, NumFull, NumReduced, NumSuspended, SkippedPerFrame * FramesPerSecond, FramesPerSecond);
+    UE_LOG(LogNexusTrials, Display, TEXT("AI LOD: compare 'stat StateTree' and 'stat NexusTrials' with Nexus.AILOD.Enable 0/1 for the game thread time saved"));
+}
+
+TStatId UNexusAILODSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNexusAILODSubsystem, STATGROUP_Tickables);
+}
+
+void UNexusAILODSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NexusAILODTick);
+    SET_DWORD_STAT(STAT_NexusAILODEvaluations, 0);
+
+    SmoothedDeltaTime = FMath::Lerp(SmoothedDeltaTime, DeltaTime, 0.1f);
+
+    // Drop controllers that went away or unregistered mid-evaluation
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Entries[Index].Controller.IsValid())
+        {
+            RemoveEntryAt(Index);
+        }
+    }
+
+    // Restore everything once when the policy gets switched off
+    const bool bEnabled = CVarAILODEnabled.GetValueOnGameThread();
+    if (!bEnabled)
+    {
+        if (bWasEnabled)
+        {
+            TGuardValue<bool> TickingGuard(bIsTicking, true);
+
+            for (int32 Index = 0; Index < Entries.Num(); ++Index)
+            {
+                Entries[Index].bEvaluateNow = false;
+                ApplyLOD(Entries[Index], ENexusAILOD::Full);
+            }
+        }
+
+        bWasEnabled = false;
+        return;
+    }
+
+    bWasEnabled = true;
+
+    if (Entries.Num() == 0)
+    {
+        return;
+    }
+
+    TGuardValue<bool> TickingGuard(bIsTicking, true);
+
+    ++FrameCounter;
+
+    // Entries may be appended while evaluating, so always index into the array instead of holding references across evaluations
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        FAILODEntry& Entry = Entries[Index];
+
+        if (!Entry.Controller.IsValid())
+        {
+            continue;
+        }
+
+        if (Entry.LOD == ENexusAILOD::Reduced)
+        {
+            Entry.PendingDeltaTime += DeltaTime;
+        }
+
+        // Critical events wake the brain up and evaluate it this frame, catching up on any time it skipped
+        if (Entry.bEvaluateNow)
+        {
+            Entry.bEvaluateNow = false;
+
+            const bool bWasSuspended = Entry.LOD == ENexusAILOD::Suspended;
+            UBrainComponent* Brain = Entry.Brain.Get();
+
+            ApplyLOD(Entry, ENexusAILOD::Full);
+
+            if (bWasSuspended)
+            {
+                NexusAILOD::Evaluate(Brain, DeltaTime);
+            }
+            continue;
+        }
+
+        // Reduced brains evaluate on their own frame of the interval
+        if (Entry.LOD == ENexusAILOD::Reduced && (FrameCounter + Entry.Phase) % ReducedFrameInterval == 0)
+        {
+            const float PendingDeltaTime = Entry.PendingDeltaTime;
+            Entry.PendingDeltaTime = 0.0f;
+
+            NexusAILOD::Evaluate(Entry.Brain.Get(), PendingDeltaTime);
+        }
+    }
+
+    // Re-pick the LOD for the next few controllers in the round-robin. This runs after the evaluations,
+    // so a brain that leaves reduced catches up on this frame too, and one that enters it starts counting next frame
+    const float TimeSeconds = GetWorld()->GetTimeSeconds();
+    const int32 NumEvaluations = FMath::Min(EvaluationsPerFrame, Entries.Num());
+
+    for (int32 Count = 0; Count < NumEvaluations; ++Count)
+    {
+        NextEvaluationIndex = (NextEvaluationIndex + 1) % Entries.Num();
+        FAILODEntry& Entry = Entries[NextEvaluationIndex];
+
+        if (Entry.Controller.IsValid())
+        {
+            ApplyLOD(Entry, LODForEntry(Entry, TimeSeconds));
+        }
+    }
+
+    SET_DWORD_STAT(STAT_NexusAILODFull, GetLODCount(ENexusAILOD::Full));
+    SET_DWORD_STAT(STAT_NexusAILODReduced, GetLODCount(ENexusAILOD::Reduced));
+    SET_DWORD_STAT(STAT_NexusAILODSuspended, GetLODCount(ENexusAILOD::Suspended));
+}
+
+ENexusAILOD UNexusAILODSubsystem::LODForEntry(const FAILODEntry& Entry, float TimeSeconds) const
+{
+    const AAIController* Controller = Entry.Controller.Get();
+    const UBrainComponent* Brain = Entry.Brain.Get();
+    const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+
+    // Leave stopped brains alone, e.g. while their pawn waits in a pool
+    if (!Pawn || !Brain || !Brain->IsRunning())
+    {
+        return ENexusAILOD::Full;
+    }
+
+    // Hold at full rate after critical events
+    if (TimeSeconds - Entry.LastCriticalTime < CriticalHoldTime)
+    {
+        return ENexusAILOD::Full;
+    }
+
+    // Distance and visibility come from the pawn's significance
+    const UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this);
+    const ENexusTickBucket Bucket = Significance ? Significance->GetBucket(Pawn) : ENexusTickBucket::Full;
+
+    if (Bucket == ENexusTickBucket::Dormant)
+    {
+        return ENexusAILOD::Suspended;
+    }
+
+    if (Bucket == ENexusTickBucket::Reduced)
+    {
+        return ENexusAILOD::Reduced;
+    }
+
+    // Standing around, unless it's standing next to something it may attack, e.g. waiting for its turn in melee range
+    if (Pawn->GetVelocity().SizeSquared() < FMath::Square(IdleSpeed) && !IsEngaged(Controller, Pawn))
+    {
+        return ENexusAILOD::Reduced;
+    }
+
+    return ENexusAILOD::Full;
+}
+
+bool UNexusAILODSubsystem::IsEngaged(const AAIController* Controller, const APawn* Pawn) const
+{
+    const FVector Location = Pawn->GetActorLocation();
+    const float EngageDistanceSquared = FMath::Square(EngageDistance);
+
+    // The actor the AI is facing, e.g. its attack target
+    if (const AActor* Focus = Controller->GetFocusActor())
+    {
+        if (FVector::DistSquared(Focus->GetActorLocation(), Location) <= EngageDistanceSquared)
+        {
+            return true;
+        }
+    }
+
+    // Players close enough to be attacked, even before the AI focuses on them
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PlayerController = It->Get();
+        const APawn* PlayerPawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+        if (PlayerPawn && FVector::DistSquared(PlayerPawn->GetActorLocation(), Location) <= EngageDistanceSquared)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void UNexusAILODSubsystem::ApplyLOD(FAILODEntry& Entry, ENexusAILOD NewLOD)
+{
+    if (Entry.LOD == NewLOD)
+    {
+        return;
+    }
+
+    const ENexusAILOD OldLOD = Entry.LOD;
+    Entry.LOD = NewLOD;
+
+    UBrainComponent* Brain = Entry.Brain.Get();
+    if (!Brain)
+    {
+        return;
+    }
+
+    // Take over the brain's tick, remembering whether it was running so other systems that toggle it keep their state
+    if (OldLOD == ENexusAILOD::Full)
+    {
+        Entry.bTickEnabledBefore = Brain->IsComponentTickEnabled();
+        Brain->SetComponentTickEnabled(false);
+    }
+
+    if (NewLOD == ENexusAILOD::Full)
+    {
+        Brain->SetComponentTickEnabled(Entry.bTickEnabledBefore);
+    }
+
+    // Leaving reduced: catch up on the time skipped since the last evaluation, so delays don't lose it.
+    // Evaluating can touch the entries array, so this is the last use of Entry
+    if (OldLOD == ENexusAILOD::Reduced)
+    {
+        const float PendingDeltaTime = Entry.PendingDeltaTime;
+        Entry.PendingDeltaTime = 0.0f;
+
+        NexusAILOD::Evaluate(Brain, PendingDeltaTime);
+    }
+}
@@ -0,0 +1,164 @@
+#include "Performance/NexusAllocationCounter.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+namespace NexusAllocationCounter
+{
+    /** Forwards everything to the wrapped allocator and counts game thread allocations */
+    class FCountingMalloc final : public FMalloc
+    {
+    public:
+
+        explicit FCountingMalloc(FMalloc* InInner)
+            : Inner(InInner)
+        {
+        }
+
+        virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+        {
+            CountIfGameThread();
+            return Inner->Malloc(Count, Alignment);
+        }
+
+        virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+        {
+            CountIfGameThread();
+            return Inner->TryMalloc(Count, Alignment);
+        }
+
+        virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            // Shrinking to nothing is a free, anything else may hit the heap
+            if (Count > 0)
+            {
+                CountIfGameThread();
+            }
+
+            return Inner->Realloc(Original, Count, Alignment);
+        }
+
+        virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+        {
+            if (Count > 0)
+            {
+                CountIfGameThread();
+            }
+
+            return Inner->TryRealloc(Original, Count, Alignment);
+        }
+
+        virtual void Free(void* Original) override
+        {
+            Inner->Free(Original);
+        }
+
+        virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+        {
+            return Inner->QuantizeSize(Count, Alignment);
+        }
+
+        virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+        {
+            return Inner->GetAllocationSize(Original, SizeOut);
+        }
+
+        virtual void Trim(bool bTrimThreadCaches) override
+        {
+            Inner->Trim(bTrimThreadCaches);
+        }
+
+        virtual void SetupTLSCachesOnCurrentThread() override
+        {
+            Inner->SetupTLSCachesOnCurrentThread();
+        }
+
+        virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+        {
+            Inner->ClearAndDisableTLSCachesOnCurrentThread();
+        }
+
+        virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+        {
+            Inner->GetAllocatorStats(OutStats);
+        }
+
+        virtual bool IsInternallyThreadSafe() const override
+        {
+            return Inner->IsInternallyThreadSafe();
+        }
+
+        virtual bool ValidateHeap() override
+        {
+            return Inner->ValidateHeap();
+        }
+
+        virtual const TCHAR* GetDescriptiveName() override
+        {
+            return Inner->GetDescriptiveName();
+        }
+
+        FMalloc* GetInner() const
+        {
+            return Inner;
+        }
+
+        int64 GetCount() const
+        {
+            return Count.GetValue();
+        }
+
+        void ResetCount()
+        {
+            Count.Reset();
+        }
+
+    private:
+
+        void CountIfGameThread()
+        {
+            if (FPlatformTLS::GetCurrentThreadId() == GGameThreadId)
+            {
+                Count.Increment();
+            }
+        }
+
+        FMalloc* Inner;
+        FThreadSafeCounter64 Count;
+    };
+}
+
+FNexusScopedAllocationCounter::FNexusScopedAllocationCounter()
+{
+    check(IsInGameThread());
+
+    InnerMalloc = GMalloc;
+
+    // Other threads may still be inside the counting allocator after the scope ends, so it's never deleted.
+    // It's created once and reused by later scopes that wrap the same allocator
+    static NexusAllocationCounter::FCountingMalloc* SharedCountingMalloc = new NexusAllocationCounter::FCountingMalloc(InnerMalloc);
+    check(SharedCountingMalloc->GetInner() == InnerMalloc);
+
+    CountingMalloc = SharedCountingMalloc;
+    CountingMalloc->ResetCount();
+
+    GMalloc = CountingMalloc;
+}
+
+FNexusScopedAllocationCounter::~FNexusScopedAllocationCounter()
+{
+    // Report a broken scope, but never leave the counter installed because of it
+    ensureMsgf(GMalloc == CountingMalloc, TEXT("GMalloc was replaced while an allocation counter scope was alive"));
+
+    // Memory handed out while counting came from the inner allocator, so it can be freed through it as usual
+    GMalloc = InnerMalloc;
+}
+
+int64 FNexusScopedAllocationCounter::GetNumAllocations() const
+{
+    return CountingMalloc->GetCount();
+}
+
+void FNexusScopedAllocationCounter::ResetCount()
+{
+    CountingMalloc->ResetCount();
+}
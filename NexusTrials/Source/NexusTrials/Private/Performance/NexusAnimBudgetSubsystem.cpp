@@ -0,0 +1,411 @@
+#include "Performance/NexusAnimBudgetSubsystem.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "NexusTrials.h"
+#include "Animation/AnimInstance.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Anim Budget Tick"), STAT_NexusAnimBudgetTick, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Full Rate"), STAT_NexusAnimBudgetFull, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Reduced Rate"), STAT_NexusAnimBudgetReduced, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Anim Budget Updates"), STAT_NexusAnimBudgetUpdates, STATGROUP_NexusTrials);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Anim Budget Updates Per Frame"), STAT_NexusAnimBudgetUpdatesPerFrame, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Anim Budget Montage Forced Updates"), STAT_NexusAnimBudgetForcedUpdates, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarAnimBudgetEnabled(
+    TEXT("Nexus.AnimBudget.Enable"),
+    true,
+    TEXT("If false, every registered skeletal mesh animates every frame with its authored settings. Use to A/B the animation budget."));
+
+static FAutoConsoleCommandWithWorld CmdAnimBudgetReport(
+    TEXT("Nexus.AnimBudget.Report"),
+    TEXT("Logs the animation update rate distribution and the updates per frame against the cap."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UNexusAnimBudgetSubsystem* AnimBudget = UNexusAnimBudgetSubsystem::Get(World))
+        {
+            AnimBudget->LogReport();
+        }
+    }));
+
+UNexusAnimBudgetSubsystem* UNexusAnimBudgetSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UNexusAnimBudgetSubsystem>() : nullptr;
+}
+
+bool UNexusAnimBudgetSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNexusAnimBudgetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Update decisions have to be in place before the meshes tick, so this runs ahead of the actor tick groups
+    PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UNexusAnimBudgetSubsystem::OnWorldPreActorTick);
+}
+
+void UNexusAnimBudgetSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+
+    // Hand every mesh back in its authored state
+    for (FAnimBudgetEntry& Entry : Entries)
+    {
+        ReleaseControl(Entry);
+
+        if (UAnimInstance* AnimInstance = Entry.Mesh.IsValid() ? Entry.Mesh->GetAnimInstance() : nullptr)
+        {
+            AnimInstance->OnMontageStarted.RemoveDynamic(this, &UNexusAnimBudgetSubsystem::OnMontageStarted);
+        }
+    }
+
+    Entries.Reset();
+    EntryIndices.Reset();
+
+    Super::Deinitialize();
+}
+
+void UNexusAnimBudgetSubsystem::RegisterMesh(USkeletalMeshComponent* Mesh)
+{
+    if (!IsValid(Mesh) || EntryIndices.Contains(Mesh))
+    {
+        return;
+    }
+
+    FAnimBudgetEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Mesh = Mesh;
+    Entry.Key = Mesh;
+    Entry.bURODefault = Mesh->bEnableUpdateRateOptimizations;
+    Entry.TickOptionDefault = Mesh->VisibilityBasedAnimTickOption;
+
+    // Hand out phases in order so reduced updates spread evenly over the interval
+    Entry.Phase = NextPhase;
+    NextPhase = (NextPhase + 1) % FMath::Max(1, MaxUpdateRate);
+
+    if (CVarAnimBudgetEnabled.GetValueOnGameThread())
+    {
+        TakeControl(Entry);
+    }
+
+    // Montages can start after this frame's update decision, so hear about them as they start
+    if (UAnimInstance* AnimInstance = Mesh->GetAnimInstance())
+    {
+        AnimInstance->OnMontageStarted.AddUniqueDynamic(this, &UNexusAnimBudgetSubsystem::OnMontageStarted);
+    }
+
+    EntryIndices.Add(Entry.Key, Entries.Num() - 1);
+}
+
+void UNexusAnimBudgetSubsystem::UnregisterMesh(USkeletalMeshComponent* Mesh)
+{
+    const int32* Index = EntryIndices.Find(Mesh);
+
+    if (!Index)
+    {
+        return;
+    }
+
+    // Restore the authored settings in case the mesh outlives the registration (e.g. pooling)
+    ReleaseControl(Entries[*Index]);
+
+    if (UAnimInstance* AnimInstance = Mesh->GetAnimInstance())
+    {
+        AnimInstance->OnMontageStarted.RemoveDynamic(this, &UNexusAnimBudgetSubsystem::OnMontageStarted);
+    }
+
+    RemoveEntryAt(*Index);
+}
+
+void UNexusAnimBudgetSubsystem::RemoveEntryAt(int32 Index)
+{
+    const TObjectKey<USkeletalMeshComponent> Key = Entries[Index].Key;
+    const int32 LastIndex = Entries.Num() - 1;
+
+    if (const int32* Mapped = EntryIndices.Find(Key); Mapped && *Mapped == Index)
+    {
+        EntryIndices.Remove(Key);
+    }
+
+    Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // Fix up the index of the entry that was swapped into the hole
+    if (Index != LastIndex)
+    {
+        if (int32* Mapped = EntryIndices.Find(Entries[Index].Key); Mapped && *Mapped == LastIndex)
+        {
+            *Mapped = Index;
+        }
+    }
+}
+
+int32 UNexusAnimBudgetSubsystem::GetUpdateRate(const USkeletalMeshComponent* Mesh) const
+{
+    const int32* Index = EntryIndices.Find(Mesh);
+    return Index ? Entries[*Index].UpdateRate : 1;
+}
+
+void UNexusAnimBudgetSubsystem::LogReport() const
+{
+    int32 NumFull = 0;
+    int32 NumNeverSkip = 0;
+
+    for (const FAnimBudgetEntry& Entry : Entries)
+    {
+        NumFull += Entry.UpdateRate <= 1 ? 1 : 0;
+        NumNeverSkip += Entry.bNeverSkip ? 1 : 0;
+    }
+
+    UE_LOG(LogNexusTrials, Display, TEXT("Anim Budget: %d registered | Full=%d (%d pinned by montages or players) Reduced=%d | ~%.1f of %d updates/frame"),
+        Entries.Num(), NumFull, NumNeverSkip, Entries.Num() - NumFull, UpdatesPerFrame, MaxUpdatesPerFrame);
+    UE_LOG(LogNexusTrials, Display, TEXT("Anim Budget: compare 'stat Anim' with Nexus.AnimBudget.Enable 0/1 for the game thread time saved"));
+}
+
+void UNexusAnimBudgetSubsystem::TakeControl(FAnimBudgetEntry& Entry) const
+{
+    USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+
+    if (!Mesh)
+    {
+        return;
+    }
+
+    // The update rate machinery handles skipping and interpolation, we just pick the rate
+    Mesh->bEnableUpdateRateOptimizations = true;
+    Mesh->EnableExternalTickRateControl(true);
+    Mesh->EnableExternalUpdate(true);
+    Entry.AccumulatedDeltaTime = 0.0f;
+
+    // Nobody looks at poses on a dedicated server, only montage timing and the bones attack traces read while one plays
+    if (GetWorld()->GetNetMode() == NM_DedicatedServer)
+    {
+        Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesAndRefreshBonesWhenPlayingMontages;
+    }
+}
+
+void UNexusAnimBudgetSubsystem::ReleaseControl(FAnimBudgetEntry& Entry) const
+{
+    Entry.UpdateRate = 1;
+    Entry.AccumulatedDeltaTime = 0.0f;
+
+    USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+
+    if (!Mesh)
+    {
+        return;
+    }
+
+    Mesh->EnableExternalTickRateControl(false);
+    Mesh->EnableExternalUpdate(true);
+    Mesh->EnableExternalInterpolation(false);
+    Mesh->bEnableUpdateRateOptimizations = Entry.bURODefault;
+    Mesh->VisibilityBasedAnimTickOption = Entry.TickOptionDefault;
+}
+
+void UNexusAnimBudgetSubsystem::OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+    if (InWorld != GetWorld() || InWorld->IsPaused())
+    {
+        return;
+    }
+
+    SCOPE_CYCLE_COUNTER(STAT_NexusAnimBudgetTick);
+
+    // Drop meshes that went away without unregistering
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Entries[Index].Mesh.IsValid())
+        {
+            RemoveEntryAt(Index);
+        }
+    }
+
+    // Restore everything once when the policy gets switched off, and take over again when it comes back
+    const bool bEnabled = CVarAnimBudgetEnabled.GetValueOnGameThread();
+    if (bEnabled != bWasEnabled)
+    {
+        for (FAnimBudgetEntry& Entry : Entries)
+        {
+            if (bEnabled)
+            {
+                TakeControl(Entry);
+            }
+            else
+            {
+                ReleaseControl(Entry);
+            }
+        }
+
+        bWasEnabled = bEnabled;
+    }
+
+    if (!bEnabled || Entries.Num() == 0)
+    {
+        return;
+    }
+
+    ++FrameCounter;
+
+    const UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this);
+    const int32 MaxRate = FMath::Max(1, MaxUpdateRate);
+
+    //================== Rates from significance ==================
+
+    UpdatesPerFrame = 0.0f;
+    BudgetOrder.Reset();
+
+    for (int32 Index = 0; Index < Entries.Num(); ++Index)
+    {
+        FAnimBudgetEntry& Entry = Entries[Index];
+        const USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+        const AActor* Owner = Mesh->GetOwner();
+        const APawn* Pawn = Cast<APawn>(Owner);
+        const UAnimInstance* AnimInstance = Mesh->GetAnimInstance();
+
+        // Montages carry the attack notifies, so they need every frame to fire them on time.
+        // Players and ragdolls can't afford to skip either
+        Entry.bNeverSkip = (AnimInstance && AnimInstance->IsAnyMontagePlaying())
+            || (Pawn && Pawn->IsPlayerControlled())
+            || Mesh->IsSimulatingPhysics();
+
+        Entry.Significance = Significance ? Significance->GetSignificance(Owner) : 1.0f;
+
+        if (Entry.bNeverSkip || Entry.Significance >= FullRateSignificance)
+        {
+            Entry.UpdateRate = 1;
+        }
+        else
+        {
+            // Halve the rate as significance halves
+            Entry.UpdateRate = FMath::Clamp(FMath::FloorToInt32(1.0f / FMath::Max(Entry.Significance, 0.01f)), 2, FMath::Max(2, MaxRate));
+            BudgetOrder.Add(Index);
+        }
+
+        UpdatesPerFrame += 1.0f / Entry.UpdateRate;
+    }
+
+    //================== Budget ==================
+
+    // Over the cap: keep slowing down the least significant meshes until we fit or everyone is at the slowest rate
+    if (UpdatesPerFrame > MaxUpdatesPerFrame && BudgetOrder.Num() > 0)
+    {
+        BudgetOrder.Sort([this](int32 A, int32 B)
+        {
+            return Entries[A].Significance < Entries[B].Significance;
+        });
+
+        bool bChanged = true;
+
+        while (UpdatesPerFrame > MaxUpdatesPerFrame && bChanged)
+        {
+            bChanged = false;
+
+            for (const int32 Index : BudgetOrder)
+            {
+                FAnimBudgetEntry& Entry = Entries[Index];
+
+                if (Entry.UpdateRate >= MaxRate)
+                {
+                    continue;
+                }
+
+                UpdatesPerFrame -= 1.0f / Entry.UpdateRate;
+                Entry.UpdateRate = FMath::Min(Entry.UpdateRate * 2, MaxRate);
+                UpdatesPerFrame += 1.0f / Entry.UpdateRate;
+                bChanged = true;
+
+                if (UpdatesPerFrame <= MaxUpdatesPerFrame)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    //================== Apply ==================
+
+    int32 NumFull = 0;
+    int32 NumUpdates = 0;
+
+    for (FAnimBudgetEntry& Entry : Entries)
+    {
+        USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+
+        Entry.AccumulatedDeltaTime += DeltaSeconds;
+
+        // Reduced meshes update on their own frame of the interval, with all the time they skipped so notifies still fire
+        const bool bUpdate = Entry.UpdateRate <= 1 || (FrameCounter + Entry.Phase) % Entry.UpdateRate == 0;
+
+        // Only on-screen meshes are worth smoothing out, and only while the gaps are short
+        const bool bInterpolate = Entry.UpdateRate > 1 && Entry.UpdateRate <= MaxInterpolatedRate && Mesh->WasRecentlyRendered(0.25f);
+
+        Mesh->SetExternalTickRate(static_cast<uint8>(Entry.UpdateRate));
+        Mesh->EnableExternalInterpolation(bInterpolate);
+
+        if (bUpdate)
+        {
+            Mesh->SetExternalDeltaTime(Entry.AccumulatedDeltaTime);
+            Entry.AccumulatedDeltaTime = 0.0f;
+            ++NumUpdates;
+        }
+
+        Mesh->EnableExternalUpdate(bUpdate);
+
+        NumFull += Entry.UpdateRate <= 1 ? 1 : 0;
+    }
+
+    SET_DWORD_STAT(STAT_NexusAnimBudgetFull, NumFull);
+    SET_DWORD_STAT(STAT_NexusAnimBudgetReduced, Entries.Num() - NumFull);
+    SET_DWORD_STAT(STAT_NexusAnimBudgetUpdates, NumUpdates);
+    SET_FLOAT_STAT(STAT_NexusAnimBudgetUpdatesPerFrame, UpdatesPerFrame);
+}
+
+void UNexusAnimBudgetSubsystem::OnMontageStarted(UAnimMontage* Montage)
+{
+    if (!bWasEnabled)
+    {
+        return;
+    }
+
+    // The delegate doesn't say whose montage started, so look for skipping meshes that are now playing it
+    for (FAnimBudgetEntry& Entry : Entries)
+    {
+        const USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+        const UAnimInstance* AnimInstance = Mesh ? Mesh->GetAnimInstance() : nullptr;
+
+        if (!Entry.bNeverSkip && AnimInstance && AnimInstance->Montage_IsPlaying(Montage))
+        {
+            ForceUpdate(Entry);
+        }
+    }
+}
+
+void UNexusAnimBudgetSubsystem::ForceUpdate(FAnimBudgetEntry& Entry) const
+{
+    USkeletalMeshComponent* Mesh = Entry.Mesh.Get();
+
+    if (!Mesh)
+    {
+        return;
+    }
+
+    INC_DWORD_STAT(STAT_NexusAnimBudgetForcedUpdates);
+
+    // The next rate pick sees the montage and keeps the mesh at full rate from then on
+    Entry.bNeverSkip = true;
+    Entry.UpdateRate = 1;
+
+    Mesh->SetExternalTickRate(1);
+    Mesh->EnableExternalInterpolation(false);
+
+    // If the mesh already ticked this frame this takes effect next frame, and the skipped time only
+    // drops from the base pose, since the montage itself just started
+    Mesh->SetExternalDeltaTime(Entry.AccumulatedDeltaTime);
+    Entry.AccumulatedDeltaTime = 0.0f;
+
+    Mesh->EnableExternalUpdate(true);
+}
@@ -0,0 +1,98 @@
+#include "Performance/NexusFrameScratch.h"
+#include "NexusTrials.h"
+#include "Misc/CoreDelegates.h"
+#include "HAL/UnrealMemory.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frame Scratch Bytes Used"), STAT_NexusFrameScratchUsed, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Frame Scratch Bytes Reserved"), STAT_NexusFrameScratchReserved, STATGROUP_NexusTrials);
+
+FNexusFrameScratch& FNexusFrameScratch::Get()
+{
+    static FNexusFrameScratch Scratch;
+    static bool bResetBound = false;
+
+    // Reset once the game thread is done with the frame, so query results never see the next frame's data
+    if (!bResetBound)
+    {
+        bResetBound = true;
+        FCoreDelegates::OnEndFrame.AddLambda([]() { Scratch.Reset(); });
+    }
+
+    return Scratch;
+}
+
+FNexusFrameScratch::~FNexusFrameScratch()
+{
+    for (uint8* Block : Blocks)
+    {
+        FMemory::Free(Block);
+    }
+
+    for (uint8* Block : LargeBlocks)
+    {
+        FMemory::Free(Block);
+    }
+}
+
+void* FNexusFrameScratch::Allocate(SIZE_T Size, uint32 Alignment)
+{
+    checkSlow(IsInGameThread());
+    checkSlow(FMath::IsPowerOfTwo(Alignment));
+
+    BytesUsed += Size;
+
+    // Oversized requests get a block of their own instead of wasting the rest of a regular one
+    if (Size + Alignment > BlockSize)
+    {
+        uint8* LargeBlock = static_cast<uint8*>(FMemory::Malloc(Size, Alignment));
+        LargeBlocks.Add(LargeBlock);
+        return LargeBlock;
+    }
+
+    // Bump the current block, moving on to the next one when it's full
+    while (true)
+    {
+        if (!Blocks.IsValidIndex(CurrentBlock))
+        {
+            Blocks.Add(static_cast<uint8*>(FMemory::Malloc(BlockSize, 16)));
+            CurrentBlock = Blocks.Num() - 1;
+            Offset = 0;
+        }
+
+        // Align the address rather than the offset, so alignments above the block's own are honored too
+        uint8* const Base = Blocks[CurrentBlock];
+        const SIZE_T AlignedOffset = static_cast<SIZE_T>(Align(Base + Offset, Alignment) - Base);
+
+        if (AlignedOffset + Size <= BlockSize)
+        {
+            Offset = AlignedOffset + Size;
+            return Base + AlignedOffset;
+        }
+
+        ++CurrentBlock;
+        Offset = 0;
+    }
+}
+
+void FNexusFrameScratch::Reset()
+{
+    checkSlow(IsInGameThread());
+
+    PeakBytesUsed = FMath::Max(PeakBytesUsed, BytesUsed);
+
+    SET_DWORD_STAT(STAT_NexusFrameScratchUsed, BytesUsed);
+    SET_DWORD_STAT(STAT_NexusFrameScratchReserved, GetBytesReserved());
+
+    for (uint8* Block : LargeBlocks)
+    {
+        FMemory::Free(Block);
+    }
+
+    // Keep the regular blocks so the next frame doesn't touch the heap
+    LargeBlocks.Reset();
+    CurrentBlock = 0;
+    Offset = 0;
+    BytesUsed = 0;
+
+    ++Frame;
+}
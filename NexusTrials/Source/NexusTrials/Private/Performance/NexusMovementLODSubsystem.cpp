@@ -0,0 +1,287 @@
+#include "Performance/NexusMovementLODSubsystem.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "NexusTrials.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "NavigationSystem.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Movement LOD Tick"), STAT_NexusMovementLODTick, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movement LOD Full"), STAT_NexusMovementLODFull, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movement LOD Lightweight"), STAT_NexusMovementLODLightweight, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarMovementLODEnabled(
+    TEXT("Nexus.MovementLOD.Enable"),
+    true,
+    TEXT("If false, every registered character is put back on full walking. Use to A/B the movement LOD policy."));
+
+static FAutoConsoleCommandWithWorld CmdMovementLODReport(
+    TEXT("Nexus.MovementLOD.Report"),
+    TEXT("Logs the number of characters on lightweight movement."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UNexusMovementLODSubsystem* MovementLOD = UNexusMovementLODSubsystem::Get(World))
+        {
+            MovementLOD->LogReport();
+        }
+    }));
+
+UNexusMovementLODSubsystem* UNexusMovementLODSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UNexusMovementLODSubsystem>() : nullptr;
+}
+
+bool UNexusMovementLODSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNexusMovementLODSubsystem::Deinitialize()
+{
+    // Put everyone back on full walking
+    for (FMovementLODEntry& Entry : Entries)
+    {
+        LeaveLightweight(Entry);
+    }
+
+    Entries.Reset();
+    EntryIndices.Reset();
+
+    Super::Deinitialize();
+}
+
+void UNexusMovementLODSubsystem::RegisterCharacter(ACharacter* Character)
+{
+    if (!IsValid(Character) || !Character->GetCharacterMovement() || EntryIndices.Contains(Character))
+    {
+        return;
+    }
+
+    FMovementLODEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Character = Character;
+    Entry.Key = Character;
+    Entry.bSweepDefault = Character->GetCharacterMovement()->bSweepWhileNavWalking;
+
+    EntryIndices.Add(Entry.Key, Entries.Num() - 1);
+}
+
+void UNexusMovementLODSubsystem::UnregisterCharacter(ACharacter* Character)
+{
+    const int32* Index = EntryIndices.Find(Character);
+
+    if (!Index)
+    {
+        return;
+    }
+
+    // Restore full walking in case the character outlives the registration (e.g. pooling)
+    LeaveLightweight(Entries[*Index]);
+
+    RemoveEntryAt(*Index);
+}
+
+void UNexusMovementLODSubsystem::RemoveEntryAt(int32 Index)
+{
+    const TObjectKey<ACharacter> Key = Entries[Index].Key;
+    const int32 LastIndex = Entries.Num() - 1;
+
+    if (const int32* Mapped = EntryIndices.Find(Key); Mapped && *Mapped == Index)
+    {
+        EntryIndices.Remove(Key);
+    }
+
+    Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // Fix up the index of the entry that was swapped into the hole
+    if (Index != LastIndex)
+    {
+        if (int32* Mapped = EntryIndices.Find(Entries[Index].Key); Mapped && *Mapped == LastIndex)
+        {
+            *Mapped = Index;
+        }
+    }
+}
+
+bool UNexusMovementLODSubsystem::IsLightweight(const ACharacter* Character) const
+{
+    const int32* Index = EntryIndices.Find(Character);
+    return Index && Entries[*Index].bLightweight;
+}
+
+int32 UNexusMovementLODSubsystem::GetNumLightweight() const
+{
+    int32 Count = 0;
+    for (const FMovementLODEntry& Entry : Entries)
+    {
+        Count += (Entry.Character.IsValid() && Entry.bLightweight) ? 1 : 0;
+    }
+    return Count;
+}
+
+void UNexusMovementLODSubsystem::LogReport() const
+{
+    const int32 NumLightweight = GetNumLightweight();
+
+    UE_LOG(LogNexusTrials, Display, TEXT("Movement LOD: %d registered | Full=%d Lightweight=%d"),
+        Entries.Num(), Entries.Num() - NumLightweight, NumLightweight);
+    UE_LOG(LogNexusTrials, Display, TEXT("Movement LOD: compare 'stat CharacterMovement' with Nexus.MovementLOD.Enable 0/1 for the game thread time saved"));
+}
+
+TStatId UNexusMovementLODSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNexusMovementLODSubsystem, STATGROUP_Tickables);
+}
+
+void UNexusMovementLODSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NexusMovementLODTick);
+
+    // Drop characters that went away without unregistering
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Entries[Index].Character.IsValid())
+        {
+            RemoveEntryAt(Index);
+        }
+    }
+
+    // Restore everything once when the policy gets switched off
+    const bool bEnabled = CVarMovementLODEnabled.GetValueOnGameThread();
+    if (!bEnabled)
+    {
+        if (bWasEnabled)
+        {
+            for (FMovementLODEntry& Entry : Entries)
+            {
+                LeaveLightweight(Entry);
+            }
+        }
+
+        bWasEnabled = false;
+        return;
+    }
+
+    bWasEnabled = true;
+
+    const UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this);
+
+    if (Entries.Num() == 0 || !Significance)
+    {
+        return;
+    }
+
+    // Re-evaluate the next few characters in the round-robin
+    const int32 NumEvaluations = FMath::Min(EvaluationsPerFrame, Entries.Num());
+
+    for (int32 Count = 0; Count < NumEvaluations; ++Count)
+    {
+        NextEvaluationIndex = (NextEvaluationIndex + 1) % Entries.Num();
+        FMovementLODEntry& Entry = Entries[NextEvaluationIndex];
+
+        Evaluate(Entry, Significance->GetSignificance(Entry.Character.Get()));
+    }
+
+    const int32 NumLightweight = GetNumLightweight();
+    SET_DWORD_STAT(STAT_NexusMovementLODFull, Entries.Num() - NumLightweight);
+    SET_DWORD_STAT(STAT_NexusMovementLODLightweight, NumLightweight);
+}
+
+void UNexusMovementLODSubsystem::Evaluate(FMovementLODEntry& Entry, float SignificanceScore)
+{
+    ACharacter* Character = Entry.Character.Get();
+    UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+
+    if (!Movement || !Character->HasAuthority())
+    {
+        return;
+    }
+
+    // Something else took the character off nav walking (a fall, a launch, a ragdoll), so it's back on full movement already
+    if (Entry.bLightweight && Movement->MovementMode != MOVE_NavWalking)
+    {
+        Movement->bSweepWhileNavWalking = Entry.bSweepDefault;
+        Entry.bLightweight = false;
+        return;
+    }
+
+    // Players, root motion and ragdolls need the full simulation
+    const USkeletalMeshComponent* Mesh = Character->GetMesh();
+    const bool bNeedsFullMovement = Character->IsPlayerControlled()
+        || Character->HasAnyRootMotion()
+        || (Mesh && Mesh->IsSimulatingPhysics());
+
+    if (Entry.bLightweight)
+    {
+        if (bNeedsFullMovement || SignificanceScore >= FullSignificance)
+        {
+            LeaveLightweight(Entry);
+        }
+        return;
+    }
+
+    if (bNeedsFullMovement || SignificanceScore >= LightweightSignificance || Movement->MovementMode != MOVE_Walking)
+    {
+        return;
+    }
+
+    // Nav walking drops straight back to walking without a navmesh to follow, so don't bother switching
+    const UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!NavSys || !NavSys->GetNavDataForProps(Character->GetNavAgentPropertiesRef(), Character->GetActorLocation()))
+    {
+        return;
+    }
+
+    EnterLightweight(Entry);
+}
+
+void UNexusMovementLODSubsystem::EnterLightweight(FMovementLODEntry& Entry) const
+{
+    ACharacter* Character = Entry.Character.Get();
+    UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+
+    if (!Movement)
+    {
+        return;
+    }
+
+    Entry.bSweepDefault = Movement->bSweepWhileNavWalking;
+    Movement->bSweepWhileNavWalking = bSweepWhileLightweight;
+    Movement->SetMovementMode(MOVE_NavWalking);
+
+    // The movement component can refuse the switch, e.g. if the character can't walk on the navmesh
+    Entry.bLightweight = Movement->MovementMode == MOVE_NavWalking;
+
+    if (!Entry.bLightweight)
+    {
+        Movement->bSweepWhileNavWalking = Entry.bSweepDefault;
+    }
+}
+
+void UNexusMovementLODSubsystem::LeaveLightweight(FMovementLODEntry& Entry) const
+{
+    if (!Entry.bLightweight)
+    {
+        return;
+    }
+
+    Entry.bLightweight = false;
+
+    ACharacter* Character = Entry.Character.Get();
+    UCharacterMovementComponent* Movement = Character ? Character->GetCharacterMovement() : nullptr;
+
+    if (!Movement)
+    {
+        return;
+    }
+
+    Movement->bSweepWhileNavWalking = Entry.bSweepDefault;
+
+    // If the capsule doesn't fit where the navmesh put us, the movement component stays on nav walking and keeps retrying
+    if (Movement->MovementMode == MOVE_NavWalking)
+    {
+        Movement->TryToLeaveNavWalking();
+    }
+}
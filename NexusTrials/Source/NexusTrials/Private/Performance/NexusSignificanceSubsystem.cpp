@@ -0,0 +1,400 @@
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "NexusTrials.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/ActorComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Tick"), STAT_NexusSignificanceTick, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Full"), STAT_NexusSignificanceFull, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Reduced"), STAT_NexusSignificanceReduced, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Significance Dormant"), STAT_NexusSignificanceDormant, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarSignificanceEnabled(
+    TEXT("Nexus.Significance.Enable"),
+    true,
+    TEXT("If false, every registered actor is restored to its authored tick settings. Use to A/B the tick LOD policy."));
+
+static FAutoConsoleCommandWithWorld CmdSignificanceReport(
+    TEXT("Nexus.Significance.Report"),
+    TEXT("Logs the tick bucket distribution and estimated actor ticks saved per second."),
+    FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+    {
+        if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(World))
+        {
+            Significance->LogReport();
+        }
+    }));
+
+UNexusSignificanceSubsystem* UNexusSignificanceSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UNexusSignificanceSubsystem>() : nullptr;
+}
+
+bool UNexusSignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNexusSignificanceSubsystem::Deinitialize()
+{
+    // Hand every actor back in its authored state
+    for (FSignificanceEntry& Entry : Entries)
+    {
+        ApplyBucket(Entry, ENexusTickBucket::Full);
+    }
+
+    Entries.Reset();
+    EntryIndices.Reset();
+
+    Super::Deinitialize();
+}
+
+void UNexusSignificanceSubsystem::RegisterActor(AActor* Actor, bool bAllowDormant)
+{
+    if (!IsValid(Actor) || EntryIndices.Contains(Actor))
+    {
+        return;
+    }
+
+    FSignificanceEntry& Entry = Entries.AddDefaulted_GetRef();
+    Entry.Actor = Actor;
+    Entry.Key = Actor;
+    Entry.bAllowDormant = bAllowDormant;
+    Entry.DefaultActorInterval = Actor->GetActorTickInterval();
+
+    // Capture the authored interval of every component that can tick
+    for (UActorComponent* Component : Actor->GetComponents())
+    {
+        if (Component && Component->PrimaryComponentTick.bCanEverTick)
+        {
+            FComponentTickState& State = Entry.Components.AddDefaulted_GetRef();
+            State.Component = Component;
+            State.DefaultInterval = Component->GetComponentTickInterval();
+        }
+    }
+
+    EntryIndices.Add(Entry.Key, Entries.Num() - 1);
+}
+
+void UNexusSignificanceSubsystem::UnregisterActor(AActor* Actor)
+{
+    const int32* Index = EntryIndices.Find(Actor);
+
+    if (!Index)
+    {
+        return;
+    }
+
+    // Restore the authored tick settings in case the actor outlives the registration (e.g. pooling)
+    ApplyBucket(Entries[*Index], ENexusTickBucket::Full);
+
+    RemoveEntryAt(*Index);
+}
+
+void UNexusSignificanceSubsystem::RemoveEntryAt(int32 Index)
+{
+    const TObjectKey<AActor> Key = Entries[Index].Key;
+    const int32 LastIndex = Entries.Num() - 1;
+
+    if (const int32* Mapped = EntryIndices.Find(Key); Mapped && *Mapped == Index)
+    {
+        EntryIndices.Remove(Key);
+    }
+
+    Entries.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    // Fix up the index of the entry that was swapped into the hole
+    if (Index != LastIndex)
+    {
+        if (int32* Mapped = EntryIndices.Find(Entries[Index].Key); Mapped && *Mapped == LastIndex)
+        {
+            *Mapped = Index;
+        }
+    }
+}
+
+void UNexusSignificanceSubsystem::NotifyCombatActivity(AActor* Actor)
+{
+    if (const int32* Index = EntryIndices.Find(Actor))
+    {
+        FSignificanceEntry& Entry = Entries[*Index];
+        Entry.LastCombatTime = GetWorld()->GetTimeSeconds();
+        Entry.Significance = 1.0f;
+
+        // Don't wait for the round-robin to come around, critical events need a full rate tick now
+        if (CVarSignificanceEnabled.GetValueOnGameThread())
+        {
+            ApplyBucket(Entry, ENexusTickBucket::Full);
+        }
+    }
+}
+
+ENexusTickBucket UNexusSignificanceSubsystem::GetBucket(const AActor* Actor) const
+{
+    const int32* Index = EntryIndices.Find(Actor);
+    return Index ? Entries[*Index].Bucket : ENexusTickBucket::Full;
+}
+
+float UNexusSignificanceSubsystem::GetSignificance(const AActor* Actor) const
+{
+    const int32* Index = EntryIndices.Find(Actor);
+    return Index ? Entries[*Index].Significance : 1.0f;
+}
+
+int32 UNexusSignificanceSubsystem::GetBucketCount(ENexusTickBucket Bucket) const
+{
+    int32 Count = 0;
+    for (const FSignificanceEntry& Entry : Entries)
+    {
+        Count += (Entry.Bucket == Bucket) ? 1 : 0;
+    }
+    return Count;
+}
+
+void UNexusSignificanceSubsystem::LogReport() const
+{
+    const int32 NumFull = GetBucketCount(ENexusTickBucket::Full);
+    const int32 NumReduced = GetBucketCount(ENexusTickBucket::Reduced);
+    const int32 NumDormant = GetBucketCount(ENexusTickBucket::Dormant);
+
+    // Count actors that still have their actor tick running
+    int32 NumTicking = 0;
+    for (const FSignificanceEntry& Entry : Entries)
+    {
+        const AActor* Actor = Entry.Actor.Get();
+        NumTicking += (Actor && Actor->IsActorTickEnabled()) ? 1 : 0;
+    }
+
+    // Reduced actors skip (N - 1) of every N frames, dormant actors skip all of them
+    const float FramesPerSecond = SmoothedDeltaTime > 0.0f ? 1.0f / SmoothedDeltaTime : 0.0f;
+    const float SkippedPerFrame = NumDormant + NumReduced * (1.0f - 1.0f / ReducedFrameInterval);
+
+    UE_LOG(LogNexusTrials, Display, TEXT("Significance: %d registered, %d ticking | Full=%d Reduced=%d Dormant=%d | ~%.0f actor ticks saved/s (%.1f FPS)"),
+        Entries.Num(), NumTicking, NumFull, NumReduced, NumDormant, SkippedPerFrame * FramesPerSecond, FramesPerSecond);
+    UE_LOG(LogNexusTrials, Display, TEXT("Significance: compare 'stat game' with Nexus.Significance.Enable 0/1 for the game thread time saved"));
+}
+
+TStatId UNexusSignificanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNexusSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+void UNexusSignificanceSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NexusSignificanceTick);
+
+    SmoothedDeltaTime = FMath::Lerp(SmoothedDeltaTime, DeltaTime, 0.1f);
+
+    // Drop actors that went away without unregistering
+    for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Entries[Index].Actor.IsValid())
+        {
+            RemoveEntryAt(Index);
+        }
+    }
+
+    // Restore everything once when the policy gets switched off
+    const bool bEnabled = CVarSignificanceEnabled.GetValueOnGameThread();
+    if (!bEnabled)
+    {
+        if (bWasEnabled)
+        {
+            for (FSignificanceEntry& Entry : Entries)
+            {
+                ApplyBucket(Entry, ENexusTickBucket::Full);
+            }
+        }
+
+        bWasEnabled = false;
+        return;
+    }
+
+    bWasEnabled = true;
+
+    if (Entries.Num() == 0)
+    {
+        return;
+    }
+
+    GatherPlayerLocations();
+
+    const float TimeSeconds = GetWorld()->GetTimeSeconds();
+    const int32 NumEvaluations = FMath::Min(EvaluationsPerFrame, Entries.Num());
+
+    for (int32 Count = 0; Count < NumEvaluations; ++Count)
+    {
+        NextEvaluationIndex = (NextEvaluationIndex + 1) % Entries.Num();
+        FSignificanceEntry& Entry = Entries[NextEvaluationIndex];
+
+        Entry.Significance = ScoreEntry(Entry, TimeSeconds);
+        ApplyBucket(Entry, BucketForScore(Entry, Entry.Significance));
+    }
+
+    SET_DWORD_STAT(STAT_NexusSignificanceFull, GetBucketCount(ENexusTickBucket::Full));
+    SET_DWORD_STAT(STAT_NexusSignificanceReduced, GetBucketCount(ENexusTickBucket::Reduced));
+    SET_DWORD_STAT(STAT_NexusSignificanceDormant, GetBucketCount(ENexusTickBucket::Dormant));
+}
+
+void UNexusSignificanceSubsystem::GatherPlayerLocations()
+{
+    PlayerLocations.Reset();
+
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        if (const APlayerController* PC = It->Get())
+        {
+            if (const APawn* ViewPawn = PC->GetPawnOrSpectator())
+            {
+                PlayerLocations.Add(ViewPawn->GetActorLocation());
+            }
+        }
+    }
+}
+
+float UNexusSignificanceSubsystem::ScoreEntry(const FSignificanceEntry& Entry, float TimeSeconds) const
+{
+    const AActor* Actor = Entry.Actor.Get();
+
+    // players and actors in combat are always fully significant
+    const APawn* Pawn = Cast<APawn>(Actor);
+    if ((Pawn && Pawn->IsPlayerControlled()) || TimeSeconds - Entry.LastCombatTime < CombatHoldTime)
+    {
+        return 1.0f;
+    }
+
+    // with no players around, nothing is significant
+    if (PlayerLocations.Num() == 0)
+    {
+        return 0.0f;
+    }
+
+    const FVector ActorLocation = Actor->GetActorLocation();
+
+    float NearestDistSq = TNumericLimits<float>::Max();
+    for (const FVector& PlayerLocation : PlayerLocations)
+    {
+        NearestDistSq = FMath::Min(NearestDistSq, static_cast<float>(FVector::DistSquared(ActorLocation, PlayerLocation)));
+    }
+
+    if (NearestDistSq < FMath::Square(AlwaysFullDistance))
+    {
+        return 1.0f;
+    }
+
+    float Score = 1.0f - FMath::Clamp(FMath::Sqrt(NearestDistSq) / DormantDistance, 0.0f, 1.0f);
+
+    // dedicated servers never render, so visibility would only drag everything down there
+    if (GetWorld()->GetNetMode() != NM_DedicatedServer && !Actor->WasRecentlyRendered(0.25f))
+    {
+        Score *= HiddenScoreScale;
+    }
+
+    return Score;
+}
+
+ENexusTickBucket UNexusSignificanceSubsystem::BucketForScore(const FSignificanceEntry& Entry, float Score) const
+{
+    if (Score >= FullScoreThreshold)
+    {
+        return ENexusTickBucket::Full;
+    }
+
+    if (Score >= DormantScoreThreshold || !Entry.bAllowDormant)
+    {
+        return ENexusTickBucket::Reduced;
+    }
+
+    return ENexusTickBucket::Dormant;
+}
+
+void UNexusSignificanceSubsystem::ApplyBucket(FSignificanceEntry& Entry, ENexusTickBucket NewBucket)
+{
+    if (Entry.Bucket == NewBucket)
+    {
+        return;
+    }
+
+    AActor* Actor = Entry.Actor.Get();
+    if (!Actor)
+    {
+        Entry.Bucket = NewBucket;
+        return;
+    }
+
+    const ENexusTickBucket OldBucket = Entry.Bucket;
+    Entry.Bucket = NewBucket;
+
+    // Waking up: re-enable only the ticks that were running before we put the actor to sleep
+    if (OldBucket == ENexusTickBucket::Dormant)
+    {
+        Actor->SetActorTickEnabled(Entry.bActorEnabledBeforeDormant);
+
+        for (const FComponentTickState& State : Entry.Components)
+        {
+            if (UActorComponent* Component = State.Component.Get())
+            {
+                Component->SetComponentTickEnabled(State.bEnabledBeforeDormant);
+            }
+        }
+    }
+
+    switch (NewBucket)
+    {
+    case ENexusTickBucket::Full:
+    {
+        Actor->SetActorTickInterval(Entry.DefaultActorInterval);
+
+        for (const FComponentTickState& State : Entry.Components)
+        {
+            if (UActorComponent* Component = State.Component.Get())
+            {
+                Component->SetComponentTickInterval(State.DefaultInterval);
+            }
+        }
+        break;
+    }
+
+    case ENexusTickBucket::Reduced:
+    {
+        // Tick every Nth frame, but never faster than the authored interval
+        const float ReducedInterval = ReducedFrameInterval * SmoothedDeltaTime;
+
+        Actor->SetActorTickInterval(FMath::Max(Entry.DefaultActorInterval, ReducedInterval));
+
+        for (const FComponentTickState& State : Entry.Components)
+        {
+            if (UActorComponent* Component = State.Component.Get())
+            {
+                // Meshes under the animation budget already skip updates at their own rate, so don't stack intervals on top
+                const USkinnedMeshComponent* SkinnedMesh = Cast<USkinnedMeshComponent>(Component);
+                const bool bRateControlled = SkinnedMesh && SkinnedMesh->IsUsingExternalTickRateControl();
+
+                Component->SetComponentTickInterval(bRateControlled ? State.DefaultInterval : FMath::Max(State.DefaultInterval, ReducedInterval));
+            }
+        }
+        break;
+    }
+
+    case ENexusTickBucket::Dormant:
+    {
+        // Remember what was running so other systems that toggle ticks keep their state
+        Entry.bActorEnabledBeforeDormant = Actor->IsActorTickEnabled();
+        Actor->SetActorTickEnabled(false);
+
+        for (FComponentTickState& State : Entry.Components)
+        {
+            if (UActorComponent* Component = State.Component.Get())
+            {
+                State.bEnabledBeforeDormant = Component->IsComponentTickEnabled();
+                Component->SetComponentTickEnabled(false);
+            }
+        }
+        break;
+    }
+    }
+}
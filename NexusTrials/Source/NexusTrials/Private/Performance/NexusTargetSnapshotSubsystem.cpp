@@ -0,0 +1,451 @@
+#include "Performance/NexusTargetSnapshotSubsystem.h"
+#include "Performance/NexusFrameScratch.h"
+#include "NexusTrials.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Target Snapshot Tick"), STAT_NexusTargetSnapshotTick, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Snapshot Agents"), STAT_NexusTargetSnapshotAgents, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Snapshot Targets"), STAT_NexusTargetSnapshotTargets, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Target Snapshot Refreshes"), STAT_NexusTargetSnapshotRefreshes, STATGROUP_NexusTrials);
+
+UNexusTargetSnapshotSubsystem* UNexusTargetSnapshotSubsystem::Get(const UObject* WorldContextObject)
+{
+    const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+    return World ? World->GetSubsystem<UNexusTargetSnapshotSubsystem>() : nullptr;
+}
+
+bool UNexusTargetSnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+    return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UNexusTargetSnapshotSubsystem::RegisterAgent(AActor* Agent, uint32 HostileMask, float SearchRange)
+{
+    if (!IsValid(Agent))
+    {
+        return;
+    }
+
+    // Already registered agents just pick again with their new settings
+    if (const int32* Index = AgentIndices.Find(Agent))
+    {
+        FAgentEntry& Entry = Agents[*Index];
+        Entry.HostileMask = HostileMask;
+        Entry.SearchRange = SearchRange;
+        Entry.bHasPicked = false;
+        return;
+    }
+
+    FAgentEntry& Entry = Agents.AddDefaulted_GetRef();
+    Entry.Actor = Agent;
+    Entry.Key = Agent;
+    Entry.HostileMask = HostileMask;
+    Entry.SearchRange = SearchRange;
+
+    AgentIndices.Add(Entry.Key, Agents.Num() - 1);
+}
+
+void UNexusTargetSnapshotSubsystem::BindTargetChanged(AActor* Agent, FOnNexusTargetChanged Delegate)
+{
+    if (const int32* Index = AgentIndices.Find(Agent))
+    {
+        Agents[*Index].OnTargetChanged = MoveTemp(Delegate);
+    }
+}
+
+void UNexusTargetSnapshotSubsystem::UnregisterAgent(AActor* Agent)
+{
+    if (const int32* Index = AgentIndices.Find(Agent))
+    {
+        RemoveAgentAt(*Index);
+    }
+}
+
+void UNexusTargetSnapshotSubsystem::RemoveAgentAt(int32 Index)
+{
+    const int32 LastIndex = Agents.Num() - 1;
+
+    AgentIndices.Remove(Agents[Index].Key);
+    Agents.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+    if (Index == LastIndex)
+    {
+        return;
+    }
+
+    // Fix up the entry that was swapped into the hole, and carry its last results along so reads stay right until the next snapshot
+    AgentIndices.Add(Agents[Index].Key, Index);
+
+    if (TargetDistance.IsValidIndex(LastIndex))
+    {
+        TargetDistanceSquared[Index] = TargetDistanceSquared[LastIndex];
+        TargetDistance[Index] = TargetDistance[LastIndex];
+    }
+}
+
+void UNexusTargetSnapshotSubsystem::RegisterTarget(APawn* Target, uint32 TeamMask)
+{
+    if (!IsValid(Target))
+    {
+        return;
+    }
+
+    const TObjectKey<AActor> Key(Target);
+
+    if (FRegisteredTarget* Existing = RegisteredTargets.FindByPredicate([&Key](const FRegisteredTarget& Registered) { return Registered.Key == Key; }))
+    {
+        Existing->TeamMask = TeamMask;
+        return;
+    }
+
+    FRegisteredTarget& Registered = RegisteredTargets.AddDefaulted_GetRef();
+    Registered.Pawn = Target;
+    Registered.Key = Key;
+    Registered.TeamMask = TeamMask;
+}
+
+void UNexusTargetSnapshotSubsystem::UnregisterTarget(APawn* Target)
+{
+    const TObjectKey<AActor> Key(Target);
+
+    RegisteredTargets.RemoveAllSwap([&Key](const FRegisteredTarget& Registered) { return Registered.Key == Key; }, EAllowShrinking::No);
+}
+
+bool UNexusTargetSnapshotSubsystem::GetTargetInfo(const AActor* Agent, FNexusTargetInfo& OutInfo) const
+{
+    const int32* Index = AgentIndices.Find(Agent);
+
+    // Agents registered since the last snapshot haven't picked a target yet
+    if (!Index || !Agents[*Index].bHasPicked || !TargetDistance.IsValidIndex(*Index))
+    {
+        return false;
+    }
+
+    OutInfo = FNexusTargetInfo();
+
+    const int32 TargetIndex = Agents[*Index].TargetIndex;
+
+    if (Targets.IsValidIndex(TargetIndex))
+    {
+        const FTargetEntry& Target = Targets[TargetIndex];
+
+        OutInfo.Target = Target.Pawn;
+        OutInfo.Location = Target.Location;
+        OutInfo.Velocity = Target.Velocity;
+        OutInfo.DistanceSquared = TargetDistanceSquared[*Index];
+        OutInfo.Distance = TargetDistance[*Index];
+    }
+
+    return true;
+}
+
+APawn* UNexusTargetSnapshotSubsystem::FindNearestTarget(const FVector& Location, uint32 HostileMask, float SearchRange, const AActor* Ignore) const
+{
+    const int32 TargetIndex = FindNearestTargetIndex(Location, HostileMask, SearchRange > 0.0f ? SearchRange : DefaultSearchRange, Ignore);
+    return Targets.IsValidIndex(TargetIndex) ? Targets[TargetIndex].Pawn.Get() : nullptr;
+}
+
+FIntPoint UNexusTargetSnapshotSubsystem::GetCell(const FVector& Location) const
+{
+    return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+int32 UNexusTargetSnapshotSubsystem::FindNearestTargetIndex(const FVector& Location, uint32 HostileMask, float SearchRange, const AActor* Ignore) const
+{
+    if (Targets.Num() == 0)
+    {
+        return INDEX_NONE;
+    }
+
+    const FIntPoint Center = GetCell(Location);
+
+    // Never search further out than the range, or than the occupied cells reach
+    const int32 RangeRings = FMath::CeilToInt32(SearchRange / CellSize);
+    const int32 BoundsRings = FMath::Max(
+        FMath::Max(FMath::Abs(MinCell.X - Center.X), FMath::Abs(MaxCell.X - Center.X)),
+        FMath::Max(FMath::Abs(MinCell.Y - Center.Y), FMath::Abs(MaxCell.Y - Center.Y)));
+    const int32 MaxRing = FMath::Min(RangeRings, BoundsRings);
+
+    int32 BestIndex = INDEX_NONE;
+    float BestDistanceSquared = FMath::Square(SearchRange);
+
+    // Walk outwards one ring of cells at a time
+    for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+    {
+        // Everything in this ring is at least Ring - 1 cells away, so a closer hit ends the search
+        if (Ring > 0 && FMath::Square((Ring - 1) * CellSize) > BestDistanceSquared)
+        {
+            break;
+        }
+
+        for (int32 CellY = FMath::Max(Center.Y - Ring, MinCell.Y); CellY <= FMath::Min(Center.Y + Ring, MaxCell.Y); ++CellY)
+        {
+            // Rows inside the ring only touch it at their two ends
+            const bool bEdgeRow = FMath::Abs(CellY - Center.Y) == Ring;
+            const int32 Step = bEdgeRow ? 1 : 2 * Ring;
+
+            for (int32 CellX = Center.X - Ring; CellX <= Center.X + Ring; CellX += Step)
+            {
+                if (CellX < MinCell.X || CellX > MaxCell.X)
+                {
+                    continue;
+                }
+
+                const FCellRange* Cell = Cells.Find(FIntPoint(CellX, CellY));
+
+                if (!Cell)
+                {
+                    continue;
+                }
+
+                for (int32 CellIndex = Cell->Start; CellIndex < Cell->Start + Cell->Num; ++CellIndex)
+                {
+                    const int32 TargetIndex = CellTargets[CellIndex];
+                    const FTargetEntry& Target = Targets[TargetIndex];
+
+                    if (!(Target.TeamMask & HostileMask) || Target.Pawn.Get() == Ignore)
+                    {
+                        continue;
+                    }
+
+                    const float DistanceSquared = static_cast<float>(FVector::DistSquared(Location, Target.Location));
+
+                    if (DistanceSquared < BestDistanceSquared)
+                    {
+                        BestIndex = TargetIndex;
+                        BestDistanceSquared = DistanceSquared;
+                    }
+                }
+            }
+        }
+    }
+
+    return BestIndex;
+}
+
+TStatId UNexusTargetSnapshotSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UNexusTargetSnapshotSubsystem, STATGROUP_Tickables);
+}
+
+void UNexusTargetSnapshotSubsystem::Tick(float DeltaTime)
+{
+    SCOPE_CYCLE_COUNTER(STAT_NexusTargetSnapshotTick);
+
+    GatherTargets();
+    RefreshAgents();
+    GatherAgents();
+    ComputeDistances();
+
+    SET_DWORD_STAT(STAT_NexusTargetSnapshotAgents, Agents.Num());
+    SET_DWORD_STAT(STAT_NexusTargetSnapshotTargets, Targets.Num());
+}
+
+void UNexusTargetSnapshotSubsystem::GatherTargets()
+{
+    Targets.Reset();
+    TargetIndices.Reset();
+
+    // Drop targets that went away without unregistering
+    RegisteredTargets.RemoveAllSwap([](const FRegisteredTarget& Registered) { return !Registered.Pawn.IsValid(); }, EAllowShrinking::No);
+
+    for (const FRegisteredTarget& Registered : RegisteredTargets)
+    {
+        APawn* Pawn = Registered.Pawn.Get();
+
+        FTargetEntry& Target = Targets.AddDefaulted_GetRef();
+        Target.Pawn = Pawn;
+        Target.Location = Pawn->GetActorLocation();
+        Target.Velocity = Pawn->GetVelocity();
+        Target.TeamMask = Registered.TeamMask;
+
+        TargetIndices.Add(Registered.Key, Targets.Num() - 1);
+    }
+
+    // Player pawns that didn't register are fair game for everyone
+    for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+    {
+        const APlayerController* PC = It->Get();
+        APawn* Pawn = PC ? PC->GetPawn() : nullptr;
+
+        if (IsValid(Pawn) && !TargetIndices.Contains(Pawn))
+        {
+            FTargetEntry& Target = Targets.AddDefaulted_GetRef();
+            Target.Pawn = Pawn;
+            Target.Location = Pawn->GetActorLocation();
+            Target.Velocity = Pawn->GetVelocity();
+
+            TargetIndices.Add(Pawn, Targets.Num() - 1);
+        }
+    }
+
+    Origin = Targets.Num() > 0 ? Targets[0].Location : FVector::ZeroVector;
+
+    // Bucket the targets by cell: count them, lay the cells out back to back, then fill them in
+    Cells.Reset();
+    CellTargets.SetNumUninitialized(Targets.Num(), EAllowShrinking::No);
+
+    TNexusFrameArray<FIntPoint> TargetCells;
+    TargetCells.Reserve(Targets.Num());
+
+    MinCell = FIntPoint(MAX_int32, MAX_int32);
+    MaxCell = FIntPoint(MIN_int32, MIN_int32);
+
+    for (const FTargetEntry& Target : Targets)
+    {
+        const FIntPoint Cell = GetCell(Target.Location);
+        TargetCells.Add(Cell);
+
+        ++Cells.FindOrAdd(Cell).Num;
+
+        MinCell = FIntPoint(FMath::Min(MinCell.X, Cell.X), FMath::Min(MinCell.Y, Cell.Y));
+        MaxCell = FIntPoint(FMath::Max(MaxCell.X, Cell.X), FMath::Max(MaxCell.Y, Cell.Y));
+    }
+
+    int32 Start = 0;
+
+    for (TPair<FIntPoint, FCellRange>& Cell : Cells)
+    {
+        Cell.Value.Start = Start;
+        Start += Cell.Value.Num;
+        Cell.Value.Num = 0;
+    }
+
+    for (int32 TargetIndex = 0; TargetIndex < Targets.Num(); ++TargetIndex)
+    {
+        FCellRange& Cell = Cells.FindChecked(TargetCells[TargetIndex]);
+        CellTargets[Cell.Start + Cell.Num++] = TargetIndex;
+    }
+}
+
+void UNexusTargetSnapshotSubsystem::RefreshAgents()
+{
+    // Drop agents that went away without unregistering
+    for (int32 Index = Agents.Num() - 1; Index >= 0; --Index)
+    {
+        if (!Agents[Index].Actor.IsValid())
+        {
+            RemoveAgentAt(Index);
+        }
+    }
+
+    int32 NumRefreshes = 0;
+
+    // Change notifications are held until every agent has picked, since listeners may unregister
+    TArray<TPair<FOnNexusTargetChanged, TWeakObjectPtr<APawn>>, TInlineAllocator<16>> Changes;
+
+    auto PickTarget = [this, &NumRefreshes, &Changes](FAgentEntry& Entry)
+    {
+        const AActor* Agent = Entry.Actor.Get();
+        const float SearchRange = Entry.SearchRange > 0.0f ? Entry.SearchRange : DefaultSearchRange;
+        const TObjectKey<AActor> PreviousKey = Entry.TargetKey;
+
+        Entry.TargetIndex = FindNearestTargetIndex(Agent->GetActorLocation(), Entry.HostileMask, SearchRange, Agent);
+        APawn* NewTarget = Targets.IsValidIndex(Entry.TargetIndex) ? Targets[Entry.TargetIndex].Pawn.Get() : nullptr;
+        Entry.TargetKey = TObjectKey<AActor>(NewTarget);
+        Entry.bHasPicked = true;
+
+        if (Entry.TargetKey != PreviousKey && Entry.OnTargetChanged.IsBound())
+        {
+            Changes.Emplace(Entry.OnTargetChanged, NewTarget);
+        }
+
+        ++NumRefreshes;
+    };
+
+    // Find last frame's targets in the new snapshot. New agents and agents whose target went away pick right away
+    for (FAgentEntry& Entry : Agents)
+    {
+        const int32* TargetIndex = TargetIndices.Find(Entry.TargetKey);
+        Entry.TargetIndex = TargetIndex ? *TargetIndex : INDEX_NONE;
+
+        const bool bLostTarget = Entry.TargetKey != TObjectKey<AActor>() && !TargetIndex;
+
+        if (!Entry.bHasPicked || bLostTarget)
+        {
+            PickTarget(Entry);
+        }
+    }
+
+    // Everyone else re-picks on a round-robin, so a closer target is noticed within a few frames
+    const int32 NumScheduled = FMath::Min(RefreshesPerFrame, Agents.Num());
+
+    for (int32 Count = 0; Count < NumScheduled; ++Count)
+    {
+        NextRefreshIndex = (NextRefreshIndex + 1) % Agents.Num();
+        PickTarget(Agents[NextRefreshIndex]);
+    }
+
+    for (const TPair<FOnNexusTargetChanged, TWeakObjectPtr<APawn>>& Change : Changes)
+    {
+        Change.Key.ExecuteIfBound(Change.Value.Get());
+    }
+
+    SET_DWORD_STAT(STAT_NexusTargetSnapshotRefreshes, NumRefreshes);
+}
+
+void UNexusTargetSnapshotSubsystem::GatherAgents()
+{
+    const int32 NumPadded = Align(Agents.Num(), 4);
+
+    AgentX.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    AgentY.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    AgentZ.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    AgentTargetX.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    AgentTargetY.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    AgentTargetZ.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+
+    TargetDistanceSquared.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+    TargetDistance.SetNumUninitialized(NumPadded, EAllowShrinking::No);
+
+    for (int32 Index = 0; Index < Agents.Num(); ++Index)
+    {
+        const FAgentEntry& Entry = Agents[Index];
+        const FVector3f Relative(Entry.Actor->GetActorLocation() - Origin);
+
+        // Agents without a target measure against themselves
+        const FVector3f TargetRelative = Targets.IsValidIndex(Entry.TargetIndex) ? FVector3f(Targets[Entry.TargetIndex].Location - Origin) : Relative;
+
+        AgentX[Index] = Relative.X;
+        AgentY[Index] = Relative.Y;
+        AgentZ[Index] = Relative.Z;
+        AgentTargetX[Index] = TargetRelative.X;
+        AgentTargetY[Index] = TargetRelative.Y;
+        AgentTargetZ[Index] = TargetRelative.Z;
+    }
+
+    // Padding lanes are computed along with the rest and ignored
+    for (int32 Index = Agents.Num(); Index < NumPadded; ++Index)
+    {
+        AgentX[Index] = AgentY[Index] = AgentZ[Index] = 0.0f;
+        AgentTargetX[Index] = AgentTargetY[Index] = AgentTargetZ[Index] = 0.0f;
+    }
+}
+
+void UNexusTargetSnapshotSubsystem::ComputeDistances()
+{
+    const float* RESTRICT X = AgentX.GetData();
+    const float* RESTRICT Y = AgentY.GetData();
+    const float* RESTRICT Z = AgentZ.GetData();
+    const float* RESTRICT TX = AgentTargetX.GetData();
+    const float* RESTRICT TY = AgentTargetY.GetData();
+    const float* RESTRICT TZ = AgentTargetZ.GetData();
+
+    float* RESTRICT OutDistanceSquared = TargetDistanceSquared.GetData();
+    float* RESTRICT OutDistance = TargetDistance.GetData();
+
+    for (int32 Index = 0; Index < AgentX.Num(); Index += 4)
+    {
+        const VectorRegister4Float DeltaX = VectorSubtract(VectorLoadAligned(X + Index), VectorLoadAligned(TX + Index));
+        const VectorRegister4Float DeltaY = VectorSubtract(VectorLoadAligned(Y + Index), VectorLoadAligned(TY + Index));
+        const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoadAligned(Z + Index), VectorLoadAligned(TZ + Index));
+
+        const VectorRegister4Float DistanceSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, VectorMultiplyAdd(DeltaY, DeltaY, VectorMultiply(DeltaX, DeltaX)));
+
+        VectorStoreAligned(DistanceSquared, OutDistanceSquared + Index);
+        VectorStoreAligned(VectorSqrt(DistanceSquared), OutDistance + Index);
+    }
+}
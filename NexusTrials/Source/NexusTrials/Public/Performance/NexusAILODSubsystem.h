@@ -0,0 +1,178 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NexusAILODSubsystem.generated.h"
+
+class AAIController;
+class UBrainComponent;
+
+/**
+ * StateTree evaluation rate assigned to a registered AI controller
+ */
+UENUM(BlueprintType)
+enum class ENexusAILOD : uint8
+{
+    /** Evaluates every frame on its own component tick */
+    Full,
+
+    /** Evaluates every Nth frame, staggered across frames with the other reduced controllers */
+    Reduced,
+
+    /** Doesn't evaluate at all. The StateTree keeps its active states and picks up where it left off */
+    Suspended
+};
+
+/**
+ * UNexusAILODSubsystem - StateTree evaluation LOD for AI controllers
+ *
+ * Responsibility:
+ * - Pick an evaluation rate for every registered controller from its pawn's significance and activity
+ * - Evaluate reduced controllers every Nth frame, each on its own frame phase so the work is spread out
+ * - Suspend controllers whose pawn went dormant, keeping their StateTree state until they wake up
+ * - Evaluate right away on critical events (damage, danger, landing), then hold the controller at full rate
+ *
+ * Controllers opt in by calling RegisterController from OnPossess and UnregisterController from OnUnPossess.
+ * Distance and visibility come from UNexusSignificanceSubsystem, so the pawn should be registered there too.
+ * Reduced controllers have their component tick turned off and are evaluated from here with the time they skipped,
+ * so StateTree delays and timers still run at the right speed.
+ */
+UCLASS(Config = Game)
+class NEXUSTRIALS_API UNexusAILODSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the subsystem for the world the provided object lives in, if any */
+    static UNexusAILODSubsystem* Get(const UObject* WorldContextObject);
+
+    //================== Registration ==================
+
+    /** Start managing the StateTree evaluation rate of a controller */
+    void RegisterController(AAIController* Controller);
+
+    /** Stop managing a controller and restore its component tick */
+    void UnregisterController(AAIController* Controller);
+
+    /**
+     * Evaluates the agent's StateTree at the end of this frame, even if it's reduced or suspended,
+     * and holds it at full rate for CriticalHoldTime seconds
+     * @param Agent The AI controller or the pawn it controls
+     */
+    void RequestImmediateEvaluation(const AActor* Agent);
+
+    //================== Queries ==================
+
+    /** Returns the LOD the agent is currently in. Unregistered agents are always Full */
+    ENexusAILOD GetLOD(const AActor* Agent) const;
+
+    /** Returns the number of registered controllers in the provided LOD */
+    int32 GetLODCount(ENexusAILOD LOD) const;
+
+    /** Returns the number of registered controllers */
+    int32 GetNumRegistered() const { return Entries.Num(); }
+
+    /** Logs LOD counts and the estimated number of StateTree evaluations saved per second */
+    void LogReport() const;
+
+    //================== UTickableWorldSubsystem ==================
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void Deinitialize() override;
+
+    //================== Tuning ==================
+
+    /** Max number of controllers re-assigned a LOD per frame */
+    UPROPERTY(Config, EditAnywhere, Category = "AI LOD", meta = (ClampMin = 1))
+    int32 EvaluationsPerFrame = 64;
+
+    /** Reduced controllers evaluate once every this many frames */
+    UPROPERTY(Config, EditAnywhere, Category = "AI LOD", meta = (ClampMin = 2, ClampMax = 30))
+    int32 ReducedFrameInterval = 4;
+
+    /** Pawns moving slower than this with no recent critical event count as idle and drop to reduced, unless they're engaged */
+    UPROPERTY(Config, EditAnywhere, Category = "AI LOD", meta = (Units = "cm/s"))
+    float IdleSpeed = 10.0f;
+
+    /** Pawns within this distance of their focus actor or a player are engaged and never count as idle. Should cover the AI's attack range */
+    UPROPERTY(Config, EditAnywhere, Category = "AI LOD", meta = (ClampMin = 0, Units = "cm"))
+    float EngageDistance = 500.0f;
+
+    /** Time a controller is held at full rate after a critical event */
+    UPROPERTY(Config, EditAnywhere, Category = "AI LOD", meta = (Units = "s"))
+    float CriticalHoldTime = 3.0f;
+
+private:
+
+    /** Per-controller bookkeeping */
+    struct FAILODEntry
+    {
+        TWeakObjectPtr<AAIController> Controller;
+
+        /** Lookup key, kept so stale controllers can still be removed from the index */
+        TObjectKey<AAIController> Key;
+
+        TWeakObjectPtr<UBrainComponent> Brain;
+
+        /** Time skipped since the last reduced evaluation */
+        float PendingDeltaTime = 0.0f;
+
+        float LastCriticalTime = -1000.0f;
+
+        /** Frame offset for reduced evaluations, so they don't all land on the same frame */
+        int32 Phase = 0;
+
+        ENexusAILOD LOD = ENexusAILOD::Full;
+
+        /** True if the brain's tick was enabled before we took it over */
+        bool bTickEnabledBefore = true;
+
+        /** True if a critical event asked for an evaluation this frame */
+        bool bEvaluateNow = false;
+    };
+
+    /** Picks the LOD for an entry */
+    ENexusAILOD LODForEntry(const FAILODEntry& Entry, float TimeSeconds) const;
+
+    /** Returns true if the pawn is within EngageDistance of its controller's focus actor or any player pawn */
+    bool IsEngaged(const AAIController* Controller, const APawn* Pawn) const;
+
+    /** Applies a LOD change to the entry's brain component */
+    void ApplyLOD(FAILODEntry& Entry, ENexusAILOD NewLOD);
+
+    /** Removes the entry at the provided index */
+    void RemoveEntryAt(int32 Index);
+
+    /** Returns the entry index for a controller or the pawn it controls */
+    const int32* FindEntryIndex(const AActor* Agent) const;
+
+    /** Registered controllers */
+    TArray<FAILODEntry> Entries;
+
+    /** Controller to entry index lookup */
+    TMap<TObjectKey<AAIController>, int32> EntryIndices;
+
+    /** Round-robin cursor into Entries */
+    int32 NextEvaluationIndex = 0;
+
+    /** Next phase handed out to a new entry */
+    int32 NextPhase = 0;
+
+    /** Frames ticked so far, used with each entry's phase to stagger reduced evaluations */
+    uint32 FrameCounter = 0;
+
+    /** Smoothed frame time, used for the report */
+    float SmoothedDeltaTime = 1.0f / 60.0f;
+
+    /** True if the policy was enabled last frame, so we can restore everything when it gets disabled */
+    bool bWasEnabled = true;
+
+    /** True while we're walking the entries, so unregistering defers the removal */
+    bool bIsTicking = false;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+namespace NexusAllocationCounter { class FCountingMalloc; }
+
+/**
+ * FNexusScopedAllocationCounter - Counts game thread heap allocations inside a scope
+ *
+ * Responsibility:
+ * - Wrap GMalloc with a forwarding allocator for the lifetime of the scope
+ * - Count allocations and reallocations made from the game thread, so tests can hold gameplay code to an allocation budget
+ *
+ * Other threads keep allocating through the wrapped allocator but aren't counted.
+ * Scopes can't be nested, and nothing else may replace GMalloc while one is alive.
+ * The wrapped allocator is always put back when the scope ends, even if that rule was broken.
+ * Meant for tests and profiling sessions, not for shipping code paths.
+ */
+class NEXUSTRIALS_API FNexusScopedAllocationCounter
+{
+public:
+
+    UE_NONCOPYABLE(FNexusScopedAllocationCounter);
+
+    FNexusScopedAllocationCounter();
+    ~FNexusScopedAllocationCounter();
+
+    /** Returns the number of game thread allocations since the scope started or since the last reset */
+    int64 GetNumAllocations() const;
+
+    /** Starts counting from zero again, e.g. at the start of each simulated frame */
+    void ResetCount();
+
+private:
+
+    /** GMalloc before the scope started */
+    FMalloc* InnerMalloc = nullptr;
+
+    /** The forwarding allocator installed for the scope */
+    NexusAllocationCounter::FCountingMalloc* CountingMalloc = nullptr;
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "NexusAnimBudgetSubsystem.generated.h"
+
+class UAnimMontage;
+class USkeletalMeshComponent;
+
+/**
+ * UNexusAnimBudgetSubsystem - Animation update rate budget for skeletal meshes
+ *
+ * Responsibility:
+ * - Pick an animation update rate for every registered mesh from its owner's significance
+ * - Keep the number of animation updates per frame under a cap by slowing down the least significant meshes first
+ * - Interpolate skipped frames for meshes that are on screen, and skip them outright for meshes that aren't
+ * - Update every frame while a montage plays, so montage notifies (attack traces, combo and charge checks) fire on their exact frame.
+ *   A montage that starts mid-frame forces an update right away, in case the mesh hasn't ticked yet
+ * - On dedicated servers, only tick montages, and only refresh bones while one plays
+ *
+ * Meshes opt in by calling RegisterMesh from BeginPlay and UnregisterMesh from EndPlay.
+ * Significance comes from UNexusSignificanceSubsystem, so the owner should be registered there too.
+ * Update decisions are made before actors tick each frame, using the engine's external tick rate control on the mesh.
+ * The cap counts updates, not milliseconds: tune MaxUpdatesPerFrame against 'stat Anim' or the benchmark's AnimationMs.
+ */
+UCLASS(Config = Game)
+class NEXUSTRIALS_API UNexusAnimBudgetSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the subsystem for the world the provided object lives in, if any */
+    static UNexusAnimBudgetSubsystem* Get(const UObject* WorldContextObject);
+
+    //================== Registration ==================
+
+    /** Start managing the animation update rate of a mesh */
+    void RegisterMesh(USkeletalMeshComponent* Mesh);
+
+    /** Stop managing a mesh and restore its authored update settings */
+    void UnregisterMesh(USkeletalMeshComponent* Mesh);
+
+    //================== Queries ==================
+
+    /** Returns the frames between animation updates for the mesh. Unregistered meshes update every frame */
+    int32 GetUpdateRate(const USkeletalMeshComponent* Mesh) const;
+
+    /** Returns the number of registered meshes */
+    int32 GetNumRegistered() const { return Entries.Num(); }
+
+    /** Logs the update rate distribution and the updates per frame against the cap */
+    void LogReport() const;
+
+protected:
+
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void Deinitialize() override;
+
+    //================== Tuning ==================
+
+    /** Average animation updates per frame we try to stay under. Meshes that can't skip frames still count, but never slow down */
+    UPROPERTY(Config, EditAnywhere, Category = "Anim Budget", meta = (ClampMin = 1))
+    int32 MaxUpdatesPerFrame = 25;
+
+    /** Meshes whose owner scores at least this significance always update every frame */
+    UPROPERTY(Config, EditAnywhere, Category = "Anim Budget", meta = (ClampMin = 0, ClampMax = 1))
+    float FullRateSignificance = 0.6f;
+
+    /** Most frames between two updates of the same mesh */
+    UPROPERTY(Config, EditAnywhere, Category = "Anim Budget", meta = (ClampMin = 1, ClampMax = 30))
+    int32 MaxUpdateRate = 8;
+
+    /** On-screen meshes interpolate skipped frames up to this update rate, and just hold their pose past it */
+    UPROPERTY(Config, EditAnywhere, Category = "Anim Budget", meta = (ClampMin = 1, ClampMax = 30))
+    int32 MaxInterpolatedRate = 4;
+
+private:
+
+    /** Per-mesh bookkeeping */
+    struct FAnimBudgetEntry
+    {
+        TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+
+        /** Lookup key, kept so stale meshes can still be removed from the index */
+        TObjectKey<USkeletalMeshComponent> Key;
+
+        /** Time since the last update, handed to the mesh on its next update */
+        float AccumulatedDeltaTime = 0.0f;
+
+        /** Owner significance captured this frame */
+        float Significance = 1.0f;
+
+        /** Frame offset for reduced updates, so they don't all land on the same frame */
+        int32 Phase = 0;
+
+        /** Frames between two updates */
+        int32 UpdateRate = 1;
+
+        /** True if the mesh has to update every frame, e.g. while a montage plays */
+        bool bNeverSkip = false;
+
+        /** Authored settings, restored on unregistration */
+        bool bURODefault = false;
+        EVisibilityBasedAnimTickOption TickOptionDefault = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+    };
+
+    /** Picks update rates for every mesh and hands each one its update decision for this frame */
+    void OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+    /** Forces an update this frame for every skipping mesh that just started the montage */
+    UFUNCTION()
+    void OnMontageStarted(UAnimMontage* Montage);
+
+    /** Puts a mesh on full rate and makes it update this frame, if it hasn't ticked yet */
+    void ForceUpdate(FAnimBudgetEntry& Entry) const;
+
+    /** Sets up a mesh for external update control */
+    void TakeControl(FAnimBudgetEntry& Entry) const;
+
+    /** Hands a mesh back with its authored settings */
+    void ReleaseControl(FAnimBudgetEntry& Entry) const;
+
+    /** Removes the entry at the provided index */
+    void RemoveEntryAt(int32 Index);
+
+    /** Registered meshes */
+    TArray<FAnimBudgetEntry> Entries;
+
+    /** Mesh to entry index lookup */
+    TMap<TObjectKey<USkeletalMeshComponent>, int32> EntryIndices;
+
+    /** Entry indices in ascending significance, rebuilt every frame for the budget pass */
+    TArray<int32> BudgetOrder;
+
+    /** Next phase handed out to a new entry */
+    int32 NextPhase = 0;
+
+    /** Frames processed so far, used with each entry's phase to stagger reduced updates */
+    uint32 FrameCounter = 0;
+
+    /** Average animation updates per frame from the last rate pick */
+    float UpdatesPerFrame = 0.0f;
+
+    /** True if the policy was enabled last frame, so we can restore everything when it gets disabled */
+    bool bWasEnabled = true;
+
+    FDelegateHandle PreActorTickHandle;
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/ContainerAllocationPolicies.h"
+
+/**
+ * FNexusFrameScratch - Per-frame linear scratch memory for game thread queries
+ *
+ * Responsibility:
+ * - Hand out short-lived memory for query results and temporary arrays with a pointer bump
+ * - Reset everything in one go at the end of the frame, keeping its blocks for the next frame
+ *
+ * Memory is only valid until the end of the frame it was allocated on, so it must never be stored
+ * in members or captured by anything that runs later. Game thread only.
+ * Once the block list has grown to the peak frame's usage, a frame does no heap allocations at all.
+ */
+class NEXUSTRIALS_API FNexusFrameScratch
+{
+public:
+
+    /** Returns the game thread scratch. Binds the end of frame reset on first use */
+    static FNexusFrameScratch& Get();
+
+    /** Allocates scratch memory that lives until the end of the frame */
+    void* Allocate(SIZE_T Size, uint32 Alignment);
+
+    /** Releases everything allocated this frame. Called automatically at the end of each frame */
+    void Reset();
+
+    /** Returns the number of frame resets so far, so allocations can be checked against the frame they came from */
+    uint64 GetFrame() const { return Frame; }
+
+    /** Returns the bytes handed out since the last reset */
+    SIZE_T GetBytesUsed() const { return BytesUsed; }
+
+    /** Returns the most bytes handed out in a single frame so far */
+    SIZE_T GetPeakBytesUsed() const { return FMath::Max(PeakBytesUsed, BytesUsed); }
+
+    /** Returns the bytes reserved across all blocks */
+    SIZE_T GetBytesReserved() const { return static_cast<SIZE_T>(Blocks.Num()) * BlockSize; }
+
+    ~FNexusFrameScratch();
+
+private:
+
+    FNexusFrameScratch() = default;
+
+    /** Size of each block. Allocations larger than this get a dedicated block that's freed on reset */
+    static constexpr SIZE_T BlockSize = 64 * 1024;
+
+    /** Reusable blocks, kept across frames */
+    TArray<uint8*> Blocks;
+
+    /** Oversized allocations, freed on reset */
+    TArray<uint8*> LargeBlocks;
+
+    /** Block currently being bumped */
+    int32 CurrentBlock = 0;
+
+    /** Offset of the next free byte in the current block */
+    SIZE_T Offset = 0;
+
+    /** Bytes handed out since the last reset */
+    SIZE_T BytesUsed = 0;
+
+    /** Peak bytes handed out in a single frame */
+    SIZE_T PeakBytesUsed = 0;
+
+    /** Number of resets so far */
+    uint64 Frame = 0;
+};
+
+/**
+ * TArray allocation policy backed by the frame scratch.
+ * Growing copies into fresh scratch memory, and the old memory is reclaimed with the rest at the end of the frame.
+ * Arrays using it must not outlive the frame.
+ */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TNexusFrameAllocator
+{
+public:
+
+    using SizeType = int32;
+
+    enum { NeedsElementType = true };
+    enum { RequireRangeCheck = true };
+
+    class ForAnyElementType
+    {
+    public:
+
+        ForAnyElementType() = default;
+
+        FORCEINLINE void MoveToEmpty(ForAnyElementType& Other)
+        {
+            checkSlow(this != &Other);
+
+            Data = Other.Data;
+            Other.Data = nullptr;
+
+#if DO_CHECK
+            AllocFrame = Other.AllocFrame;
+#endif
+        }
+
+        FORCEINLINE FScriptContainerElement* GetAllocation() const
+        {
+            return Data;
+        }
+
+        void ResizeAllocation(SizeType CurrentNum, SizeType NewMax, SIZE_T NumBytesPerElement)
+        {
+            FNexusFrameScratch& Scratch = FNexusFrameScratch::Get();
+
+#if DO_CHECK
+            // catch arrays that were kept past the end of the frame their memory came from
+            checkf(!Data || AllocFrame == Scratch.GetFrame(), TEXT("Frame scratch array used after the frame it was allocated on"));
+            AllocFrame = Scratch.GetFrame();
+#endif
+
+            FScriptContainerElement* OldData = Data;
+
+            if (NewMax > 0)
+            {
+                Data = static_cast<FScriptContainerElement*>(Scratch.Allocate(static_cast<SIZE_T>(NewMax) * NumBytesPerElement, FMath::Max(Alignment, 16u)));
+
+                if (OldData && CurrentNum > 0)
+                {
+                    FMemory::Memcpy(Data, OldData, static_cast<SIZE_T>(FMath::Min(CurrentNum, NewMax)) * NumBytesPerElement);
+                }
+
+            } else {
+
+                Data = nullptr;
+            }
+        }
+
+        FORCEINLINE SizeType CalculateSlackReserve(SizeType NewMax, SIZE_T NumBytesPerElement) const
+        {
+            return DefaultCalculateSlackReserve(NewMax, NumBytesPerElement, false, Alignment);
+        }
+
+        FORCEINLINE SizeType CalculateSlackShrink(SizeType NewMax, SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+        {
+            return DefaultCalculateSlackShrink(NewMax, CurrentMax, NumBytesPerElement, false, Alignment);
+        }
+
+        FORCEINLINE SizeType CalculateSlackGrow(SizeType NewMax, SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+        {
+            return DefaultCalculateSlackGrow(NewMax, CurrentMax, NumBytesPerElement, false, Alignment);
+        }
+
+        SIZE_T GetAllocatedSize(SizeType CurrentMax, SIZE_T NumBytesPerElement) const
+        {
+            return static_cast<SIZE_T>(CurrentMax) * NumBytesPerElement;
+        }
+
+        bool HasAllocation() const
+        {
+            return !!Data;
+        }
+
+        SizeType GetInitialCapacity() const
+        {
+            return 0;
+        }
+
+    private:
+
+        ForAnyElementType(const ForAnyElementType&) = delete;
+        ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+        /** Scratch memory holding the elements */
+        FScriptContainerElement* Data = nullptr;
+
+#if DO_CHECK
+        /** Scratch frame the memory came from */
+        uint64 AllocFrame = 0;
+#endif
+    };
+
+    template<typename ElementType>
+    class ForElementType : public ForAnyElementType
+    {
+    public:
+
+        FORCEINLINE ElementType* GetAllocation() const
+        {
+            return (ElementType*)ForAnyElementType::GetAllocation();
+        }
+    };
+};
+
+template<uint32 Alignment>
+struct TAllocatorTraits<TNexusFrameAllocator<Alignment>> : TAllocatorTraitsBase<TNexusFrameAllocator<Alignment>>
+{
+    enum { SupportsMove = true };
+    enum { IsZeroConstruct = true };
+};
+
+/** Array whose memory comes from the frame scratch. Use for query results and temporaries that die within the frame */
+template<typename ElementType>
+using TNexusFrameArray = TArray<ElementType, TNexusFrameAllocator<>>;
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NexusMovementLODSubsystem.generated.h"
+
+class ACharacter;
+
+/**
+ * UNexusMovementLODSubsystem - Lightweight movement for distant AI characters
+ *
+ * Responsibility:
+ * - Switch walking AI characters with low significance to nav walking, which follows the navmesh surface
+ *   with point projection instead of floor sweeps, step-ups and perch checks
+ * - Switch them back to full walking as soon as they become significant again, with some hysteresis
+ * - Never touch player-controlled characters, characters playing root motion, or anything not walking on the ground
+ *
+ * Characters opt in by calling RegisterCharacter from BeginPlay and UnregisterCharacter from EndPlay.
+ * Significance comes from UNexusSignificanceSubsystem, so the character should be registered there too.
+ * Leaving nav walking goes through the movement component, which keeps retrying until the capsule fits,
+ * so characters never pop into geometry. Falls, launches and ragdolls leave nav walking on their own.
+ * Only runs with authority; simulated proxies follow the replicated movement mode.
+ */
+UCLASS(Config = Game)
+class NEXUSTRIALS_API UNexusMovementLODSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the subsystem for the world the provided object lives in, if any */
+    static UNexusMovementLODSubsystem* Get(const UObject* WorldContextObject);
+
+    //================== Registration ==================
+
+    /** Start managing the movement mode of a character */
+    void RegisterCharacter(ACharacter* Character);
+
+    /** Stop managing a character, putting it back on full walking if needed */
+    void UnregisterCharacter(ACharacter* Character);
+
+    //================== Queries ==================
+
+    /** Returns true if the character is currently on lightweight movement */
+    bool IsLightweight(const ACharacter* Character) const;
+
+    /** Returns the number of characters currently on lightweight movement */
+    int32 GetNumLightweight() const;
+
+    /** Returns the number of registered characters */
+    int32 GetNumRegistered() const { return Entries.Num(); }
+
+    /** Logs the number of lightweight characters */
+    void LogReport() const;
+
+    //================== UTickableWorldSubsystem ==================
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void Deinitialize() override;
+
+    //================== Tuning ==================
+
+    /** Max number of characters re-evaluated per frame */
+    UPROPERTY(Config, EditAnywhere, Category = "Movement LOD", meta = (ClampMin = 1))
+    int32 EvaluationsPerFrame = 64;
+
+    /** Characters scoring below this significance switch to lightweight movement */
+    UPROPERTY(Config, EditAnywhere, Category = "Movement LOD", meta = (ClampMin = 0, ClampMax = 1))
+    float LightweightSignificance = 0.35f;
+
+    /** Lightweight characters scoring at least this significance switch back to full walking. Keep above LightweightSignificance */
+    UPROPERTY(Config, EditAnywhere, Category = "Movement LOD", meta = (ClampMin = 0, ClampMax = 1))
+    float FullSignificance = 0.45f;
+
+    /** If false, lightweight characters move along the navmesh without any capsule sweep, so they can overlap each other */
+    UPROPERTY(Config, EditAnywhere, Category = "Movement LOD")
+    bool bSweepWhileLightweight = false;
+
+private:
+
+    /** Per-character bookkeeping */
+    struct FMovementLODEntry
+    {
+        TWeakObjectPtr<ACharacter> Character;
+
+        /** Lookup key, kept so stale characters can still be removed from the index */
+        TObjectKey<ACharacter> Key;
+
+        /** Authored nav walking sweep setting, restored when leaving lightweight movement */
+        bool bSweepDefault = true;
+
+        /** True while we have the character on nav walking */
+        bool bLightweight = false;
+    };
+
+    /** Switches an entry to lightweight or full movement, if its current state allows it */
+    void Evaluate(FMovementLODEntry& Entry, float SignificanceScore);
+
+    /** Puts the character on nav walking */
+    void EnterLightweight(FMovementLODEntry& Entry) const;
+
+    /** Puts the character back on full walking */
+    void LeaveLightweight(FMovementLODEntry& Entry) const;
+
+    /** Removes the entry at the provided index */
+    void RemoveEntryAt(int32 Index);
+
+    /** Registered characters */
+    TArray<FMovementLODEntry> Entries;
+
+    /** Character to entry index lookup */
+    TMap<TObjectKey<ACharacter>, int32> EntryIndices;
+
+    /** Round-robin cursor into Entries */
+    int32 NextEvaluationIndex = 0;
+
+    /** True if the policy was enabled last frame, so we can restore everything when it gets disabled */
+    bool bWasEnabled = true;
+};
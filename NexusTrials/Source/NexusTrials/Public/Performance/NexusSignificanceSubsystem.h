@@ -0,0 +1,185 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NexusSignificanceSubsystem.generated.h"
+
+class UActorComponent;
+
+/**
+ * Tick rate bucket assigned to a registered actor
+ */
+UENUM(BlueprintType)
+enum class ENexusTickBucket : uint8
+{
+    /** Ticks every frame with its authored tick intervals */
+    Full,
+
+    /** Ticks every Nth frame */
+    Reduced,
+
+    /** Actor and component ticks are disabled until the actor becomes significant again */
+    Dormant
+};
+
+/**
+ * UNexusSignificanceSubsystem - Tick LOD manager for gameplay actors
+ *
+ * Responsibility:
+ * - Score registered actors from distance to players, visibility and combat activity
+ * - Bucket them into full, reduced (every Nth frame) and dormant tick rates
+ * - Apply the bucket to the actor tick and its ticking components together
+ *
+ * Actors opt in by calling RegisterActor from BeginPlay and UnregisterActor from EndPlay.
+ * Only a fixed number of actors is re-scored each frame, so the cost stays flat with actor count.
+ * Player-controlled pawns and actors with recent combat activity always stay in the full bucket.
+ */
+UCLASS(Config = Game)
+class NEXUSTRIALS_API UNexusSignificanceSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the subsystem for the world the provided object lives in, if any */
+    static UNexusSignificanceSubsystem* Get(const UObject* WorldContextObject);
+
+    //================== Registration ==================
+
+    /**
+     * Start managing the tick rate of an actor
+     * @param Actor Actor to manage
+     * @param bAllowDormant If false, the actor is never put to sleep and bottoms out at the reduced bucket
+     */
+    void RegisterActor(AActor* Actor, bool bAllowDormant = true);
+
+    /** Stop managing an actor and restore its authored tick settings */
+    void UnregisterActor(AActor* Actor);
+
+    /**
+     * Marks the actor as being in combat, promoting it to the full bucket right away
+     * and holding it there for CombatHoldTime seconds
+     */
+    void NotifyCombatActivity(AActor* Actor);
+
+    //================== Queries ==================
+
+    /** Returns the bucket the actor is currently in. Unregistered actors are always Full */
+    ENexusTickBucket GetBucket(const AActor* Actor) const;
+
+    /** Returns the last computed 0-1 significance score for the actor. Unregistered actors score 1 */
+    float GetSignificance(const AActor* Actor) const;
+
+    /** Returns the number of registered actors in the provided bucket */
+    int32 GetBucketCount(ENexusTickBucket Bucket) const;
+
+    /** Returns the number of registered actors */
+    int32 GetNumRegistered() const { return Entries.Num(); }
+
+    /** Logs bucket counts and the estimated number of actor ticks saved per second */
+    void LogReport() const;
+
+    //================== UTickableWorldSubsystem ==================
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+    virtual void Deinitialize() override;
+
+    //================== Tuning ==================
+
+    /** Max number of actors re-scored per frame */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance")
+    int32 EvaluationsPerFrame = 64;
+
+    /** Actors closer than this to any player always tick at full rate */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (Units = "cm"))
+    float AlwaysFullDistance = 1500.0f;
+
+    /** Distance past which an actor scores zero significance */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (Units = "cm"))
+    float DormantDistance = 8000.0f;
+
+    /** Score multiplier for actors that have not been rendered recently. Ignored on dedicated servers */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = 0, ClampMax = 1))
+    float HiddenScoreScale = 0.5f;
+
+    /** Minimum score to tick at full rate */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = 0, ClampMax = 1))
+    float FullScoreThreshold = 0.6f;
+
+    /** Minimum score to keep ticking at all */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = 0, ClampMax = 1))
+    float DormantScoreThreshold = 0.1f;
+
+    /** Reduced bucket actors tick once every this many frames */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (ClampMin = 2, ClampMax = 30))
+    int32 ReducedFrameInterval = 4;
+
+    /** Time an actor is held at full rate after combat activity */
+    UPROPERTY(Config, EditAnywhere, Category = "Significance", meta = (Units = "s"))
+    float CombatHoldTime = 3.0f;
+
+private:
+
+    /** Authored tick settings for one component, captured on registration */
+    struct FComponentTickState
+    {
+        TWeakObjectPtr<UActorComponent> Component;
+        float DefaultInterval = 0.0f;
+        bool bEnabledBeforeDormant = true;
+    };
+
+    /** Per-actor bookkeeping */
+    struct FSignificanceEntry
+    {
+        TWeakObjectPtr<AActor> Actor;
+
+        /** Lookup key, kept so stale actors can still be removed from the index */
+        TObjectKey<AActor> Key;
+
+        TArray<FComponentTickState, TInlineAllocator<8>> Components;
+        float DefaultActorInterval = 0.0f;
+        float LastCombatTime = -1000.0f;
+        float Significance = 1.0f;
+        ENexusTickBucket Bucket = ENexusTickBucket::Full;
+        bool bAllowDormant = true;
+        bool bActorEnabledBeforeDormant = true;
+    };
+
+    /** Scores an entry against the cached player locations */
+    float ScoreEntry(const FSignificanceEntry& Entry, float TimeSeconds) const;
+
+    /** Maps a score onto a bucket */
+    ENexusTickBucket BucketForScore(const FSignificanceEntry& Entry, float Score) const;
+
+    /** Applies a bucket change to the actor and its components */
+    void ApplyBucket(FSignificanceEntry& Entry, ENexusTickBucket NewBucket);
+
+    /** Caches the pawn or spectator location for every player controller */
+    void GatherPlayerLocations();
+
+    /** Removes the entry at the provided index */
+    void RemoveEntryAt(int32 Index);
+
+    /** Registered actors */
+    TArray<FSignificanceEntry> Entries;
+
+    /** Actor to entry index lookup */
+    TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+    /** Player view locations captured this frame */
+    TArray<FVector, TInlineAllocator<4>> PlayerLocations;
+
+    /** Round-robin cursor into Entries */
+    int32 NextEvaluationIndex = 0;
+
+    /** Smoothed frame time, used to turn the reduced frame interval into seconds */
+    float SmoothedDeltaTime = 1.0f / 60.0f;
+
+    /** True if the policy was enabled last frame, so we can restore everything when it gets disabled */
+    bool bWasEnabled = true;
+};
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NexusTargetSnapshotSubsystem.generated.h"
+
+/** Called when an agent picks a different target. The new target is null if no hostile is in range anymore */
+DECLARE_DELEGATE_OneParam(FOnNexusTargetChanged, APawn* /*NewTarget*/);
+
+/**
+ * Snapshot of an agent's target, as of the last frame end
+ */
+struct FNexusTargetInfo
+{
+    /** Nearest hostile target within range, or null if there was none at the last refresh */
+    TWeakObjectPtr<APawn> Target;
+
+    /** Target location */
+    FVector Location = FVector::ZeroVector;
+
+    /** Target velocity */
+    FVector Velocity = FVector::ZeroVector;
+
+    /** Squared distance from the agent to the target */
+    float DistanceSquared = 0.0f;
+
+    /** Distance from the agent to the target */
+    float Distance = 0.0f;
+};
+
+/**
+ * UNexusTargetSnapshotSubsystem - Shared target selection and per-frame target snapshot for AI
+ *
+ * Responsibility:
+ * - Capture the location and velocity of every target once per frame, and bucket them into a 2D spatial hash
+ * - Pick each agent's nearest hostile target within range from the spatial hash, on a staggered schedule
+ * - Compute the distance from every agent to its target in one batched SIMD pass
+ * - Let StateTree tasks, EQS contexts and other per-agent logic read the result with a lookup instead of querying the world
+ *
+ * Agents opt in by calling RegisterAgent from BeginPlay and UnregisterAgent from EndPlay.
+ * Targets register the same way with a team mask. Player pawns that never registered are picked up automatically
+ * and match every agent, so any player or bot can be targeted, not just the first local player.
+ * An agent is hostile to a target if the agent's hostile mask and the target's team mask share a bit.
+ * Only a fixed number of agents pick a new target each frame, so selection cost stays flat as agent and target counts grow.
+ * The snapshot is taken at the end of the frame, so readers see where everyone was when the last frame ended.
+ */
+UCLASS(Config = Game)
+class NEXUSTRIALS_API UNexusTargetSnapshotSubsystem : public UTickableWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+
+    /** Returns the subsystem for the world the provided object lives in, if any */
+    static UNexusTargetSnapshotSubsystem* Get(const UObject* WorldContextObject);
+
+    //================== Registration ==================
+
+    /**
+     * Start picking targets for an agent. Registering again updates the mask and range
+     * @param HostileMask Team bits the agent may target
+     * @param SearchRange Max distance to look for targets at. Zero uses DefaultSearchRange
+     */
+    void RegisterAgent(AActor* Agent, uint32 HostileMask = MAX_uint32, float SearchRange = 0.0f);
+
+    /** Stop picking targets for an agent */
+    void UnregisterAgent(AActor* Agent);
+
+    /** Calls the delegate whenever the agent picks a different target, so it doesn't have to poll GetTargetInfo for changes */
+    void BindTargetChanged(AActor* Agent, FOnNexusTargetChanged Delegate);
+
+    /** Makes a pawn targetable. Registering again updates its team mask */
+    void RegisterTarget(APawn* Target, uint32 TeamMask);
+
+    /** Stops a pawn from being targeted */
+    void UnregisterTarget(APawn* Target);
+
+    //================== Queries ==================
+
+    /**
+     * Looks up the agent's target as of the last snapshot
+     * @return false if the agent isn't registered or hasn't picked a target yet. OutInfo.Target is null if no hostile was in range
+     */
+    bool GetTargetInfo(const AActor* Agent, FNexusTargetInfo& OutInfo) const;
+
+    /**
+     * Finds the nearest hostile target to a location in the last snapshot, right away
+     * @param Ignore Actor to skip, usually the one asking
+     */
+    APawn* FindNearestTarget(const FVector& Location, uint32 HostileMask, float SearchRange, const AActor* Ignore = nullptr) const;
+
+    /** Returns the number of targets captured in the last snapshot */
+    int32 GetNumTargets() const { return Targets.Num(); }
+
+    /** Returns the number of registered agents */
+    int32 GetNumAgents() const { return Agents.Num(); }
+
+    //================== UTickableWorldSubsystem ==================
+
+    virtual void Tick(float DeltaTime) override;
+    virtual TStatId GetStatId() const override;
+
+protected:
+
+    virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+    //================== Tuning ==================
+
+    /** Max number of agents that pick a new target each frame. Newly registered agents and agents whose target went away always do */
+    UPROPERTY(Config, EditAnywhere, Category = "Targeting", meta = (ClampMin = 1))
+    int32 RefreshesPerFrame = 32;
+
+    /** Search range for agents that didn't provide one */
+    UPROPERTY(Config, EditAnywhere, Category = "Targeting", meta = (Units = "cm"))
+    float DefaultSearchRange = 20000.0f;
+
+    /** Size of the spatial hash cells */
+    UPROPERTY(Config, EditAnywhere, Category = "Targeting", meta = (ClampMin = 100, Units = "cm"))
+    float CellSize = 2000.0f;
+
+private:
+
+    /** A pawn registered as a target */
+    struct FRegisteredTarget
+    {
+        TWeakObjectPtr<APawn> Pawn;
+        TObjectKey<AActor> Key;
+        uint32 TeamMask = MAX_uint32;
+    };
+
+    /** A target captured this frame */
+    struct FTargetEntry
+    {
+        TWeakObjectPtr<APawn> Pawn;
+        FVector Location = FVector::ZeroVector;
+        FVector Velocity = FVector::ZeroVector;
+        uint32 TeamMask = MAX_uint32;
+    };
+
+    /** A registered agent */
+    struct FAgentEntry
+    {
+        TWeakObjectPtr<AActor> Actor;
+
+        /** Lookup key, kept so stale agents can still be removed from the index */
+        TObjectKey<AActor> Key;
+
+        uint32 HostileMask = MAX_uint32;
+        float SearchRange = 0.0f;
+
+        /** Target picked at the last refresh */
+        TObjectKey<AActor> TargetKey;
+
+        /** Index of the target in this frame's snapshot, or INDEX_NONE */
+        int32 TargetIndex = INDEX_NONE;
+
+        /** True once a target has been picked */
+        bool bHasPicked = false;
+
+        /** Called when the picked target changes */
+        FOnNexusTargetChanged OnTargetChanged;
+    };
+
+    /** Range of a spatial hash cell's targets in CellTargets */
+    struct FCellRange
+    {
+        int32 Start = 0;
+        int32 Num = 0;
+    };
+
+    /** Captures every target and rebuilds the spatial hash */
+    void GatherTargets();
+
+    /** Picks new targets for new agents, agents that lost theirs, and the next agents in the round-robin */
+    void RefreshAgents();
+
+    /** Copies agent and target locations into the SoA arrays, relative to the snapshot origin */
+    void GatherAgents();
+
+    /** Computes the distance to every agent's target, four agents at a time */
+    void ComputeDistances();
+
+    /** Finds the index of the nearest hostile target in this frame's snapshot */
+    int32 FindNearestTargetIndex(const FVector& Location, uint32 HostileMask, float SearchRange, const AActor* Ignore) const;
+
+    /** Removes the agent at the provided index, keeping the SoA arrays packed */
+    void RemoveAgentAt(int32 Index);
+
+    /** Returns the spatial hash cell for a location */
+    FIntPoint GetCell(const FVector& Location) const;
+
+    /** Registered agents */
+    TArray<FAgentEntry> Agents;
+
+    /** Agent to index lookup */
+    TMap<TObjectKey<AActor>, int32> AgentIndices;
+
+    /** Registered targets */
+    TArray<FRegisteredTarget> RegisteredTargets;
+
+    /** Targets captured this frame */
+    TArray<FTargetEntry> Targets;
+
+    /** Target to index lookup for this frame */
+    TMap<TObjectKey<AActor>, int32> TargetIndices;
+
+    /** Target indices bucketed by cell, back to back */
+    TArray<int32> CellTargets;
+
+    /** Where each occupied cell's targets live in CellTargets */
+    TMap<FIntPoint, FCellRange> Cells;
+
+    /** Bounds of the occupied cells, so searches don't walk empty space */
+    FIntPoint MinCell = FIntPoint::ZeroValue;
+    FIntPoint MaxCell = FIntPoint::ZeroValue;
+
+    /** Round-robin cursor into Agents */
+    int32 NextRefreshIndex = 0;
+
+    /** Snapshot origin. Locations are stored relative to it so they keep their precision as floats */
+    FVector Origin = FVector::ZeroVector;
+
+    /** Agent and target locations, one component per array and padded to a multiple of four */
+    TArray<float, TAlignedHeapAllocator<16>> AgentX;
+    TArray<float, TAlignedHeapAllocator<16>> AgentY;
+    TArray<float, TAlignedHeapAllocator<16>> AgentZ;
+    TArray<float, TAlignedHeapAllocator<16>> AgentTargetX;
+    TArray<float, TAlignedHeapAllocator<16>> AgentTargetY;
+    TArray<float, TAlignedHeapAllocator<16>> AgentTargetZ;
+
+    /** Per-agent results, padded like the locations */
+    TArray<float, TAlignedHeapAllocator<16>> TargetDistanceSquared;
+    TArray<float, TAlignedHeapAllocator<16>> TargetDistance;
+};
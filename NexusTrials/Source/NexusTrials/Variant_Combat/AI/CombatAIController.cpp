@@ -3,6 +3,7 @@
 
 #include "CombatAIController.h"
 #include "Components/StateTreeAIComponent.h"
+#include "Performance/NexusAILODSubsystem.h"
 
 ACombatAIController::ACombatAIController()
 {
@@ -17,3 +18,25 @@ ACombatAIController::ACombatAIController()
 	// this is necessary for EnvQueries to work correctly
 	bAttachToPawn = true;
 }
+
+void ACombatAIController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	// evaluate the StateTree less often while our pawn is distant or idle
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->RegisterController(this);
+	}
+}
+
+void ACombatAIController::OnUnPossess()
+{
+	// stop managing our StateTree
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->UnregisterController(this);
+	}
+
+	Super::OnUnPossess();
+}
@@ -0,0 +1,520 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatBenchmarkSubsystem.h"
+#include "CombatEnemy.h"
+#include "CoreGlobals.h"
+#include "EngineUtils.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/Pawn.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "UObject/UObjectGlobals.h"
+#include "NexusTrials.h"
+
+bool UCombatBenchmarkSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("CombatBenchmark"));
+}
+
+bool UCombatBenchmarkSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatBenchmarkSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// command line overrides for quick runs. Lists are comma separated, so don't stop reading at the first comma
+	FString CountsString;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmarkCounts="), CountsString, false))
+	{
+		TArray<FString> Counts;
+		CountsString.ParseIntoArray(Counts, TEXT(","));
+
+		EnemyCounts.Reset();
+
+		for (const FString& Count : Counts)
+		{
+			EnemyCounts.Add(FMath::Max(0, FCString::Atoi(*Count)));
+		}
+	}
+
+	FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmarkFrames="), MeasureFrames);
+	MeasureFrames = FMath::Max(1, MeasureFrames);
+
+	// wider spacing spreads the enemies across the level instead of packing them around the player
+	FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmarkSpacing="), SpawnSpacing);
+	SpawnSpacing = FMath::Max(50.0f, SpawnSpacing);
+
+	FString CVarsString;
+
+	if (FParse::Value(FCommandLine::Get(), TEXT("CombatBenchmarkCVars="), CVarsString, false))
+	{
+		TArray<FString> CVarAssignments;
+		CVarsString.ParseIntoArray(CVarAssignments, TEXT(","));
+
+		for (const FString& Assignment : CVarAssignments)
+		{
+			FString Name;
+			FString Value;
+
+			if (Assignment.Split(TEXT("="), &Name, &Value))
+			{
+				ConsoleVariables.Add(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+			}
+		}
+	}
+
+	// set the benchmark console variables, e.g. switch off the encounter director so it doesn't hold back spawns and attacks
+	for (const TPair<FString, FString>& ConsoleVariable : ConsoleVariables)
+	{
+		if (IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(*ConsoleVariable.Key))
+		{
+			SavedConsoleVariables.Add(ConsoleVariable.Key, CVar->GetString());
+			CVar->Set(*ConsoleVariable.Value, ECVF_SetByCode);
+
+		} else {
+
+			UE_LOG(LogNexusTrials, Warning, TEXT("Combat benchmark: unknown console variable %s"), *ConsoleVariable.Key);
+		}
+	}
+
+	RunName = FString::Printf(TEXT("CombatBenchmark_%s"), *FDateTime::Now().ToString(TEXT("%Y%m%d_%H%M%S")));
+
+	// time garbage collections ourselves so they show up even without the CSV profiler
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &UCombatBenchmarkSubsystem::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UCombatBenchmarkSubsystem::OnPostGarbageCollect);
+
+	UE_LOG(LogNexusTrials, Display, TEXT("Combat benchmark: %d enemy counts, %d measured frames each, %s"), EnemyCounts.Num(), MeasureFrames, *GetSettings());
+}
+
+void UCombatBenchmarkSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	// put the console variables back the way we found them
+	for (const TPair<FString, FString>& SavedConsoleVariable : SavedConsoleVariables)
+	{
+		if (IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(*SavedConsoleVariable.Key))
+		{
+			CVar->Set(*SavedConsoleVariable.Value, ECVF_SetByCode);
+		}
+	}
+
+	SavedConsoleVariables.Reset();
+
+	Super::Deinitialize();
+}
+
+TStatId UCombatBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	const double TickTime = FPlatformTime::Seconds();
+	const double FrameSeconds = LastTickTime > 0.0 ? TickTime - LastTickTime : 0.0;
+	LastTickTime = TickTime;
+
+	++PhaseFrames;
+
+	DriveBot(DeltaTime);
+
+	switch (Phase)
+	{
+	case EPhase::Startup:
+
+		if (PhaseFrames >= StartupFrames)
+		{
+			// center everything on the bot, or the world origin if there's no player
+			const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+			const APawn* Bot = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+			ArenaCenter = Bot ? Bot->GetActorLocation() : FVector::ZeroVector;
+
+			SetPhase(EnemyCounts.IsEmpty() ? EPhase::Done : EPhase::Spawn);
+
+			if (Phase == EPhase::Done)
+			{
+				Finish();
+			}
+		}
+
+		break;
+
+	case EPhase::Spawn:
+
+		SpawnEnemies(EnemyCounts[RunIndex]);
+		SetPhase(EPhase::Warmup);
+
+		break;
+
+	case EPhase::Warmup:
+
+		if (PhaseFrames >= WarmupFrames)
+		{
+			FrameTimes.Reset(MeasureFrames);
+			GameThreadTimes.Reset(MeasureFrames);
+			GCTimes.Reset(MeasureFrames);
+			FrameGCTime = 0.0;
+
+#if CSV_PROFILER
+			// capture the measured frames unless someone else is already capturing
+			if (!FCsvProfiler::Get()->IsCapturing())
+			{
+				FCsvProfiler::Get()->BeginCapture(-1, FPaths::ProfilingDir() / TEXT("CombatBenchmark"), FString::Printf(TEXT("%s_%d.csv"), *RunName, EnemyCounts[RunIndex]));
+				bCapturingCsv = true;
+			}
+#endif
+
+			SetPhase(EPhase::Measure);
+		}
+
+		break;
+
+	case EPhase::Measure:
+
+		RecordFrame(FrameSeconds);
+
+		if (FrameTimes.Num() >= MeasureFrames)
+		{
+#if CSV_PROFILER
+			if (bCapturingCsv)
+			{
+				CsvCaptureFuture = FCsvProfiler::Get()->EndCapture();
+				bCapturingCsv = false;
+			}
+#endif
+
+			SetPhase(EPhase::Collect);
+		}
+
+		break;
+
+	case EPhase::Collect:
+	{
+		// give the CSV writer a few seconds to flush the capture
+		if (CsvCaptureFuture.IsValid() && !CsvCaptureFuture.IsReady() && PhaseFrames < 300)
+		{
+			break;
+		}
+
+		const FString CsvCapturePath = CsvCaptureFuture.IsValid() && CsvCaptureFuture.IsReady() ? CsvCaptureFuture.Get() : FString();
+		CsvCaptureFuture = TSharedFuture<FString>();
+
+		SummarizeRun(CsvCapturePath);
+
+		// clean up before the next count so its garbage doesn't land in the next measurement
+		DestroyEnemies();
+		GEngine->ForceGarbageCollection(true);
+
+		++RunIndex;
+		SetPhase(EPhase::Cooldown);
+
+		break;
+	}
+
+	case EPhase::Cooldown:
+
+		if (PhaseFrames >= CooldownFrames)
+		{
+			if (EnemyCounts.IsValidIndex(RunIndex))
+			{
+				SetPhase(EPhase::Spawn);
+
+			} else {
+
+				SetPhase(EPhase::Done);
+				Finish();
+			}
+		}
+
+		break;
+
+	case EPhase::Done:
+
+		break;
+	}
+}
+
+void UCombatBenchmarkSubsystem::SetPhase(EPhase NewPhase)
+{
+	Phase = NewPhase;
+	PhaseFrames = 0;
+}
+
+void UCombatBenchmarkSubsystem::DriveBot(float DeltaTime)
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Bot = PlayerController ? PlayerController->GetPawn() : nullptr;
+
+	if (!Bot)
+	{
+		return;
+	}
+
+	// the bot has to survive the whole run so every count sees the same workload
+	Bot->SetCanBeDamaged(false);
+
+	// stay put until the arena is set up
+	if (Phase == EPhase::Startup || Phase == EPhase::Done)
+	{
+		return;
+	}
+
+	// run towards a point on the orbit, moving the point along once we get close
+	const FVector OrbitPoint = ArenaCenter + FVector(FMath::Cos(BotAngle), FMath::Sin(BotAngle), 0.0f) * BotOrbitRadius;
+
+	if (FVector::DistSquared2D(Bot->GetActorLocation(), OrbitPoint) < FMath::Square(150.0f))
+	{
+		BotAngle = FMath::Fmod(BotAngle + UE_PI / 12.0f, UE_TWO_PI);
+	}
+
+	Bot->AddMovementInput((OrbitPoint - Bot->GetActorLocation()).GetSafeNormal2D());
+}
+
+void UCombatBenchmarkSubsystem::SpawnEnemies(int32 NumEnemies)
+{
+	UClass* SpawnClass = EnemyClass.LoadSynchronous();
+
+	if (!SpawnClass)
+	{
+		UE_LOG(LogNexusTrials, Warning, TEXT("Combat benchmark: no enemy class configured, spawning the native ACombatEnemy"));
+		SpawnClass = ACombatEnemy::StaticClass();
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	SpawnedEnemies.Reserve(NumEnemies);
+
+	// fill rings from the inside out, keeping the same spacing on every ring
+	int32 NumSpawned = 0;
+	float RingRadius = SpawnRingRadius;
+
+	while (NumSpawned < NumEnemies)
+	{
+		const int32 NumOnRing = FMath::Max(1, FMath::FloorToInt32(UE_TWO_PI * RingRadius / SpawnSpacing));
+
+		for (int32 RingIndex = 0; RingIndex < NumOnRing && NumSpawned < NumEnemies; ++RingIndex, ++NumSpawned)
+		{
+			const float Angle = UE_TWO_PI * RingIndex / NumOnRing;
+			const FVector Location = ArenaCenter + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * RingRadius;
+			const FRotator Rotation = (ArenaCenter - Location).GetSafeNormal2D().Rotation();
+
+			if (ACombatEnemy* Enemy = GetWorld()->SpawnActor<ACombatEnemy>(SpawnClass, Location, Rotation, SpawnParams))
+			{
+				SpawnedEnemies.Add(Enemy);
+			}
+		}
+
+		RingRadius += SpawnSpacing;
+	}
+
+	UE_LOG(LogNexusTrials, Display, TEXT("Combat benchmark: spawned %d of %d enemies"), SpawnedEnemies.Num(), NumEnemies);
+}
+
+void UCombatBenchmarkSubsystem::DestroyEnemies()
+{
+	for (const TWeakObjectPtr<ACombatEnemy>& Enemy : SpawnedEnemies)
+	{
+		if (Enemy.IsValid())
+		{
+			Enemy->Destroy();
+		}
+	}
+
+	SpawnedEnemies.Reset();
+}
+
+void UCombatBenchmarkSubsystem::RecordFrame(double FrameSeconds)
+{
+	FrameTimes.Add(FrameSeconds * 1000.0);
+
+	// game thread time is published at the end of each frame, so this is the previous frame's
+	GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+	GCTimes.Add(FrameGCTime * 1000.0);
+	FrameGCTime = 0.0;
+}
+
+void UCombatBenchmarkSubsystem::SummarizeRun(const FString& CsvCapturePath)
+{
+	FRunSummary& Run = Runs.AddDefaulted_GetRef();
+	Run.NumRequested = EnemyCounts[RunIndex];
+	Run.Settings = GetSettings();
+
+	for (TActorIterator<ACombatEnemy> It(GetWorld()); It; ++It)
+	{
+		++Run.NumAlive;
+	}
+
+	Run.Metrics.Add(Summarize(TEXT("FrameMs"), FrameTimes));
+	Run.Metrics.Add(Summarize(TEXT("GameThreadMs"), GameThreadTimes));
+	Run.Metrics.Add(Summarize(TEXT("GCMs"), GCTimes));
+
+	if (!CsvCapturePath.IsEmpty())
+	{
+		ReadCsvCapture(CsvCapturePath, Run);
+	}
+
+	const FMetricSummary& FrameSummary = Run.Metrics[0];
+	UE_LOG(LogNexusTrials, Display, TEXT("Combat benchmark: %d enemies (%d alive), frame avg %.2fms p99 %.2fms"), Run.NumRequested, Run.NumAlive, FrameSummary.Average, FrameSummary.P99);
+}
+
+FString UCombatBenchmarkSubsystem::GetSettings() const
+{
+	// space separated so the whole set fits in one CSV field
+	TArray<FString> Settings;
+
+	for (const FString& Name : RecordedConsoleVariables)
+	{
+		const IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(*Name);
+		Settings.Add(FString::Printf(TEXT("%s=%s"), *Name, CVar ? *CVar->GetString() : TEXT("missing")));
+	}
+
+	return FString::Join(Settings, TEXT(" "));
+}
+
+void UCombatBenchmarkSubsystem::ReadCsvCapture(const FString& CsvCapturePath, FRunSummary& Run) const
+{
+	TArray<FString> Lines;
+
+	if (!FFileHelper::LoadFileToStringArray(Lines, *CsvCapturePath) || Lines.IsEmpty())
+	{
+		UE_LOG(LogNexusTrials, Warning, TEXT("Combat benchmark: couldn't read the CSV capture %s"), *CsvCapturePath);
+		return;
+	}
+
+	// find the columns we care about in the header row
+	TArray<FString> Header;
+	Lines[0].ParseIntoArray(Header, TEXT(","), false);
+
+	TArray<FString> Names;
+	TArray<int32> ColumnIndices;
+	TArray<TArray<double>> Samples;
+
+	for (const TPair<FString, FString>& SystemColumn : SystemColumns)
+	{
+		Names.Add(SystemColumn.Key);
+		ColumnIndices.Add(Header.IndexOfByKey(SystemColumn.Value));
+		Samples.AddDefaulted();
+	}
+
+	// the capture ends with a repeat of the header and a metadata row, which aren't numeric and get skipped
+	TArray<FString> Fields;
+
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		Lines[LineIndex].ParseIntoArray(Fields, TEXT(","), false);
+
+		for (int32 SystemIndex = 0; SystemIndex < ColumnIndices.Num(); ++SystemIndex)
+		{
+			const int32 ColumnIndex = ColumnIndices[SystemIndex];
+
+			if (Fields.IsValidIndex(ColumnIndex) && Fields[ColumnIndex].IsNumeric())
+			{
+				Samples[SystemIndex].Add(FCString::Atod(*Fields[ColumnIndex]));
+			}
+		}
+	}
+
+	for (int32 SystemIndex = 0; SystemIndex < Names.Num(); ++SystemIndex)
+	{
+		if (ColumnIndices[SystemIndex] == INDEX_NONE)
+		{
+			UE_LOG(LogNexusTrials, Warning, TEXT("Combat benchmark: column %s isn't in the CSV capture"), *SystemColumns[Names[SystemIndex]]);
+		}
+
+		Run.Metrics.Add(Summarize(Names[SystemIndex], Samples[SystemIndex]));
+	}
+}
+
+void UCombatBenchmarkSubsystem::Finish()
+{
+	// one row per count and metric, so runs from different commits can be lined up
+	FString Summary = TEXT("Build,Map,Settings,Enemies,AliveEnemies,Metric,Samples,AvgMs,P50Ms,P90Ms,P95Ms,P99Ms,MaxMs\n");
+
+	for (const FRunSummary& Run : Runs)
+	{
+		for (const FMetricSummary& Metric : Run.Metrics)
+		{
+			Summary += FString::Printf(TEXT("%s,%s,%s,%d,%d,%s,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n"),
+				FApp::GetBuildVersion(), *GetWorld()->GetMapName(), *Run.Settings, Run.NumRequested, Run.NumAlive, *Metric.Name, Metric.NumSamples,
+				Metric.Average, Metric.P50, Metric.P90, Metric.P95, Metric.P99, Metric.Max);
+		}
+	}
+
+	const FString SummaryPath = FPaths::ProfilingDir() / TEXT("CombatBenchmark") / (RunName + TEXT(".csv"));
+
+	if (FFileHelper::SaveStringToFile(Summary, *SummaryPath))
+	{
+		UE_LOG(LogNexusTrials, Display, TEXT("Combat benchmark: wrote %s"), *SummaryPath);
+
+	} else {
+
+		UE_LOG(LogNexusTrials, Error, TEXT("Combat benchmark: couldn't write %s"), *SummaryPath);
+	}
+
+	FPlatformMisc::RequestExit(false, TEXT("CombatBenchmark"));
+}
+
+UCombatBenchmarkSubsystem::FMetricSummary UCombatBenchmarkSubsystem::Summarize(const FString& Name, TArray<double>& Samples)
+{
+	FMetricSummary Summary;
+	Summary.Name = Name;
+	Summary.NumSamples = Samples.Num();
+
+	if (Samples.IsEmpty())
+	{
+		return Summary;
+	}
+
+	Samples.Sort();
+
+	double Total = 0.0;
+
+	for (const double Sample : Samples)
+	{
+		Total += Sample;
+	}
+
+	// nearest rank percentiles
+	const auto Percentile = [&Samples](double Fraction)
+	{
+		const int32 Rank = FMath::CeilToInt32(Fraction * Samples.Num()) - 1;
+		return Samples[FMath::Clamp(Rank, 0, Samples.Num() - 1)];
+	};
+
+	Summary.Average = Total / Samples.Num();
+	Summary.P50 = Percentile(0.5);
+	Summary.P90 = Percentile(0.9);
+	Summary.P95 = Percentile(0.95);
+	Summary.P99 = Percentile(0.99);
+	Summary.Max = Samples.Last();
+
+	return Summary;
+}
+
+void UCombatBenchmarkSubsystem::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void UCombatBenchmarkSubsystem::OnPostGarbageCollect()
+{
+	FrameGCTime += FPlatformTime::Seconds() - GCStartTime;
+}
@@ -0,0 +1,241 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/Future.h"
+#include "CombatBenchmarkSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/**
+ *  Headless AI scaling benchmark for the combat variant.
+ *  Only created when the game is launched with -CombatBenchmark, e.g.:
+ *
+ *    NexusTrials /Game/Variant_Combat/Lvl_Combat -game -nullrhi -unattended -benchmark -fps=30 -CombatBenchmark
+ *
+ *  For every enemy count it spawns that many enemies in rings around a scripted bot player that keeps circling,
+ *  lets them settle, then measures a fixed number of frames.
+ *  Frame, game thread and garbage collection times are measured directly. Per-system times (StateTree, movement,
+ *  animation, melee traces) are read back from a CSV profiler capture of the same frames, when the CSV profiler is compiled in.
+ *  Percentiles for every count are written to a summary CSV under Saved/Profiling/CombatBenchmark, then the game exits.
+ *  The encounter director is switched off for the run so every spawned enemy is alive and free to attack, and every summary row
+ *  records the state of the LOD console variables so runs with different policies can be told apart.
+ *  Optional overrides: -CombatBenchmarkCounts=10,50,100 -CombatBenchmarkFrames=600 -CombatBenchmarkSpacing=1000
+ *  -CombatBenchmarkCVars=Nexus.AILOD.Enable=0,Nexus.AnimBudget.Enable=0
+ */
+UCLASS(Config=Game)
+class UCombatBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Only create the benchmark when it was asked for on the command line */
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	/** Only create the benchmark for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Reads the command line overrides, sets the benchmark console variables and starts listening for garbage collections */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Restores the console variables and stops listening for garbage collections */
+	virtual void Deinitialize() override;
+
+	/** Enemy class to spawn */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark")
+	TSoftClassPtr<ACombatEnemy> EnemyClass;
+
+	/** Enemy counts to measure, in order */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark")
+	TArray<int32> EnemyCounts = { 10, 50, 100, 250, 500, 1000 };
+
+	/** Frames to wait after the map loads before the first run */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 0))
+	int32 StartupFrames = 60;
+
+	/** Frames to let the enemies settle after spawning, before measuring */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 0))
+	int32 WarmupFrames = 120;
+
+	/** Frames measured for every enemy count */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 1))
+	int32 MeasureFrames = 600;
+
+	/** Frames to wait after removing the enemies before the next run */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 0))
+	int32 CooldownFrames = 30;
+
+	/** Radius of the innermost spawn ring around the bot's orbit center */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 0, Units = "cm"))
+	float SpawnRingRadius = 1500.0f;
+
+	/** Spacing between enemies on a ring, and between rings */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 50, Units = "cm"))
+	float SpawnSpacing = 150.0f;
+
+	/** Radius of the circle the bot player runs around */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark", meta = (ClampMin = 0, Units = "cm"))
+	float BotOrbitRadius = 600.0f;
+
+	/** Console variables set for the whole benchmark, by name. Values from -CombatBenchmarkCVars are added on top */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark")
+	TMap<FString, FString> ConsoleVariables =
+	{
+		{ TEXT("Combat.Director.Enable"), TEXT("0") }
+	};
+
+	/** Console variables whose values are recorded in every summary row */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark")
+	TArray<FString> RecordedConsoleVariables =
+	{
+		TEXT("Combat.Director.Enable"),
+		TEXT("Nexus.Significance.Enable"),
+		TEXT("Nexus.AILOD.Enable"),
+		TEXT("Nexus.AnimBudget.Enable"),
+		TEXT("Nexus.MovementLOD.Enable")
+	};
+
+	/** Per-system times to read from the CSV profiler capture, by summary name and CSV column. Missing columns are reported with no samples */
+	UPROPERTY(Config, EditAnywhere, Category="Benchmark")
+	TMap<FString, FString> SystemColumns =
+	{
+		{ TEXT("StateTreeMs"), TEXT("Exclusive/GameThread/StateTree") },
+		{ TEXT("CharacterMovementMs"), TEXT("Exclusive/GameThread/CharacterMovement") },
+		{ TEXT("AnimationMs"), TEXT("Exclusive/GameThread/Animation") },
+		{ TEXT("MeleeTraceMs"), TEXT("NexusTrials/MeleeSweep") }
+	};
+
+	/** Benchmark steps */
+	enum class EPhase : uint8
+	{
+		Startup,
+		Spawn,
+		Warmup,
+		Measure,
+		Collect,
+		Cooldown,
+		Done
+	};
+
+	/** Percentiles of one metric over the measured frames */
+	struct FMetricSummary
+	{
+		FString Name;
+		int32 NumSamples = 0;
+		double Average = 0.0;
+		double P50 = 0.0;
+		double P90 = 0.0;
+		double P95 = 0.0;
+		double P99 = 0.0;
+		double Max = 0.0;
+	};
+
+	/** Results for one enemy count */
+	struct FRunSummary
+	{
+		/** Enemies we spawned */
+		int32 NumRequested = 0;
+
+		/** Enemies alive in the world while measuring, including any the level spawned on its own */
+		int32 NumAlive = 0;
+
+		/** Recorded console variable values, e.g. "Nexus.AILOD.Enable=1 Nexus.AnimBudget.Enable=0" */
+		FString Settings;
+
+		TArray<FMetricSummary> Metrics;
+	};
+
+	/** Moves on to the provided phase */
+	void SetPhase(EPhase NewPhase);
+
+	/** Keeps the bot player circling and unkillable */
+	void DriveBot(float DeltaTime);
+
+	/** Spawns the enemies for the current run */
+	void SpawnEnemies(int32 NumEnemies);
+
+	/** Destroys the enemies we spawned */
+	void DestroyEnemies();
+
+	/** Records the frame, game thread and garbage collection time for this frame */
+	void RecordFrame(double FrameSeconds);
+
+	/** Summarizes the run, including the per-system columns of the CSV capture if there is one */
+	void SummarizeRun(const FString& CsvCapturePath);
+
+	/** Reads the configured per-system columns out of a CSV profiler capture */
+	void ReadCsvCapture(const FString& CsvCapturePath, FRunSummary& Run) const;
+
+	/** Returns the current values of the recorded console variables */
+	FString GetSettings() const;
+
+	/** Writes every run's summary and exits */
+	void Finish();
+
+	/** Returns percentiles for a set of samples */
+	static FMetricSummary Summarize(const FString& Name, TArray<double>& Samples);
+
+	/** Garbage collection timing */
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	/** Current step */
+	EPhase Phase = EPhase::Startup;
+
+	/** Frames spent in the current phase */
+	int32 PhaseFrames = 0;
+
+	/** Index of the current run in EnemyCounts */
+	int32 RunIndex = 0;
+
+	/** Center of the bot's orbit and the spawn rings */
+	FVector ArenaCenter = FVector::ZeroVector;
+
+	/** Angle of the bot on its orbit */
+	float BotAngle = 0.0f;
+
+	/** Enemies spawned for the current run */
+	TArray<TWeakObjectPtr<ACombatEnemy>> SpawnedEnemies;
+
+	/** Per-frame samples for the current run */
+	TArray<double> FrameTimes;
+	TArray<double> GameThreadTimes;
+	TArray<double> GCTimes;
+
+	/** Wall clock time of the last tick */
+	double LastTickTime = 0.0;
+
+	/** Time the current garbage collection started */
+	double GCStartTime = 0.0;
+
+	/** Garbage collection time accumulated this frame */
+	double FrameGCTime = 0.0;
+
+	/** Name of the summary file, shared by the CSV captures */
+	FString RunName;
+
+	/** Filename of the CSV capture for the current run, once it's been written */
+	TSharedFuture<FString> CsvCaptureFuture;
+
+	/** True while we own a running CSV capture */
+	bool bCapturingCsv = false;
+
+	/** Values the benchmark console variables had before we set them, restored when we're done */
+	TMap<FString, FString> SavedConsoleVariables;
+
+	/** Finished runs */
+	TArray<FRunSummary> Runs;
+
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
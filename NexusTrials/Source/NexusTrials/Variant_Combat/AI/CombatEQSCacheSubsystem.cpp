@@ -0,0 +1,215 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatEQSCacheSubsystem.h"
+#include "CombatCachedEnvQueryContext.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "EnvironmentQuery/EnvQueryContext.h"
+#include "EnvironmentQuery/EnvQueryManager.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NexusTrials.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("EQS Cache Hits"), STAT_CombatEQSCacheHits, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("EQS Cache Joins"), STAT_CombatEQSCacheJoins, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("EQS Cache Queries Run"), STAT_CombatEQSCacheQueries, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EQS Cache Entries"), STAT_CombatEQSCacheEntries, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarEQSCacheEnabled(
+	TEXT("Combat.EQSCache.Enable"),
+	true,
+	TEXT("If true, nearby enemies asking the same EQS question share one query and its result. If false, every request runs its own query."));
+
+UCombatEQSCacheSubsystem* UCombatEQSCacheSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatEQSCacheSubsystem>() : nullptr;
+}
+
+bool UCombatEQSCacheSubsystem::IsCacheEnabled()
+{
+	return CVarEQSCacheEnabled.GetValueOnGameThread();
+}
+
+bool UCombatEQSCacheSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FCombatEQSCacheKey UCombatEQSCacheSubsystem::MakeKey(const UEnvQuery* Template, EEnvQueryRunMode::Type RunMode, const AActor* Querier, TSubclassOf<UEnvQueryContext> KeyContext) const
+{
+	FCombatEQSCacheKey Key;
+	Key.Template = Template;
+	Key.RunMode = static_cast<uint8>(RunMode);
+
+	if (!Querier)
+	{
+		return Key;
+	}
+
+	// give every querier its own query when we're not sharing
+	if (!IsCacheEnabled())
+	{
+		Key.Querier = FObjectKey(Querier);
+		return Key;
+	}
+
+	const FVector QuerierLocation = Querier->GetActorLocation();
+	Key.QuerierCell = FIntVector(FMath::FloorToInt32(QuerierLocation.X / QuerierCellSize), FMath::FloorToInt32(QuerierLocation.Y / QuerierCellSize), FMath::FloorToInt32(QuerierLocation.Z / QuerierCellSize));
+
+	// contexts that can report their location without running the query narrow the key down further
+	const ICombatCachedEnvQueryContext* CachedContext = KeyContext ? Cast<ICombatCachedEnvQueryContext>(KeyContext->GetDefaultObject()) : nullptr;
+	FVector ContextLocation;
+
+	if (CachedContext && CachedContext->GetContextLocation(Querier, ContextLocation))
+	{
+		Key.ContextCell = FIntVector(FMath::FloorToInt32(ContextLocation.X / ContextCellSize), FMath::FloorToInt32(ContextLocation.Y / ContextCellSize), FMath::FloorToInt32(ContextLocation.Z / ContextCellSize));
+	}
+
+	return Key;
+}
+
+ECombatEQSCacheStatus UCombatEQSCacheSubsystem::RequestQuery(const FCombatEQSCacheKey& Key, UEnvQuery* Template, EEnvQueryRunMode::Type RunMode, AActor* Querier, FCombatEQSResult& OutResult)
+{
+	const double TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	PruneExpired(TimeSeconds);
+
+	if (FCacheEntry* Entry = Entries.Find(Key))
+	{
+		// a finished query hands out its result while it's fresh
+		if (Entry->QueryId == INDEX_NONE)
+		{
+			if (TimeSeconds - Entry->Time <= TimeToLive)
+			{
+				OutResult = Entry->Result;
+				INC_DWORD_STAT(STAT_CombatEQSCacheHits);
+
+				// unshared results belong to a single querier, so they're only handed out once
+				if (!Key.Querier.IsNull())
+				{
+					Entries.Remove(Key);
+				}
+
+				return ECombatEQSCacheStatus::Ready;
+			}
+
+		// join the running query unless it looks lost
+		} else if (TimeSeconds - Entry->Time <= PendingTimeout) {
+
+			INC_DWORD_STAT(STAT_CombatEQSCacheJoins);
+			return ECombatEQSCacheStatus::Pending;
+
+		} else {
+
+			if (UEnvQueryManager* QueryManager = UEnvQueryManager::GetCurrent(this))
+			{
+				QueryManager->AbortQuery(Entry->QueryId);
+			}
+
+			RunningQueries.Remove(Entry->QueryId);
+		}
+	}
+
+	// report an empty result for queries that can't run, so the requester doesn't wait forever
+	if (!Template || !IsValid(Querier))
+	{
+		Entries.Remove(Key);
+		OutResult = FCombatEQSResult();
+		return ECombatEQSCacheStatus::Ready;
+	}
+
+	INC_DWORD_STAT(STAT_CombatEQSCacheQueries);
+
+	FEnvQueryRequest QueryRequest(Template, Querier);
+	const int32 QueryId = QueryRequest.Execute(RunMode, FQueryFinishedSignature::CreateUObject(this, &UCombatEQSCacheSubsystem::OnQueryFinished));
+
+	// the query couldn't start, so report an empty result
+	if (QueryId == INDEX_NONE)
+	{
+		Entries.Remove(Key);
+		OutResult = FCombatEQSResult();
+		return ECombatEQSCacheStatus::Ready;
+	}
+
+	// nothing usable, so the query runs on behalf of everyone with this key
+	FCacheEntry& Entry = Entries.FindOrAdd(Key);
+	Entry.Result = FCombatEQSResult();
+	Entry.Time = TimeSeconds;
+	Entry.QueryId = QueryId;
+
+	RunningQueries.Add(QueryId, Key);
+
+	SET_DWORD_STAT(STAT_CombatEQSCacheEntries, Entries.Num());
+
+	return ECombatEQSCacheStatus::Pending;
+}
+
+void UCombatEQSCacheSubsystem::OnQueryFinished(TSharedPtr<FEnvQueryResult> Result)
+{
+	if (!Result.IsValid())
+	{
+		return;
+	}
+
+	FCombatEQSCacheKey Key;
+
+	// ignore queries we've already given up on
+	if (!RunningQueries.RemoveAndCopyValue(Result->QueryID, Key))
+	{
+		return;
+	}
+
+	FCacheEntry* Entry = Entries.Find(Key);
+
+	if (!Entry || Entry->QueryId != Result->QueryID)
+	{
+		return;
+	}
+
+	// copy out the scored items, best first
+	Entry->QueryId = INDEX_NONE;
+	Entry->Time = GetWorld()->GetTimeSeconds();
+	Entry->Result.bSuccess = Result->IsSuccessful() && Result->Items.Num() > 0;
+
+	if (Entry->Result.bSuccess)
+	{
+		const int32 NumItems = Result->Items.Num();
+		Entry->Result.Locations.Reserve(NumItems);
+		Entry->Result.Actors.Reserve(NumItems);
+
+		for (int32 ItemIndex = 0; ItemIndex < NumItems; ++ItemIndex)
+		{
+			Entry->Result.Locations.Add(Result->GetItemAsLocation(ItemIndex));
+			Entry->Result.Actors.Add(Result->GetItemAsActor(ItemIndex));
+		}
+	}
+}
+
+void UCombatEQSCacheSubsystem::PruneExpired(double TimeSeconds)
+{
+	if (LastPruneFrame == GFrameCounter)
+	{
+		return;
+	}
+
+	LastPruneFrame = GFrameCounter;
+
+	// running queries are kept until they finish or time out
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Value().QueryId == INDEX_NONE && TimeSeconds - It.Value().Time > TimeToLive)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CombatEQSCacheEntries, Entries.Num());
+}
+
+void UCombatEQSCacheSubsystem::Flush()
+{
+	// let running queries finish without anyone to hand their results to
+	Entries.Reset();
+	RunningQueries.Reset();
+}
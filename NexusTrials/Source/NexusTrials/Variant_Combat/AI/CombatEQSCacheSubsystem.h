@@ -0,0 +1,154 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "CombatEQSCacheSubsystem.generated.h"
+
+class UEnvQuery;
+class UEnvQueryContext;
+
+/**
+ *  Identifies queries that can share a result: same template and run mode, asked from the same area about the same context location
+ */
+struct FCombatEQSCacheKey
+{
+	/** Query template */
+	TObjectKey<UEnvQuery> Template;
+
+	/** Quantized querier location */
+	FIntVector QuerierCell = FIntVector::ZeroValue;
+
+	/** Quantized context location */
+	FIntVector ContextCell = FIntVector::ZeroValue;
+
+	/** How the query picks its items */
+	uint8 RunMode = 0;
+
+	/** Querier, only set while sharing is disabled so every querier gets its own query */
+	FObjectKey Querier;
+
+	bool operator==(const FCombatEQSCacheKey& Other) const
+	{
+		return Template == Other.Template && QuerierCell == Other.QuerierCell && ContextCell == Other.ContextCell && RunMode == Other.RunMode && Querier == Other.Querier;
+	}
+
+	friend uint32 GetTypeHash(const FCombatEQSCacheKey& Key)
+	{
+		return HashCombine(HashCombine(GetTypeHash(Key.Template), GetTypeHash(Key.QuerierCell)), HashCombine(HashCombine(GetTypeHash(Key.ContextCell), Key.RunMode), GetTypeHash(Key.Querier)));
+	}
+};
+
+/**
+ *  A finished query's scored items, best first
+ */
+struct FCombatEQSResult
+{
+	/** Item locations */
+	TArray<FVector> Locations;
+
+	/** Item actors, if the query returns actors */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	/** True if the query found anything */
+	bool bSuccess = false;
+};
+
+/**
+ *  Status of a cached query request
+ */
+enum class ECombatEQSCacheStatus : uint8
+{
+	/** A fresh result was copied out */
+	Ready,
+
+	/** The query is still running. Ask again later */
+	Pending
+};
+
+/**
+ *  Shared EQS result cache.
+ *  Queries are keyed by template, run mode, quantized querier cell and quantized context location.
+ *  A fresh result is handed to everyone asking with the same key, and requests for a key that's already running
+ *  join that query instead of starting their own, so a pack reacting to the same event only runs a handful of queries.
+ *  Requests are polled, so requesters that go away don't need to cancel anything.
+ */
+UCLASS(Config=Game)
+class UCombatEQSCacheSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the cache for the world the provided object lives in, if any */
+	static UCombatEQSCacheSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Returns true if results are shared. If false, every request runs its own query */
+	static bool IsCacheEnabled();
+
+	/**
+	 *  Builds the cache key for a query
+	 *  @param KeyContext Context whose location is part of the key. It should implement ICombatCachedEnvQueryContext, otherwise only the querier cell is used
+	 */
+	FCombatEQSCacheKey MakeKey(const UEnvQuery* Template, EEnvQueryRunMode::Type RunMode, const AActor* Querier, TSubclassOf<UEnvQueryContext> KeyContext) const;
+
+	/**
+	 *  Copies out a fresh result for the key, or joins or starts the query and returns Pending.
+	 *  Call again with the same key until the result is ready
+	 */
+	ECombatEQSCacheStatus RequestQuery(const FCombatEQSCacheKey& Key, UEnvQuery* Template, EEnvQueryRunMode::Type RunMode, AActor* Querier, FCombatEQSResult& OutResult);
+
+	/** Drops every cached result */
+	void Flush();
+
+protected:
+
+	/** Only create the cache for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Called by the EQS manager when a query we started finishes */
+	void OnQueryFinished(TSharedPtr<FEnvQueryResult> Result);
+
+	/** Removes expired results, at most once per frame */
+	void PruneExpired(double TimeSeconds);
+
+	/** Results stay fresh for this long after their query finished */
+	UPROPERTY(Config, EditAnywhere, Category="EQS Cache", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
+	float TimeToLive = 0.5f;
+
+	/** Queriers within the same cell of this size share results */
+	UPROPERTY(Config, EditAnywhere, Category="EQS Cache", meta = (ClampMin = 50, Units = "cm"))
+	float QuerierCellSize = 400.0f;
+
+	/** Context locations within the same cell of this size share results */
+	UPROPERTY(Config, EditAnywhere, Category="EQS Cache", meta = (ClampMin = 50, Units = "cm"))
+	float ContextCellSize = 200.0f;
+
+	/** Queries that haven't finished after this long are assumed lost and started again */
+	UPROPERTY(Config, EditAnywhere, Category="EQS Cache", meta = (ClampMin = 0.5, ClampMax = 30, Units = "s"))
+	float PendingTimeout = 5.0f;
+
+	/** A cached query */
+	struct FCacheEntry
+	{
+		/** Scored items, once the query finishes */
+		FCombatEQSResult Result;
+
+		/** Game time the query started, or finished if it's done */
+		double Time = 0.0;
+
+		/** EQS query id while the query runs, INDEX_NONE once it's done */
+		int32 QueryId = INDEX_NONE;
+	};
+
+	/** Cached queries */
+	TMap<FCombatEQSCacheKey, FCacheEntry> Entries;
+
+	/** Running query id to cache key lookup */
+	TMap<int32, FCombatEQSCacheKey> RunningQueries;
+
+	/** Last frame expired results were pruned on */
+	uint64 LastPruneFrame = 0;
+};
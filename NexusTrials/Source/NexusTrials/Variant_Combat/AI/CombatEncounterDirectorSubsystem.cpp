@@ -0,0 +1,142 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatEncounterDirectorSubsystem.h"
+#include "CombatEnemy.h"
+#include "CombatRagdollSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Encounter Director"), STAT_CombatEncounterDirector, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Alive Enemies"), STAT_CombatAliveEnemies, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Alive Enemy Limit"), STAT_CombatAliveEnemyLimit, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attackers"), STAT_CombatAttackers, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attacker Limit"), STAT_CombatAttackerLimit, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Director Pressure %"), STAT_CombatDirectorPressure, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarEncounterDirectorEnabled(
+	TEXT("Combat.Director.Enable"),
+	true,
+	TEXT("If true, the encounter director limits how many enemies are alive and attacking based on load. If false, spawns and attacks are never held back."));
+
+UCombatEncounterDirectorSubsystem* UCombatEncounterDirectorSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatEncounterDirectorSubsystem>() : nullptr;
+}
+
+bool UCombatEncounterDirectorSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatEncounterDirectorSubsystem::RegisterEnemy(ACombatEnemy* Enemy)
+{
+	if (Enemy)
+	{
+		AliveEnemies.AddUnique(Enemy);
+	}
+}
+
+void UCombatEncounterDirectorSubsystem::UnregisterEnemy(ACombatEnemy* Enemy)
+{
+	AliveEnemies.RemoveSingleSwap(Enemy, EAllowShrinking::No);
+	Attackers.RemoveSingleSwap(Enemy, EAllowShrinking::No);
+}
+
+int32 UCombatEncounterDirectorSubsystem::GetMaxAliveEnemies() const
+{
+	return FMath::RoundToInt32(FMath::Lerp(static_cast<float>(MaxAliveEnemies), static_cast<float>(FMath::Min(MinAliveEnemies, MaxAliveEnemies)), Pressure));
+}
+
+int32 UCombatEncounterDirectorSubsystem::GetMaxAttackers() const
+{
+	return FMath::RoundToInt32(FMath::Lerp(static_cast<float>(MaxAttackers), static_cast<float>(FMath::Min(MinAttackers, MaxAttackers)), Pressure));
+}
+
+bool UCombatEncounterDirectorSubsystem::HasSpawnHeadroom() const
+{
+	if (!CVarEncounterDirectorEnabled.GetValueOnGameThread())
+	{
+		return true;
+	}
+
+	return AliveEnemies.Num() < GetMaxAliveEnemies();
+}
+
+bool UCombatEncounterDirectorSubsystem::RequestAttackToken(ACombatEnemy* Enemy)
+{
+	if (!CVarEncounterDirectorEnabled.GetValueOnGameThread())
+	{
+		return true;
+	}
+
+	if (Attackers.Contains(Enemy))
+	{
+		return true;
+	}
+
+	if (Attackers.Num() >= GetMaxAttackers())
+	{
+		return false;
+	}
+
+	Attackers.Add(Enemy);
+	return true;
+}
+
+void UCombatEncounterDirectorSubsystem::ReleaseAttackToken(ACombatEnemy* Enemy)
+{
+	Attackers.RemoveSingleSwap(Enemy, EAllowShrinking::No);
+}
+
+TStatId UCombatEncounterDirectorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatEncounterDirectorSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatEncounterDirectorSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatEncounterDirector);
+
+	// drop enemies that went away without unregistering
+	AliveEnemies.RemoveAllSwap([](const TWeakObjectPtr<ACombatEnemy>& Enemy) { return !Enemy.IsValid(); }, EAllowShrinking::No);
+	Attackers.RemoveAllSwap([](const TWeakObjectPtr<ACombatEnemy>& Enemy) { return !Enemy.IsValid(); }, EAllowShrinking::No);
+
+	// measure the time the game thread actually worked last frame, leaving out any wait for a frame rate cap
+	const float FrameMs = static_cast<float>(FMath::Max(FApp::GetDeltaTime() - FApp::GetIdleTime(), 0.0) * 1000.0);
+
+	// smooth out spikes so the limits don't flicker from frame to frame
+	const float Alpha = FMath::Clamp(DeltaTime * SmoothingSpeed, 0.0f, 1.0f);
+	SmoothedFrameMs = FMath::Lerp(SmoothedFrameMs, FrameMs, Alpha);
+	SmoothedTraces = FMath::Lerp(SmoothedTraces, static_cast<float>(TracesThisFrame), Alpha);
+	TracesThisFrame = 0;
+
+	// frame time pressure ramps up between the target and max frame times
+	const float FramePressure = FMath::GetRangePct(TargetFrameMs, FMath::Max(MaxFrameMs, TargetFrameMs + 1.0f), SmoothedFrameMs);
+
+	// trace pressure ramps up towards the trace budget
+	const float TracePressure = SmoothedTraces / MaxTracesPerFrame;
+
+	// ragdoll pressure ramps up once more than half the ragdoll budget is simulating
+	float RagdollPressure = 0.0f;
+
+	if (const UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+	{
+		if (RagdollBudget->GetMaxActiveRagdolls() > 0)
+		{
+			RagdollPressure = FMath::GetRangePct(0.5f, 1.0f, static_cast<float>(RagdollBudget->GetNumActiveRagdolls()) / RagdollBudget->GetMaxActiveRagdolls());
+		}
+	}
+
+	// the tightest resource sets the limits
+	Pressure = FMath::Clamp(FMath::Max3(FramePressure, TracePressure, RagdollPressure), 0.0f, 1.0f);
+
+	SET_DWORD_STAT(STAT_CombatAliveEnemies, AliveEnemies.Num());
+	SET_DWORD_STAT(STAT_CombatAliveEnemyLimit, GetMaxAliveEnemies());
+	SET_DWORD_STAT(STAT_CombatAttackers, Attackers.Num());
+	SET_DWORD_STAT(STAT_CombatAttackerLimit, GetMaxAttackers());
+	SET_DWORD_STAT(STAT_CombatDirectorPressure, FMath::RoundToInt32(Pressure * 100.0f));
+}
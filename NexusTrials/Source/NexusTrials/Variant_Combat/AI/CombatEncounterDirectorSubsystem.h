@@ -0,0 +1,124 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatEncounterDirectorSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/**
+ *  Keeps combat encounters within what the machine can currently afford.
+ *  Tracks game thread frame time, live enemies, simulating ragdolls and melee traces,
+ *  and turns them into a load pressure that scales down how many enemies may be alive and attacking at once.
+ *  Spawns held back by the alive limit stay queued in the spawn scheduler until there's headroom again,
+ *  and enemies must hold an attack token to start an attack.
+ *  Limits can be tuned per machine through the Game config, e.g. lower ones for dedicated server instances.
+ */
+UCLASS(Config=Game)
+class UCombatEncounterDirectorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the encounter director for the world the provided object lives in, if any */
+	static UCombatEncounterDirectorSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Starts counting a live enemy against the alive limit */
+	void RegisterEnemy(ACombatEnemy* Enemy);
+
+	/** Stops counting an enemy, e.g. when it dies, and takes back its attack token */
+	void UnregisterEnemy(ACombatEnemy* Enemy);
+
+	/** Returns true if another enemy can be spawned without going over the alive limit */
+	bool HasSpawnHeadroom() const;
+
+	/**
+	 *  Tries to take an attack token for the provided enemy.
+	 *  @return true if the enemy may attack. Enemies that already hold a token always get true
+	 */
+	bool RequestAttackToken(ACombatEnemy* Enemy);
+
+	/** Gives an attack token back once the attack is over */
+	void ReleaseAttackToken(ACombatEnemy* Enemy);
+
+	/** Counts a melee trace towards this frame's trace load */
+	void NotifyMeleeTrace() { ++TracesThisFrame; }
+
+	/** Returns the number of live enemies */
+	int32 GetNumAliveEnemies() const { return AliveEnemies.Num(); }
+
+	/** Returns the number of enemies currently holding an attack token */
+	int32 GetNumAttackers() const { return Attackers.Num(); }
+
+	/** Returns the current max number of live enemies */
+	int32 GetMaxAliveEnemies() const;
+
+	/** Returns the current max number of attacking enemies */
+	int32 GetMaxAttackers() const;
+
+	/** Returns the current load pressure, from 0 with plenty of headroom to 1 when every limit is at its minimum */
+	float GetPressure() const { return Pressure; }
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Only create the director for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Max number of live enemies with no load pressure */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 200))
+	int32 MaxAliveEnemies = 16;
+
+	/** Max number of live enemies under full load pressure. Keeps encounters progressing on slow machines */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 200))
+	int32 MinAliveEnemies = 4;
+
+	/** Max number of attacking enemies with no load pressure */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 50))
+	int32 MaxAttackers = 4;
+
+	/** Max number of attacking enemies under full load pressure */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 50))
+	int32 MinAttackers = 1;
+
+	/** Game thread time per frame under which there's no frame time pressure */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 100, Units = "ms"))
+	float TargetFrameMs = 12.0f;
+
+	/** Game thread time per frame at which frame time pressure is full */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 100, Units = "ms"))
+	float MaxFrameMs = 25.0f;
+
+	/** Melee traces per frame at which trace pressure is full */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 1, ClampMax = 1000))
+	int32 MaxTracesPerFrame = 64;
+
+	/** How quickly the smoothed frame time and trace count follow the measured ones. Higher is faster */
+	UPROPERTY(Config, EditAnywhere, Category="Director", meta = (ClampMin = 0.1, ClampMax = 20))
+	float SmoothingSpeed = 2.0f;
+
+	/** Live enemies */
+	TArray<TWeakObjectPtr<ACombatEnemy>> AliveEnemies;
+
+	/** Enemies holding an attack token */
+	TArray<TWeakObjectPtr<ACombatEnemy>> Attackers;
+
+	/** Melee traces counted since the last tick */
+	int32 TracesThisFrame = 0;
+
+	/** Smoothed game thread time per frame, excluding time spent idling for a frame rate cap */
+	float SmoothedFrameMs = 0.0f;
+
+	/** Smoothed melee traces per frame */
+	float SmoothedTraces = 0.0f;
+
+	/** Current load pressure */
+	float Pressure = 0.0f;
+};
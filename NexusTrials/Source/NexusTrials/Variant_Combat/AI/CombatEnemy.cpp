@@ -5,12 +5,33 @@
 #include "Components/CapsuleComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "CombatAIController.h"
-#include "Components/WidgetComponent.h"
 #include "Engine/DamageEvents.h"
-#include "CombatLifeBar.h"
+#include "CombatHealthBarSubsystem.h"
 #include "TimerManager.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Animation/AnimInstance.h"
+#include "CombatDamageableGrid.h"
+#include "CombatSwingTracker.h"
+#include "CombatHitReactionComponent.h"
+#include "CombatRagdollSubsystem.h"
+#include "CombatThreatSubsystem.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatEncounterDirectorSubsystem.h"
+#include "CombatFactionSubsystem.h"
+#include "CombatSnapshotSubsystem.h"
+#include "BrainComponent.h"
+#include "Components/StateTreeComponent.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
+#include "Performance/NexusAILODSubsystem.h"
+#include "Performance/NexusAnimBudgetSubsystem.h"
+#include "Performance/NexusMovementLODSubsystem.h"
+
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Combat_Event_Damaged, "Combat.Event.Damaged", "Combat enemy took damage");
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Combat_Event_Danger, "Combat.Event.Danger", "A hostile attack is coming at a combat enemy");
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Combat_Event_AttackFinished, "Combat.Event.AttackFinished", "Combat enemy attack montage ended");
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Combat_Event_Landed, "Combat.Event.Landed", "Combat enemy landed");
+UE_DEFINE_GAMEPLAY_TAG_COMMENT(TAG_Combat_Event_TargetChanged, "Combat.Event.TargetChanged", "Combat enemy picked a different target");
 
 ACombatEnemy::ACombatEnemy()
 {
@@ -28,9 +49,8 @@ ACombatEnemy::ACombatEnemy()
 	// ignore the controller's yaw rotation
 	bUseControllerRotationYaw = false;
 
-	// create the life bar
-	LifeBar = CreateDefaultSubobject<UWidgetComponent>(TEXT("LifeBar"));
-	LifeBar->SetupAttachment(RootComponent);
+	// create the hit reaction springs
+	HitReaction = CreateDefaultSubobject<UCombatHitReactionComponent>(TEXT("HitReaction"));
 
 	// set the collision capsule size
 	GetCapsuleComponent()->SetCapsuleSize(35.0f, 90.0f);
@@ -42,17 +62,32 @@ ACombatEnemy::ACombatEnemy()
 	CurrentHP = MaxHP;
 }
 
-void ACombatEnemy::DoAIComboAttack()
+bool ACombatEnemy::DoAIComboAttack()
 {
 	// ignore if we're already playing an attack animation
 	if (bIsAttacking)
 	{
-		return;
+		return false;
+	}
+
+	// wait our turn if too many enemies are already attacking
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		if (!Director->RequestAttackToken(this))
+		{
+			return false;
+		}
 	}
 
 	// raise the attacking flag
 	bIsAttacking = true;
 
+	// keep ticking at full rate while we attack
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->NotifyCombatActivity(this);
+	}
+
 	// choose how many times we're going to attack
 	TargetComboCount = FMath::RandRange(1, ComboSectionNames.Num() - 1);
 
@@ -60,9 +95,11 @@ void ACombatEnemy::DoAIComboAttack()
 	CurrentComboAttack = 0;
 
 	// play the attack montage
+	float MontageLength = 0.0f;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
-		const float MontageLength = AnimInstance->Montage_Play(ComboAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
+		MontageLength = AnimInstance->Montage_Play(ComboAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
 
 		// subscribe to montage completed and interrupted events
 		if (MontageLength > 0.0f)
@@ -71,19 +108,49 @@ void ACombatEnemy::DoAIComboAttack()
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ComboAttackMontage);
 		}
 	}
+
+	// the montage end would never fire, so undo the attack and give our token back now
+	if (MontageLength <= 0.0f)
+	{
+		bIsAttacking = false;
+
+		if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+		{
+			Director->ReleaseAttackToken(this);
+		}
+
+		return false;
+	}
+
+	return true;
 }
 
-void ACombatEnemy::DoAIChargedAttack()
+bool ACombatEnemy::DoAIChargedAttack()
 {
 	// ignore if we're already playing an attack animation
 	if (bIsAttacking)
 	{
-		return;
+		return false;
+	}
+
+	// wait our turn if too many enemies are already attacking
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		if (!Director->RequestAttackToken(this))
+		{
+			return false;
+		}
 	}
 
 	// raise the attacking flag
 	bIsAttacking = true;
 
+	// keep ticking at full rate while we attack
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->NotifyCombatActivity(this);
+	}
+
 	// choose how many loops are we going to charge for
 	TargetChargeLoops = FMath::RandRange(MinChargeLoops, MaxChargeLoops);
 
@@ -91,9 +158,11 @@ void ACombatEnemy::DoAIChargedAttack()
 	CurrentChargeLoop = 0;
 
 	// play the attack montage
+	float MontageLength = 0.0f;
+
 	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
 	{
-		const float MontageLength = AnimInstance->Montage_Play(ChargedAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
+		MontageLength = AnimInstance->Montage_Play(ChargedAttackMontage, 1.0f, EMontagePlayReturnType::MontageLength, 0.0f, true);
 
 		// subscribe to montage completed and interrupted events
 		if (MontageLength > 0.0f)
@@ -102,6 +171,21 @@ void ACombatEnemy::DoAIChargedAttack()
 			AnimInstance->Montage_SetEndDelegate(OnAttackMontageEnded, ChargedAttackMontage);
 		}
 	}
+
+	// the montage end would never fire, so undo the attack and give our token back now
+	if (MontageLength <= 0.0f)
+	{
+		bIsAttacking = false;
+
+		if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+		{
+			Director->ReleaseAttackToken(this);
+		}
+
+		return false;
+	}
+
+	return true;
 }
 
 void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
@@ -109,8 +193,14 @@ void ACombatEnemy::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted)
 	// reset the attacking flag
 	bIsAttacking = false;
 
-	// call the attack completed delegate so the StateTree can continue execution
-	OnAttackCompleted.ExecuteIfBound();
+	// let another enemy take our turn
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		Director->ReleaseAttackToken(this);
+	}
+
+	// let the StateTree continue execution
+	RaiseCombatEvent(ECombatEnemyEvent::AttackFinished, GetActorLocation(), nullptr, bInterrupted);
 }
 
 const FVector& ACombatEnemy::GetLastDangerLocation() const
@@ -123,47 +213,133 @@ float ACombatEnemy::GetLastDangerTime() const
 	return LastDangerTime;
 }
 
+bool ACombatEnemy::GetMostRecentDanger(FVector& OutLocation, float& OutTime) const
+{
+	// start with the last danger we were notified of directly
+	OutLocation = LastDangerLocation;
+	OutTime = LastDangerTime;
+
+	// check the threat field for anything newer that covers our capsule. Only attacks from factions hostile to us are dangerous
+	if (const UCombatThreatSubsystem* ThreatField = UCombatThreatSubsystem::Get(this))
+	{
+		const uint32 HostileFactions = UCombatFactionSubsystem::GetMatrix(this).GetAttackerMask(Faction);
+
+		if (const FCombatThreat* Threat = ThreatField->FindLatestThreat(GetActorLocation(), GetCapsuleComponent()->GetScaledCapsuleRadius(), this, HostileFactions))
+		{
+			if (Threat->PublishTime > OutTime)
+			{
+				OutLocation = Threat->Origin;
+				OutTime = Threat->PublishTime;
+			}
+		}
+	}
+
+	return OutTime > 0.0f;
+}
+
+void ACombatEnemy::RecordDanger(const FVector& DangerLocation, float DangerTime, AActor* DangerSource)
+{
+	// save the danger location, direction and game time
+	LastDangerLocation = DangerLocation;
+	LastDangerTime = DangerTime;
+	LastDangerDirection = (DangerLocation - GetActorLocation()).GetSafeNormal2D();
+
+	// have the StateTree react to the danger this frame
+	RaiseCombatEvent(ECombatEnemyEvent::Danger, DangerLocation, DangerSource);
+}
+
 void ACombatEnemy::DoAttackTrace(FName DamageSourceBone)
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	// a single trace is a swing of its own, unless it happens inside an attack window
+	if (!SwingTracker.IsActive())
+	{
+		SwingTracker.ResetHits();
+	}
 
 	// start at the provided socket location, sweep forward
 	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
 	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
 
+	SweepAttackSegment(TraceStart, TraceEnd);
+}
+
+void ACombatEnemy::BeginAttackWindow(FName DamageSourceBone)
+{
+	// start tracking the bone's path and clear the hit list for this swing
+	SwingTracker.Begin(GetMesh(), DamageSourceBone);
+}
+
+void ACombatEnemy::TickAttackWindow(FName DamageSourceBone)
+{
+	// ignore if the window was never opened
+	if (!SwingTracker.IsActive())
+	{
+		return;
+	}
+
+	// get the connected path the bone followed since the last update
+	FCombatSwingTracker::FSwingPath SwingPath;
+	SwingTracker.Advance(GetMesh(), DamageSourceBone, SwingSampleSpacing, SwingPath);
+
+	// sweep each segment of the path, then again pushed forward along our reach, so the window covers
+	// everything a single attack trace from the bone would
+	const FVector Reach = GetActorForwardVector() * MeleeTraceDistance;
+	const int32 NumReachLayers = FCombatSwingTracker::GetNumReachLayers(MeleeTraceDistance, MeleeTraceRadius);
+
+	for (int32 Layer = 0; Layer <= NumReachLayers; ++Layer)
+	{
+		const FVector Offset = NumReachLayers > 0 ? Reach * (static_cast<float>(Layer) / NumReachLayers) : FVector::ZeroVector;
+
+		for (int32 PointIndex = 1; PointIndex < SwingPath.Num(); ++PointIndex)
+		{
+			SweepAttackSegment(SwingPath[PointIndex - 1] + Offset, SwingPath[PointIndex] + Offset);
+		}
+	}
+}
+
+void ACombatEnemy::EndAttackWindow(FName DamageSourceBone)
+{
+	// sweep whatever is left of the path before closing the window
+	TickAttackWindow(DamageSourceBone);
+
+	SwingTracker.End();
+}
+
+void ACombatEnemy::SweepAttackSegment(const FVector& TraceStart, const FVector& TraceEnd)
+{
+	// sweep for objects along the segment to be hit by the attack. The results only live until the end of the frame
+	TNexusFrameArray<FHitResult> OutHits;
+
 	// enemies only affect Pawn collision objects; they don't knock back boxes
 	FCollisionObjectQueryParams ObjectParams;
 	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
+	// only factions we're hostile to can be hit
+	const uint32 TargetFactions = UCombatFactionSubsystem::GetMatrix(this).GetTargetMask(Faction);
 
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// sweep a sphere against the damageable grid, ignoring self
+	if (UCombatDamageableGrid::SweepDamageables(this, OutHits, TraceStart, TraceEnd, MeleeTraceRadius, ObjectParams, this, TargetFactions))
 	{
 		// iterate over each object hit
 		for (const FHitResult& CurrentHit : OutHits)
 		{
-			/** does the actor have the player tag? */
-			if (CurrentHit.GetActor()->ActorHasTag(FName("Player")))
+			// skip targets we've already hit this swing
+			if (!SwingTracker.RegisterHit(CurrentHit.GetActor(), CurrentHit.Item))
 			{
-				// check if the actor is damageable
-				ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
+				continue;
+			}
 
-				if (Damageable)
-				{
-					// knock upwards and away from the impact normal
-					const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+			// check if the actor is damageable
+			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
 
-					// pass the damage event to the actor
-					Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+			if (Damageable)
+			{
+				// knock upwards and away from the impact normal
+				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
+
+				// pass the damage event to the actor
+				Damageable->ApplyHitDamage(MeleeDamage, this, CurrentHit, Impulse);
 
-				}
 			}
 		}
 	}
@@ -207,9 +383,24 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 	// only process knockback and effects if we received nonzero damage
 	if (ActualDamage > 0.0f)
 	{
+		// make sure we're ticking at full rate to react to the hit
+		if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+		{
+			Significance->NotifyCombatActivity(this);
+		}
+
+		// and that the StateTree reacts this frame
+		RaiseCombatEvent(ECombatEnemyEvent::Damaged, DamageLocation, DamageCauser);
+
 		// apply the knockback impulse
 		GetCharacterMovement()->AddImpulse(DamageImpulse, true);
 
+		// flinch if we survived the hit
+		if (CurrentHP > 0.0f)
+		{
+			PlayHitReaction(DamageImpulse);
+		}
+
 		// is the character ragdolling?
 		if (GetMesh()->IsSimulatingPhysics())
 		{
@@ -229,10 +420,38 @@ void ACombatEnemy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector
 	}
 }
 
+void ACombatEnemy::PlayHitReaction(const FVector& DamageImpulse)
+{
+	// let the budget pick the few hits that get a partial ragdoll
+	UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this);
+
+	if (RagdollBudget)
+	{
+		if (RagdollBudget->TryStartPhysicsHitReaction(GetMesh(), PelvisBoneName))
+		{
+			return;
+		}
+
+	} else {
+
+		// enable partial ragdoll physics, but keep the pelvis vertical
+		GetMesh()->SetPhysicsBlendWeight(0.5f);
+		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		return;
+	}
+
+	// everyone else flinches procedurally in the anim graph
+	// if the mesh isn't set up for it, the hit gets no reaction rather than going over the physics budget
+	HitReaction->AddHitReaction(DamageImpulse.GetSafeNormal());
+}
+
 void ACombatEnemy::HandleDeath()
 {
 	// hide the life bar
-	LifeBar->SetHiddenInGame(true);
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->SetVisible(LifeBarHandle, false);
+	}
 
 	// disable the collision capsule to avoid being hit again while dead
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -243,6 +462,24 @@ void ACombatEnemy::HandleDeath()
 	// enable full ragdoll physics
 	GetMesh()->SetSimulatePhysics(true);
 
+	// let the ragdoll budget take us out of the simulation when we come to rest or too many bodies are active
+	if (UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+	{
+		RagdollBudget->RegisterRagdoll(GetMesh());
+	}
+
+	// the capsule no longer collides, so let melee attacks find the ragdoll instead
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->SetShape(this, GetMesh());
+	}
+
+	// free up our alive slot and attack token for the next enemy
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		Director->UnregisterEnemy(this);
+	}
+
 	// call the died delegate to notify any subscribers
 	OnEnemyDied.Broadcast();
 
@@ -257,17 +494,120 @@ void ACombatEnemy::ApplyHealing(float Healing, AActor* Healer)
 
 void ACombatEnemy::NotifyDanger(const FVector& DangerLocation, AActor* DangerSource)
 {
-	// ensure we're being attacked by the player
-	if (DangerSource && DangerSource->ActorHasTag(FName("Player")))
+	// ensure we're being attacked by a hostile faction
+	if (UCombatFactionSubsystem::IsHostile(DangerSource, this))
 	{
-		// save the danger location and game time
-		LastDangerLocation = DangerLocation;
-		LastDangerTime = GetWorld()->GetTimeSeconds();
+		RecordDanger(DangerLocation, GetWorld()->GetTimeSeconds(), DangerSource);
+	}
+}
+
+ECombatFaction ACombatEnemy::GetFaction() const
+{
+	return Faction;
+}
+
+void ACombatEnemy::SetFaction(ECombatFaction NewFaction)
+{
+	Faction = NewFaction;
+
+	// keep the melee broadphase in sync so hit filtering picks up the new side
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->SetFaction(this, Faction);
+	}
+
+	// pooled enemies pick up their faction's targeting when they're reactivated
+	if (!bIsPooled)
+	{
+		if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+		{
+			TargetSnapshot->RegisterAgent(this, UCombatFactionSubsystem::GetMatrix(this).GetTargetMask(Faction));
+			TargetSnapshot->RegisterTarget(this, 1u << static_cast<uint32>(Faction));
+		}
+	}
+}
+
+void ACombatEnemy::SerializeSnapshot(FArchive& Ar)
+{
+	// dead enemies are on their way back to the pool, so they're saved as out of play
+	bool bInPlay = IsAlive();
+	FTransform SavedTransform = GetActorTransform();
+	float SavedHP = CurrentHP;
+	uint8 SavedFaction = static_cast<uint8>(Faction);
+
+	Ar << bInPlay;
+	Ar << SavedTransform;
+	Ar << SavedHP;
+	Ar << SavedFaction;
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	// spawners rebind to the enemies they own once everything is restored, so only drop bindings from snapshotted
+	// actors. Anyone else listening for our death, e.g. level scripts or UI, stays subscribed
+	for (UObject* Subscriber : OnEnemyDied.GetAllObjects())
+	{
+		if (Subscriber && Subscriber->Implements<UCombatSnapshotable>())
+		{
+			OnEnemyDied.RemoveAll(Subscriber);
+		}
+	}
+
+	Faction = static_cast<ECombatFaction>(SavedFaction);
+
+	if (bInPlay)
+	{
+		if (bIsPooled)
+		{
+			// take ourselves back out of the pool so no spawner hands us out
+			if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
+			{
+				Pool->RemoveFromPool(this);
+			}
+
+		} else {
+
+			// we're about to register again
+			UnregisterFromWorldSystems();
+		}
+
+		GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+		// the saved transform was clear when it was captured
+		ActivateFromPool(SavedTransform, false);
+
+		CurrentHP = SavedHP;
+
+		if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+		{
+			HealthBars->SetPercent(LifeBarHandle, CurrentHP / MaxHP);
+		}
+
+	} else if (!bIsPooled) {
+
+		RemoveFromLevel();
+	}
+}
+
+void ACombatEnemy::DiscardForSnapshot()
+{
+	if (!bIsPooled)
+	{
+		RemoveFromLevel();
 	}
 }
 
 void ACombatEnemy::RemoveFromLevel()
 {
+	// return to the enemy pool so a spawner can reuse us
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
+	{
+		Pool->ReleaseEnemy(this);
+		return;
+	}
+
 	// destroy this actor
 	Destroy();
 }
@@ -292,11 +632,11 @@ float ACombatEnemy::TakeDamage(float Damage, struct FDamageEvent const& DamageEv
 	else
 	{
 		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+		if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+		{
+			HealthBars->SetPercent(LifeBarHandle, CurrentHP / MaxHP);
+		}
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
 	}
 
 	// return the received damage amount
@@ -310,12 +650,19 @@ void ACombatEnemy::Landed(const FHitResult& Hit)
 	// is the character still alive?
 	if (CurrentHP >= 0.0f)
 	{
-		// disable ragdoll physics
-		GetMesh()->SetPhysicsBlendWeight(0.0f);
+		// end any partial ragdoll hit reaction
+		if (UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+		{
+			RagdollBudget->EndPhysicsHitReaction(GetMesh());
+
+		} else {
+
+			GetMesh()->SetPhysicsBlendWeight(0.0f);
+		}
 	}
 
-	// call the landed Delegate for StateTree
-	OnEnemyLanded.ExecuteIfBound();
+	// have the StateTree pick up the landing this frame
+	RaiseCombatEvent(ECombatEnemyEvent::Landed, Hit.ImpactPoint, nullptr);
 }
 
 void ACombatEnemy::BeginPlay()
@@ -326,12 +673,18 @@ void ACombatEnemy::BeginPlay()
 	// we top the HP before BeginPlay so StateTree picks it up at the right value
 	Super::BeginPlay();
 
-	// get the life bar widget from the widget comp
-	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
-	check(LifeBarWidget);
+	// save the mesh and capsule starting state so we can undo the ragdoll when we're reused from the pool
+	MeshStartingTransform = GetMesh()->GetRelativeTransform();
+	MeshStartingCollision = GetMesh()->GetCollisionEnabled();
+	CapsuleStartingCollision = GetCapsuleComponent()->GetCollisionEnabled();
+
+	RegisterWithWorldSystems();
 
-	// fill the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	// stay in the arena snapshot while pooled, so a restore can bring us back
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
 }
 
 void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
@@ -340,4 +693,277 @@ void ACombatEnemy::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	UnregisterFromWorldSystems();
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
+}
+
+void ACombatEnemy::RegisterWithWorldSystems()
+{
+	// add ourselves to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Register(this, GetCapsuleComponent());
+	}
+
+	// add a full life bar to the batched health bar list
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		LifeBarHandle = HealthBars->RegisterBar(GetRootComponent(), LifeBarOffset, LifeBarColor);
+	}
+
+	// let the animation budget pick our mesh update rate. This goes first so the significance manager leaves the mesh tick alone
+	if (UNexusAnimBudgetSubsystem* AnimBudget = UNexusAnimBudgetSubsystem::Get(this))
+	{
+		AnimBudget->RegisterMesh(GetMesh());
+	}
+
+	// let the significance manager scale our tick rate with distance to the player
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this);
+	}
+
+	// follow the navmesh instead of running the full walking simulation while we're far from the player
+	if (UNexusMovementLODSubsystem* MovementLOD = UNexusMovementLODSubsystem::Get(this))
+	{
+		MovementLOD->RegisterCharacter(this);
+	}
+
+	// pick our nearest hostile through the shared target snapshot, and let other factions pick us
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->RegisterAgent(this, UCombatFactionSubsystem::GetMatrix(this).GetTargetMask(Faction));
+		TargetSnapshot->RegisterTarget(this, 1u << static_cast<uint32>(Faction));
+		TargetSnapshot->BindTargetChanged(this, FOnNexusTargetChanged::CreateUObject(this, &ACombatEnemy::OnTargetChanged));
+	}
+
+	// count against the encounter director's alive limit
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		Director->RegisterEnemy(this);
+	}
+}
+
+void ACombatEnemy::RaiseCombatEvent(ECombatEnemyEvent Type, const FVector& Location, AActor* Instigator, bool bInterrupted)
+{
+	FCombatEnemyEvent Event;
+	Event.Type = Type;
+	Event.Location = Location;
+	Event.Instigator = Instigator;
+	Event.Time = GetWorld()->GetTimeSeconds();
+	Event.bInterrupted = bInterrupted;
+
+	// notify any listening StateTree tasks
+	OnCombatEvent.Broadcast(Event);
+
+	// forward the event to the StateTree so its transitions can wait on it
+	if (const AAIController* AIController = Cast<AAIController>(GetController()))
+	{
+		if (UStateTreeComponent* StateTree = Cast<UStateTreeComponent>(AIController->GetBrainComponent()))
+		{
+			if (StateTree->IsRunning())
+			{
+				StateTree->SendStateTreeEvent(GetCombatEventTag(Type), FConstStructView::Make(Event));
+			}
+		}
+	}
+
+	// evaluate the StateTree this frame even if the AI LOD manager has it on a reduced rate
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->RequestImmediateEvaluation(this);
+	}
+}
+
+FGameplayTag ACombatEnemy::GetCombatEventTag(ECombatEnemyEvent Type)
+{
+	switch (Type)
+	{
+	case ECombatEnemyEvent::Damaged:
+		return TAG_Combat_Event_Damaged;
+
+	case ECombatEnemyEvent::Danger:
+		return TAG_Combat_Event_Danger;
+
+	case ECombatEnemyEvent::AttackFinished:
+		return TAG_Combat_Event_AttackFinished;
+
+	case ECombatEnemyEvent::Landed:
+		return TAG_Combat_Event_Landed;
+
+	case ECombatEnemyEvent::TargetChanged:
+		return TAG_Combat_Event_TargetChanged;
+	}
+
+	return FGameplayTag();
+}
+
+void ACombatEnemy::OnTargetChanged(APawn* NewTarget)
+{
+	// ignore target changes while we're dead or pooled
+	if (!IsAlive())
+	{
+		return;
+	}
+
+	RaiseCombatEvent(ECombatEnemyEvent::TargetChanged, NewTarget ? NewTarget->GetActorLocation() : GetActorLocation(), NewTarget);
+}
+
+void ACombatEnemy::UnregisterFromWorldSystems()
+{
+	// remove ourselves from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Unregister(this);
+	}
+
+	// remove our life bar
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->UnregisterBar(LifeBarHandle);
+	}
+
+	// stop counting against the ragdoll budget
+	if (UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+	{
+		RagdollBudget->UnregisterRagdoll(GetMesh());
+	}
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
+
+	// give the mesh back its authored animation update settings
+	if (UNexusAnimBudgetSubsystem* AnimBudget = UNexusAnimBudgetSubsystem::Get(this))
+	{
+		AnimBudget->UnregisterMesh(GetMesh());
+	}
+
+	// get back on full walking
+	if (UNexusMovementLODSubsystem* MovementLOD = UNexusMovementLODSubsystem::Get(this))
+	{
+		MovementLOD->UnregisterCharacter(this);
+	}
+
+	// stop picking targets and being picked
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->UnregisterAgent(this);
+		TargetSnapshot->UnregisterTarget(this);
+	}
+
+	// stop counting against the encounter director's limits
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this))
+	{
+		Director->UnregisterEnemy(this);
+	}
+}
+
+void ACombatEnemy::DeactivateForPool()
+{
+	// ignore if we're already waiting in the pool
+	if (bIsPooled)
+	{
+		return;
+	}
+
+	bIsPooled = true;
+
+	// clear the death timer in case we're pooled before it fires
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// drop any subscribers from our previous life
+	OnEnemyDied.Clear();
+	OnCombatEvent.Clear();
+
+	UnregisterFromWorldSystems();
+
+	// stop the StateTree but keep the controller around so we don't need to spawn a new one
+	if (AAIController* AIController = Cast<AAIController>(GetController()))
+	{
+		if (UBrainComponent* Brain = AIController->GetBrainComponent())
+		{
+			Brain->StopLogic(TEXT("Pooled"));
+		}
+	}
+
+	// stop simulating and hide
+	GetMesh()->SetSimulatePhysics(false);
+	GetCharacterMovement()->DisableMovement();
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+	SetActorTickEnabled(false);
+	GetMesh()->SetComponentTickEnabled(false);
+	GetCharacterMovement()->SetComponentTickEnabled(false);
+}
+
+void ACombatEnemy::ActivateFromPool(const FTransform& SpawnTransform, bool bAdjustSpawnLocation)
+{
+	bIsPooled = false;
+
+	// stop any attacks we were playing when we died
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	SwingTracker.End();
+	bIsAttacking = false;
+	LastDangerTime = -1000.0f;
+
+	HitReaction->ResetHitReactions();
+
+	// undo the ragdoll: reattach the mesh, restore its transform, collision and skeleton updates
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	GetMesh()->bNoSkeletonUpdate = false;
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshStartingTransform);
+	GetMesh()->SetCollisionEnabled(MeshStartingCollision);
+	GetCapsuleComponent()->SetCollisionEnabled(CapsuleStartingCollision);
+
+	// move to the spawn point, adjusting to avoid encroaching other actors unless the caller already did
+	FVector SpawnLocation = SpawnTransform.GetLocation();
+	FRotator SpawnRotation = SpawnTransform.Rotator();
+
+	if (bAdjustSpawnLocation)
+	{
+		GetWorld()->FindTeleportSpot(this, SpawnLocation, SpawnRotation);
+	}
+	TeleportTo(SpawnLocation, SpawnRotation, false, true);
+
+	// wake up
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	SetActorTickEnabled(true);
+	GetMesh()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->SetComponentTickEnabled(true);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	// reset HP before the StateTree restarts so it picks up the right value
+	CurrentHP = MaxHP;
+
+	// the life bar comes back full when we re-register
+	RegisterWithWorldSystems();
+
+	// make sure we're possessed, then restart the StateTree from scratch
+	AAIController* AIController = Cast<AAIController>(GetController());
+
+	if (!AIController)
+	{
+		SpawnDefaultController();
+	}
+	else if (UBrainComponent* Brain = AIController->GetBrainComponent())
+	{
+		Brain->RestartLogic();
+	}
 }
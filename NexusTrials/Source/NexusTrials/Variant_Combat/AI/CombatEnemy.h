@@ -6,19 +6,75 @@
 #include "GameFramework/Character.h"
 #include "CombatAttacker.h"
 #include "CombatDamageable.h"
+#include "CombatSnapshotable.h"
+#include "CombatSwingTracker.h"
 #include "Animation/AnimMontage.h"
 #include "Engine/TimerHandle.h"
+#include "NativeGameplayTags.h"
 #include "CombatEnemy.generated.h"
 
-class UWidgetComponent;
-class UCombatLifeBar;
 class UAnimMontage;
+class UCombatHitReactionComponent;
 
-/** Completed attack animation delegate for StateTree */
-DECLARE_DELEGATE(FOnEnemyAttackCompleted);
+/** Gameplay events an enemy raises for its AI */
+UENUM(BlueprintType)
+enum class ECombatEnemyEvent : uint8
+{
+	/** We took damage */
+	Damaged,
+
+	/** A hostile attack is coming our way */
+	Danger,
+
+	/** Our attack montage ended, either finished or interrupted */
+	AttackFinished,
+
+	/** We landed after a fall or knockback */
+	Landed,
+
+	/** The target snapshot picked a different target for us */
+	TargetChanged
+};
+
+/**
+ *  Payload for an enemy gameplay event.
+ *  Also sent along with the matching Combat.Event.* StateTree event
+ */
+USTRUCT(BlueprintType)
+struct FCombatEnemyEvent
+{
+	GENERATED_BODY()
+
+	/** What happened */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Event")
+	ECombatEnemyEvent Type = ECombatEnemyEvent::Damaged;
+
+	/** Damage or danger location, landing point, or the new target's location */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Event")
+	FVector Location = FVector::ZeroVector;
+
+	/** Damage causer, danger source or new target, if any */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Event")
+	TObjectPtr<AActor> Instigator = nullptr;
 
-/** Landed delegate for StateTree */
-DECLARE_DELEGATE(FOnEnemyLanded);
+	/** Game time the event was raised */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Event")
+	float Time = 0.0f;
+
+	/** For attack finished events, true if the attack was interrupted */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Event")
+	bool bInterrupted = false;
+};
+
+/** Gameplay event channel for StateTree tasks. Multicast so several tasks can listen at once */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnCombatEnemyEvent, const FCombatEnemyEvent&);
+
+/** StateTree event tags, one per ECombatEnemyEvent */
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Combat_Event_Damaged);
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Combat_Event_Danger);
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Combat_Event_AttackFinished);
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Combat_Event_Landed);
+UE_DECLARE_GAMEPLAY_TAG_EXTERN(TAG_Combat_Event_TargetChanged);
 
 /** Enemy died delegate */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnEnemyDied);
@@ -28,13 +84,13 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnEnemyDied);
  *  Its bundled AI Controller runs logic through StateTree
  */
 UCLASS(abstract)
-class ACombatEnemy : public ACharacter, public ICombatAttacker, public ICombatDamageable
+class ACombatEnemy : public ACharacter, public ICombatAttacker, public ICombatDamageable, public ICombatSnapshotable
 {
 	GENERATED_BODY()
 
-	/** Life bar widget component */
+	/** Procedural hit reactions */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
-	UWidgetComponent* LifeBar;
+	UCombatHitReactionComponent* HitReaction;
 
 public:
 	
@@ -43,6 +99,10 @@ public:
 
 protected:
 
+	/** Side this enemy fights for. Decides who its attacks can hit and whose attacks it reacts to */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Faction")
+	ECombatFaction Faction = ECombatFaction::Enemy;
+
 	/** Max amount of HP the character will have on respawn */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float MaxHP = 3.0f;
@@ -59,9 +119,16 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FName PelvisBoneName;
 
-	/** Pointer to the life bar widget */
+	/** Life bar position, relative to the actor */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	FVector LifeBarOffset = FVector(0.0f, 0.0f, 120.0f);
+
+	/** Life bar fill color */
 	UPROPERTY(EditAnywhere, Category="Damage")
-	UCombatLifeBar* LifeBarWidget;
+	FLinearColor LifeBarColor = FLinearColor(0.8f, 0.05f, 0.05f);
+
+	/** Handle to our entry in the batched health bar list */
+	int32 LifeBarHandle = INDEX_NONE;
 
 	/** If true, the character is currently playing an attack animation */
 	bool bIsAttacking = false;
@@ -74,6 +141,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 500, Units = "cm"))
 	float MeleeTraceRadius = 50.0f;
 
+	/** Max distance between sampled points of the attack bone's path inside an attack window */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 5, ClampMax = 200, Units = "cm"))
+	float SwingSampleSpacing = 25.0f;
+
+	/** Path sampling and hit list for the current swing */
+	FCombatSwingTracker SwingTracker;
+
 	/** Amount of damage a melee attack will deal */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Damage", meta = (ClampMin = 0, ClampMax = 100))
 	float MeleeDamage = 1.0f;
@@ -142,12 +216,27 @@ protected:
 	/** Last recorded game time we were attacked */
 	float LastDangerTime = -1000.0f;
 
-public:
-	/** Attack completed internal delegate to notify StateTree tasks */
-	FOnEnemyAttackCompleted OnAttackCompleted;
+	/** Flat direction from us to the last recorded danger location, captured with the danger event */
+	FVector LastDangerDirection = FVector::ForwardVector;
+
+	/** Copy of the mesh's relative transform so we can undo the ragdoll when reused from the pool */
+	FTransform MeshStartingTransform;
+
+	/** Mesh collision setting at BeginPlay, restored when reused from the pool */
+	TEnumAsByte<ECollisionEnabled::Type> MeshStartingCollision = ECollisionEnabled::QueryAndPhysics;
+
+	/** Capsule collision setting at BeginPlay, restored when reused from the pool */
+	TEnumAsByte<ECollisionEnabled::Type> CapsuleStartingCollision = ECollisionEnabled::QueryAndPhysics;
 
-	/** Landed internal delegate to notify StateTree tasks. We use this instead of the built-in Landed delegate so we can bind to a Lambda in StateTree tasks */
-	FOnEnemyLanded OnEnemyLanded;
+	/** If true, this enemy is hidden and dormant, waiting in the enemy pool */
+	bool bIsPooled = false;
+
+public:
+	/**
+	 *  Gameplay event channel to notify StateTree tasks of damage, danger, finished attacks, landings and target changes.
+	 *  Every event is also sent to the StateTree as a Combat.Event.* gameplay tag, so trees can wait on events instead of polling
+	 */
+	FOnCombatEnemyEvent OnCombatEvent;
 
 	/** Enemy died delegate. Allows external subscribers to respond to enemy death */
 	UPROPERTY(BlueprintAssignable, Category="Events")
@@ -155,11 +244,17 @@ public:
 
 public:
 
-	/** Performs an AI-initiated combo attack. Number of hits will be decided by this character */
-	void DoAIComboAttack();
+	/**
+	 *  Performs an AI-initiated combo attack. Number of hits will be decided by this character.
+	 *  @return false if we're already attacking, the encounter director has no attack token for us or the attack montage can't play
+	 */
+	bool DoAIComboAttack();
 
-	/** Performs an AI-initiated charged attack. Charge time will be decided by this character */
-	void DoAIChargedAttack();
+	/**
+	 *  Performs an AI-initiated charged attack. Charge time will be decided by this character.
+	 *  @return false if we're already attacking, the encounter director has no attack token for us or the attack montage can't play
+	 */
+	bool DoAIChargedAttack();
 
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
@@ -170,6 +265,18 @@ public:
 	/** Returns the last game time we were attacked */
 	float GetLastDangerTime() const;
 
+	/** Returns the flat direction from us to the last recorded danger location, as of the danger event */
+	const FVector& GetLastDangerDirection() const { return LastDangerDirection; }
+
+	/** Returns the StateTree event tag for an event type */
+	static FGameplayTag GetCombatEventTag(ECombatEnemyEvent Type);
+
+	/**
+	 *  Looks up the most recent danger we know about, either from the world threat field or from a direct NotifyDanger call.
+	 *  Returns false if we've never been in danger.
+	 */
+	bool GetMostRecentDanger(FVector& OutLocation, float& OutTime) const;
+
 public:
 
 	// ~begin ICombatAttacker interface
@@ -177,6 +284,15 @@ public:
 	/** Performs an attack's collision check */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Opens an attack window for the provided bone */
+	virtual void BeginAttackWindow(FName DamageSourceBone) override;
+
+	/** Sweeps the bone's path since the last window update */
+	virtual void TickAttackWindow(FName DamageSourceBone) override;
+
+	/** Sweeps the rest of the bone's path and closes the attack window */
+	virtual void EndAttackWindow(FName DamageSourceBone) override;
+
 	/** Performs a combo attack's check to continue the string */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckCombo() override;
@@ -201,13 +317,65 @@ public:
 	/** Allows the enemy to react to incoming attacks */
 	virtual void NotifyDanger(const FVector& DangerLocation, AActor* DangerSource) override;
 
+	/** Returns the side this enemy fights for */
+	virtual ECombatFaction GetFaction() const override;
+
 	// ~end ICombatDamageable interface
 
+	// ~begin ICombatSnapshotable interface
+
+	/** Saves or restores whether we're in play, our transform, HP and faction */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	/** Leaves play if we were spawned after the snapshot was captured */
+	virtual void DiscardForSnapshot() override;
+
+	// ~end ICombatSnapshotable interface
+
 protected:
 
 	/** Removes this character from the level after it dies */
 	void RemoveFromLevel();
 
+	/** Sweeps one segment of an attack and damages any player hit for the first time this swing */
+	void SweepAttackSegment(const FVector& TraceStart, const FVector& TraceEnd);
+
+	/** Flinches from a non-lethal hit. Uses a partial ragdoll if the physics budget allows it, a procedural reaction otherwise, and never goes over the budget */
+	void PlayHitReaction(const FVector& DamageImpulse);
+
+	/** Registers with the melee grid, health bar list, significance manager, target snapshot and encounter director */
+	void RegisterWithWorldSystems();
+
+	/** Unregisters from the melee grid, health bar list, ragdoll budget, significance manager, target snapshot and encounter director */
+	void UnregisterFromWorldSystems();
+
+	/** Saves a danger location and time and raises the danger event */
+	void RecordDanger(const FVector& DangerLocation, float DangerTime, AActor* DangerSource);
+
+	/** Broadcasts a gameplay event, forwards it to the StateTree and has the AI evaluate this frame */
+	void RaiseCombatEvent(ECombatEnemyEvent Type, const FVector& Location, AActor* Instigator, bool bInterrupted = false);
+
+	/** Called by the target snapshot when it picks a different target for us */
+	void OnTargetChanged(APawn* NewTarget);
+
+public:
+
+	/** Puts the enemy to sleep so it can wait in the enemy pool */
+	void DeactivateForPool();
+
+	/** Wakes a pooled enemy up at the provided transform with its HP, ragdoll, life bar, montages and StateTree reset */
+	void ActivateFromPool(const FTransform& SpawnTransform, bool bAdjustSpawnLocation = true);
+
+	/** Switches the side this enemy fights for, e.g. to turn it against other enemies */
+	UFUNCTION(BlueprintCallable, Category="Faction")
+	void SetFaction(ECombatFaction NewFaction);
+
+	/** Returns true if the enemy is waiting in the enemy pool */
+	bool IsPooled() const { return bIsPooled; }
+
+	/** Returns true if the enemy is in play and hasn't died */
+	bool IsAlive() const { return !bIsPooled && CurrentHP > 0.0f; }
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
@@ -0,0 +1,141 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatEnemy.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Pool Acquire"), STAT_CombatEnemyPoolAcquire, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Enemy Pool Release"), STAT_CombatEnemyPoolRelease, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Enemy Spawn Actor"), STAT_CombatEnemySpawnActor, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Misses"), STAT_CombatEnemyPoolMisses, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarEnemyPoolEnabled(
+	TEXT("Combat.EnemyPool.Enable"),
+	true,
+	TEXT("If true, dead enemies are returned to a pool and reused by spawners. If false, they are destroyed and re-spawned."));
+
+UCombatEnemyPoolSubsystem* UCombatEnemyPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatEnemyPoolSubsystem>() : nullptr;
+}
+
+bool UCombatEnemyPoolSubsystem::IsPoolingEnabled()
+{
+	return CVarEnemyPoolEnabled.GetValueOnGameThread();
+}
+
+bool UCombatEnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatEnemyPoolSubsystem::Prewarm(TSubclassOf<ACombatEnemy> EnemyClass, int32 Count, const FTransform& ParkingTransform)
+{
+	if (!IsValid(EnemyClass) || !IsPoolingEnabled())
+	{
+		return;
+	}
+
+	FCombatEnemyPoolList& Pool = Pools.FindOrAdd(EnemyClass);
+
+	while (Pool.FreeEnemies.Num() < Count)
+	{
+		ACombatEnemy* Enemy = SpawnEnemy(EnemyClass, ParkingTransform);
+
+		if (!Enemy)
+		{
+			break;
+		}
+
+		// put it to sleep right away
+		Enemy->DeactivateForPool();
+		Pool.FreeEnemies.Add(Enemy);
+	}
+}
+
+ACombatEnemy* UCombatEnemyPoolSubsystem::AcquireEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, bool bAdjustSpawnLocation)
+{
+	if (!IsValid(EnemyClass))
+	{
+		return nullptr;
+	}
+
+	if (IsPoolingEnabled())
+	{
+		SCOPE_CYCLE_COUNTER(STAT_CombatEnemyPoolAcquire);
+
+		if (FCombatEnemyPoolList* Pool = Pools.Find(EnemyClass))
+		{
+			// find a free enemy that wasn't destroyed while it waited, e.g. by a level streaming out
+			while (Pool->FreeEnemies.Num() > 0)
+			{
+				ACombatEnemy* Enemy = Pool->FreeEnemies.Pop(EAllowShrinking::No);
+
+				if (IsValid(Enemy))
+				{
+					Enemy->ActivateFromPool(SpawnTransform, bAdjustSpawnLocation);
+					return Enemy;
+				}
+			}
+		}
+
+		INC_DWORD_STAT(STAT_CombatEnemyPoolMisses);
+	}
+
+	// nothing to reuse, so spawn a new one
+	return SpawnEnemy(EnemyClass, SpawnTransform, bAdjustSpawnLocation);
+}
+
+void UCombatEnemyPoolSubsystem::ReleaseEnemy(ACombatEnemy* Enemy)
+{
+	if (!IsValid(Enemy))
+	{
+		return;
+	}
+
+	// destroy the enemy if we're not pooling
+	if (!IsPoolingEnabled())
+	{
+		Enemy->Destroy();
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatEnemyPoolRelease);
+
+	Enemy->DeactivateForPool();
+	Pools.FindOrAdd(Enemy->GetClass()).FreeEnemies.AddUnique(Enemy);
+}
+
+void UCombatEnemyPoolSubsystem::RemoveFromPool(ACombatEnemy* Enemy)
+{
+	if (!Enemy)
+	{
+		return;
+	}
+
+	if (FCombatEnemyPoolList* Pool = Pools.Find(Enemy->GetClass()))
+	{
+		Pool->FreeEnemies.RemoveSingleSwap(Enemy, EAllowShrinking::No);
+	}
+}
+
+int32 UCombatEnemyPoolSubsystem::GetNumFree(TSubclassOf<ACombatEnemy> EnemyClass) const
+{
+	const FCombatEnemyPoolList* Pool = Pools.Find(EnemyClass);
+	return Pool ? Pool->FreeEnemies.Num() : 0;
+}
+
+ACombatEnemy* UCombatEnemyPoolSubsystem::SpawnEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, bool bAdjustSpawnLocation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatEnemySpawnActor);
+
+	// skip the encroachment check if the caller already found a clear spot
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = bAdjustSpawnLocation ? ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn : ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnTransform, SpawnParams);
+}
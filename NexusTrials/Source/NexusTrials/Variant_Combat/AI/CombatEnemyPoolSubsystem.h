@@ -0,0 +1,74 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatEnemyPoolSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/**
+ *  Free enemies of a single class
+ */
+USTRUCT()
+struct FCombatEnemyPoolList
+{
+	GENERATED_BODY()
+
+	/** Hidden, dormant enemies ready to be reused */
+	UPROPERTY()
+	TArray<TObjectPtr<ACombatEnemy>> FreeEnemies;
+};
+
+/**
+ *  Per-class pool of combat enemies.
+ *  Dead enemies are released back into the pool instead of being destroyed,
+ *  and spawners acquire them back instead of constructing a new actor, controller and StateTree.
+ */
+UCLASS()
+class UCombatEnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Free enemies, by class */
+	UPROPERTY()
+	TMap<TSubclassOf<ACombatEnemy>, FCombatEnemyPoolList> Pools;
+
+public:
+
+	/** Returns the enemy pool for the world the provided object lives in, if any */
+	static UCombatEnemyPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Returns true if enemies should be pooled. Can be toggled with Combat.EnemyPool.Enable */
+	static bool IsPoolingEnabled();
+
+	/** Makes sure at least Count free enemies of the provided class are waiting in the pool */
+	void Prewarm(TSubclassOf<ACombatEnemy> EnemyClass, int32 Count, const FTransform& ParkingTransform);
+
+	/**
+	 *  Returns a live enemy of the provided class at the provided transform.
+	 *  Reuses a pooled enemy if one is available, otherwise spawns a new one.
+	 *  If bAdjustSpawnLocation is false, the transform is assumed to be already clear of encroaching geometry.
+	 */
+	ACombatEnemy* AcquireEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, bool bAdjustSpawnLocation = true);
+
+	/** Returns an enemy to the pool. Destroys it instead if pooling is disabled */
+	void ReleaseEnemy(ACombatEnemy* Enemy);
+
+	/** Takes a specific free enemy out of the pool without waking it up, e.g. so a snapshot restore can put it back in play */
+	void RemoveFromPool(ACombatEnemy* Enemy);
+
+	/** Returns the number of free enemies of the provided class */
+	int32 GetNumFree(TSubclassOf<ACombatEnemy> EnemyClass) const;
+
+protected:
+
+	/** Only create the pool for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Spawns a brand new enemy */
+	ACombatEnemy* SpawnEnemy(TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, bool bAdjustSpawnLocation = true) const;
+};
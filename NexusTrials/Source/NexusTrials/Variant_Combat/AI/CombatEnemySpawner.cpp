@@ -8,6 +8,9 @@
 #include "Components/ArrowComponent.h"
 #include "TimerManager.h"
 #include "CombatEnemy.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatSpawnSchedulerSubsystem.h"
+#include "CombatSnapshotSubsystem.h"
 
 ACombatEnemySpawner::ACombatEnemySpawner()
 {
@@ -31,6 +34,18 @@ ACombatEnemySpawner::ACombatEnemySpawner()
 void ACombatEnemySpawner::BeginPlay()
 {
 	Super::BeginPlay();
+
+	// create our enemies up front so the spawn itself is just a reactivation
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
+	{
+		Pool->Prewarm(EnemyClass, FMath::Min(PoolPrewarmCount, SpawnCount), SpawnCapsule->GetComponentTransform());
+	}
+
+	// save our progress with the arena snapshot
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
 	
 	// should we spawn an enemy right away?
 	if (bShouldSpawnEnemiesImmediately)
@@ -47,30 +62,73 @@ void ACombatEnemySpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
 
 	// clear the spawn timer
 	GetWorld()->GetTimerManager().ClearTimer(SpawnTimer);
+
+	// drop any spawn we still have queued
+	if (UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this))
+	{
+		Scheduler->CancelSpawns(this);
+	}
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
 }
 
 void ACombatEnemySpawner::SpawnEnemy()
 {
 	// ensure the enemy class is valid
-	if (IsValid(EnemyClass))
+	if (!IsValid(EnemyClass))
+	{
+		return;
+	}
+
+	// let the scheduler spread the spawn out in case other spawners are activating on the same frame
+	if (UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this))
+	{
+		Scheduler->QueueSpawn(this, EnemyClass, SpawnCapsule->GetComponentTransform(), FOnCombatEnemySpawned::CreateUObject(this, &ACombatEnemySpawner::OnEnemySpawned));
+		return;
+	}
+
+	ACombatEnemy* SpawnedEnemy = nullptr;
+
+	// reuse a pooled enemy at the reference capsule's transform if we can
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
 	{
+		SpawnedEnemy = Pool->AcquireEnemy(EnemyClass, SpawnCapsule->GetComponentTransform());
+
+	} else {
+
 		// spawn the enemy at the reference capsule's transform
 		FActorSpawnParameters SpawnParams;
 		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-		ACombatEnemy* SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
+		SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(EnemyClass, SpawnCapsule->GetComponentTransform(), SpawnParams);
+	}
 
-		// was the enemy successfully created?
-		if (SpawnedEnemy)
-		{
-			// subscribe to the death delegate
-			SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
-		}
+	OnEnemySpawned(SpawnedEnemy);
+}
+
+void ACombatEnemySpawner::OnEnemySpawned(ACombatEnemy* SpawnedEnemy)
+{
+	// was the enemy successfully created?
+	if (SpawnedEnemy)
+	{
+		CurrentEnemy = SpawnedEnemy;
+
+		// subscribe to the death delegate
+		SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+		return;
 	}
+
+	// a failed spawn counts as a spent enemy, so we schedule the next one or deplete instead of stalling
+	OnEnemyDied();
 }
 
 void ACombatEnemySpawner::OnEnemyDied()
 {
+	CurrentEnemy.Reset();
+
 	// decrease the spawn counter
 	--SpawnCount;
 
@@ -124,3 +182,67 @@ void ACombatEnemySpawner::DeactivateInteraction(AActor* ActivationInstigator)
 {
 	// stub
 }
+
+void ACombatEnemySpawner::SerializeSnapshot(FArchive& Ar)
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this);
+
+	// a spawn still waiting in the scheduler is saved as a spawn timer that's about to fire
+	float SpawnTimerRemaining = TimerManager.GetTimerRemaining(SpawnTimer);
+
+	if (Ar.IsSaving() && Scheduler && Scheduler->GetNumPendingSpawns(this) > 0)
+	{
+		SpawnTimerRemaining = 0.0f;
+	}
+
+	bool bHadEnemy = CurrentEnemy.IsValid();
+
+	Ar << SpawnCount;
+	Ar << bHasBeenActivated;
+	Ar << bHadEnemy;
+	Ar << CurrentEnemy;
+	Ar << SpawnTimerRemaining;
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	// drop whatever we were about to do
+	TimerManager.ClearTimer(SpawnTimer);
+
+	if (Scheduler)
+	{
+		Scheduler->CancelSpawns(this);
+	}
+
+	// timers never fire during the restore, so we don't take enemies from the pool before they're all back in place
+	if (SpawnTimerRemaining >= 0.0f)
+	{
+		if (SpawnCount > 0)
+		{
+			TimerManager.SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnEnemy, FMath::Max(SpawnTimerRemaining, UE_KINDA_SMALL_NUMBER));
+
+		} else {
+
+			TimerManager.SetTimer(SpawnTimer, this, &ACombatEnemySpawner::SpawnerDepleted, FMath::Max(SpawnTimerRemaining, UE_KINDA_SMALL_NUMBER));
+		}
+	}
+
+	// our enemy was destroyed since the capture and can't come back, so count it as killed
+	if (bHadEnemy && !CurrentEnemy.IsValid())
+	{
+		OnEnemyDied();
+	}
+}
+
+void ACombatEnemySpawner::PostSnapshotRestore()
+{
+	ACombatEnemy* Enemy = CurrentEnemy.Get();
+
+	if (Enemy && Enemy->IsAlive())
+	{
+		Enemy->OnEnemyDied.AddUniqueDynamic(this, &ACombatEnemySpawner::OnEnemyDied);
+	}
+}
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CombatActivatable.h"
+#include "CombatSnapshotable.h"
 #include "CombatEnemySpawner.generated.h"
 
 class UCapsuleComponent;
@@ -16,9 +17,10 @@ class ACombatEnemy;
  *  Enemies will be spawned one by one, and the spawner will wait until the enemy dies before spawning a new one.
  *  The spawner can be remotely activated through the ICombatActivatable interface
  *  When the last spawned enemy dies, the spawner can also activate other ICombatActivatables
+ *  Its progress is saved in arena snapshots through the ICombatSnapshotable interface
  */
 UCLASS(abstract)
-class ACombatEnemySpawner : public AActor, public ICombatActivatable
+class ACombatEnemySpawner : public AActor, public ICombatActivatable, public ICombatSnapshotable
 {
 	GENERATED_BODY()
 	
@@ -50,6 +52,10 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Enemy Spawner", meta = (ClampMin = 0, ClampMax = 10))
 	float RespawnDelay = 5.0f;
 
+	/** Number of enemies to create up front and park in the enemy pool, so spawning them later doesn't hitch */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Enemy Spawner", meta = (ClampMin = 0, ClampMax = 100))
+	int32 PoolPrewarmCount = 1;
+
 	/** Time to wait after this spawner is depleted before activating the actor list */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation", meta = (ClampMin = 0, ClampMax = 10))
 	float ActivationDelay = 1.0f;
@@ -64,6 +70,9 @@ protected:
 	/** Timer to spawn enemies after a delay */
 	FTimerHandle SpawnTimer;
 
+	/** Enemy we spawned that's still alive */
+	TWeakObjectPtr<ACombatEnemy> CurrentEnemy;
+
 public:	
 	
 	/** Constructor */
@@ -79,9 +88,12 @@ public:
 
 protected:
 
-	/** Spawn an enemy and subscribe to its death event */
+	/** Queue an enemy spawn with the spawn scheduler */
 	void SpawnEnemy();
 
+	/** Called when the queued enemy has been spawned, to subscribe to its death event. A null enemy counts as a spent spawn */
+	void OnEnemySpawned(ACombatEnemy* SpawnedEnemy);
+
 	/** Called when the spawned enemy has died */
 	UFUNCTION()
 	void OnEnemyDied();
@@ -106,4 +118,14 @@ public:
 	virtual void DeactivateInteraction(AActor* ActivationInstigator) override;
 
 	// ~end IActivatable interface
+
+	// ~begin ICombatSnapshotable interface
+
+	/** Saves or restores the spawn counter, activation, current enemy and pending spawn */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	/** Subscribes to the restored enemy's death again */
+	virtual void PostSnapshotRestore() override;
+
+	// ~end ICombatSnapshotable interface
 };
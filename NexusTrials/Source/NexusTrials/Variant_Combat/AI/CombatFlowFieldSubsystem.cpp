@@ -0,0 +1,619 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatFlowFieldSubsystem.h"
+#include "AIController.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Navigation/PathFollowingComponent.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field"), STAT_CombatFlowField, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Flow Field Build"), STAT_CombatFlowFieldBuild, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Flow Field Nav Sampling"), STAT_CombatFlowFieldSampling, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Chasers"), STAT_CombatFlowFieldFollowers, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Pathing Chasers"), STAT_CombatFlowFieldPathing, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Cached Nav Samples"), STAT_CombatFlowFieldSamples, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Flow Field Builds"), STAT_CombatFlowFieldBuilds, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarFlowFieldEnabled(
+	TEXT("Combat.FlowField.Enable"),
+	true,
+	TEXT("If true, enemies chasing a target are steered by a shared flow field. If false, every chaser runs its own pathfinding."));
+
+namespace CombatFlowField
+{
+	/** Neighbor offsets. Opposite directions sit next to each other, so flipping the low bit reverses a direction */
+	static const FIntPoint Offsets[8] =
+	{
+		FIntPoint(1, 0), FIntPoint(-1, 0),
+		FIntPoint(0, 1), FIntPoint(0, -1),
+		FIntPoint(1, 1), FIntPoint(-1, -1),
+		FIntPoint(1, -1), FIntPoint(-1, 1)
+	};
+
+	/** Integration cost of each neighbor step. Diagonals cost roughly sqrt(2) times more */
+	static const uint32 StepCosts[8] = { 10, 10, 10, 10, 14, 14, 14, 14 };
+
+	/** Open list node for the integration pass */
+	struct FOpenNode
+	{
+		uint32 Cost;
+		int32 Index;
+	};
+}
+
+UCombatFlowFieldSubsystem* UCombatFlowFieldSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatFlowFieldSubsystem>() : nullptr;
+}
+
+bool UCombatFlowFieldSubsystem::IsFlowFieldEnabled()
+{
+	return CVarFlowFieldEnabled.GetValueOnGameThread();
+}
+
+bool UCombatFlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatFlowFieldSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// tickable subsystems run after the tick groups, which would leave our movement input for the next frame's movement update
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &UCombatFlowFieldSubsystem::OnWorldPreActorTick);
+}
+
+void UCombatFlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// cached samples go stale whenever the navmesh is rebuilt
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &UCombatFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+}
+
+void UCombatFlowFieldSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+
+	// hand every chaser's movement back to its controller
+	for (FFollower& Follower : Followers)
+	{
+		if (Follower.bPathing)
+		{
+			StopPathing(Follower);
+		}
+	}
+
+	Followers.Reset();
+	Fields.Reset();
+	NavSamples.Reset();
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.RemoveDynamic(this, &UCombatFlowFieldSubsystem::OnNavigationGenerationFinished);
+	}
+
+	Super::Deinitialize();
+}
+
+void UCombatFlowFieldSubsystem::StartFollowing(AAIController* Controller, AActor* Target, float AcceptanceRadius)
+{
+	if (!IsValid(Controller) || !IsValid(Target))
+	{
+		return;
+	}
+
+	// update the target if the controller is already chasing something
+	for (FFollower& Follower : Followers)
+	{
+		if (Follower.Controller.Get() == Controller)
+		{
+			if (Follower.Target.Get() != Target && Follower.bPathing)
+			{
+				StopPathing(Follower);
+			}
+
+			Follower.Target = Target;
+			Follower.AcceptanceRadius = AcceptanceRadius;
+			return;
+		}
+	}
+
+	FFollower& Follower = Followers.AddDefaulted_GetRef();
+	Follower.Controller = Controller;
+	Follower.Target = Target;
+	Follower.AcceptanceRadius = AcceptanceRadius;
+}
+
+void UCombatFlowFieldSubsystem::StopFollowing(AAIController* Controller)
+{
+	for (int32 Index = 0; Index < Followers.Num(); ++Index)
+	{
+		if (Followers[Index].Controller.Get() == Controller)
+		{
+			if (Followers[Index].bPathing)
+			{
+				StopPathing(Followers[Index]);
+			}
+
+			Followers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			return;
+		}
+	}
+}
+
+bool UCombatFlowFieldSubsystem::SampleDirection(const AActor* Target, const FVector& Location, FVector& OutDirection) const
+{
+	if (!Target)
+	{
+		return false;
+	}
+
+	for (const FFlowField& Field : Fields)
+	{
+		if (Field.Target.Get() != Target)
+		{
+			continue;
+		}
+
+		if (!Field.bBuilt)
+		{
+			return false;
+		}
+
+		// is the location inside the field's window?
+		const FIntPoint Cell = GetCell(Location);
+		const FIntPoint LocalCell = Cell - Field.Origin;
+
+		if (LocalCell.X < 0 || LocalCell.Y < 0 || LocalCell.X >= FieldCells || LocalCell.Y >= FieldCells)
+		{
+			return false;
+		}
+
+		const int32 CellIndex = LocalCell.Y * FieldCells + LocalCell.X;
+		const uint8 Direction = Field.Directions[CellIndex];
+
+		// skip unreachable cells and cells on another floor
+		if (Direction == NoDirection || FMath::Abs(Location.Z - Field.Heights[CellIndex]) > NavSampleHeight)
+		{
+			return false;
+		}
+
+		// steer towards the next cell's center so chasers don't cut corners
+		const FIntPoint NextCell = Cell + CombatFlowField::Offsets[Direction];
+		const FVector NextLocation((NextCell.X + 0.5f) * CellSize, (NextCell.Y + 0.5f) * CellSize, Location.Z);
+
+		OutDirection = (NextLocation - Location).GetSafeNormal2D();
+
+		return !OutDirection.IsNearlyZero();
+	}
+
+	return false;
+}
+
+int32 UCombatFlowFieldSubsystem::GetNumFollowingField() const
+{
+	return Followers.Num() - GetNumPathing();
+}
+
+int32 UCombatFlowFieldSubsystem::GetNumPathing() const
+{
+	int32 NumPathing = 0;
+
+	for (const FFollower& Follower : Followers)
+	{
+		if (Follower.bPathing)
+		{
+			++NumPathing;
+		}
+	}
+
+	return NumPathing;
+}
+
+TStatId UCombatFlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatFlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatFlowFieldSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlowField);
+
+	if (Followers.IsEmpty())
+	{
+		return;
+	}
+
+	// fields built here are followed from the next frame's pre actor tick
+	if (IsFlowFieldEnabled())
+	{
+		UpdateFields();
+	}
+
+	SET_DWORD_STAT(STAT_CombatFlowFieldFollowers, Followers.Num());
+	SET_DWORD_STAT(STAT_CombatFlowFieldPathing, GetNumPathing());
+	SET_DWORD_STAT(STAT_CombatFlowFieldSamples, NavSamples.Num());
+}
+
+void UCombatFlowFieldSubsystem::OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds)
+{
+	if (InWorld != GetWorld() || InWorld->IsPaused() || Followers.IsEmpty())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlowField);
+
+	UpdateFollowers(DeltaSeconds);
+}
+
+FIntPoint UCombatFlowFieldSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UCombatFlowFieldSubsystem::UpdateFields()
+{
+	// drop fields for targets nobody is chasing anymore
+	for (int32 FieldIndex = Fields.Num() - 1; FieldIndex >= 0; --FieldIndex)
+	{
+		const AActor* Target = Fields[FieldIndex].Target.Get();
+
+		const bool bChased = Target && Followers.ContainsByPredicate([Target](const FFollower& Follower)
+		{
+			return Follower.Target.Get() == Target;
+		});
+
+		if (!bChased)
+		{
+			Fields.RemoveAtSwap(FieldIndex, 1, EAllowShrinking::No);
+		}
+	}
+
+	// add fields for new targets
+	for (const FFollower& Follower : Followers)
+	{
+		AActor* Target = Follower.Target.Get();
+
+		if (!Target)
+		{
+			continue;
+		}
+
+		const bool bHasField = Fields.ContainsByPredicate([Target](const FFlowField& Field)
+		{
+			return Field.Target.Get() == Target;
+		});
+
+		if (!bHasField)
+		{
+			FFlowField& Field = Fields.AddDefaulted_GetRef();
+			Field.Target = Target;
+		}
+	}
+
+	if (Fields.IsEmpty())
+	{
+		return;
+	}
+
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	if (!NavData)
+	{
+		return;
+	}
+
+	// keep the sample cache bounded on large maps
+	if (NavSamples.Num() > MaxCachedSamples)
+	{
+		NavSamples.Reset();
+	}
+
+	const double TimeSeconds = GetWorld()->GetTimeSeconds();
+	int32 SampleBudget = NavSamplesPerFrame;
+
+	// rebuild at most one field per frame, round-robin so every target gets its turn
+	for (int32 Step = 0; Step < Fields.Num(); ++Step)
+	{
+		const int32 FieldIndex = (NextFieldIndex + Step) % Fields.Num();
+		FFlowField& Field = Fields[FieldIndex];
+
+		const FVector TargetLocation = Field.Target->GetActorLocation();
+		const bool bTargetMoved = GetCell(TargetLocation) != Field.TargetCell;
+
+		const bool bNeedsRebuild = !Field.bBuilt || Field.bDirty || (bTargetMoved && TimeSeconds - Field.BuildTime >= RebuildInterval);
+
+		if (!bNeedsRebuild)
+		{
+			continue;
+		}
+
+		// fill in the grid over a few frames before building if the target moved into unsampled space
+		if (SampleField(Field, TargetLocation, NavData, SampleBudget))
+		{
+			BuildField(Field, TargetLocation);
+			Field.BuildTime = TimeSeconds;
+			Field.bBuilt = true;
+			Field.bDirty = false;
+
+			NextFieldIndex = FieldIndex + 1;
+		}
+
+		break;
+	}
+}
+
+bool UCombatFlowFieldSubsystem::SampleField(const FFlowField& Field, const FVector& TargetLocation, ANavigationData* NavData, int32& InOutBudget)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlowFieldSampling);
+
+	const FIntPoint Origin = GetCell(TargetLocation) - FIntPoint(FieldCells / 2, FieldCells / 2);
+
+	// keep the sample footprint inside the cell so each sample describes its own cell
+	const FVector Extent(CellSize * 0.25f, CellSize * 0.25f, NavSampleHeight);
+
+	for (int32 Y = 0; Y < FieldCells; ++Y)
+	{
+		for (int32 X = 0; X < FieldCells; ++X)
+		{
+			const FIntPoint Cell = Origin + FIntPoint(X, Y);
+
+			if (NavSamples.Contains(Cell))
+			{
+				continue;
+			}
+
+			if (InOutBudget <= 0)
+			{
+				return false;
+			}
+
+			--InOutBudget;
+
+			// the grid is 2.5D, sampled around the target's height
+			const FVector CellCenter((Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, TargetLocation.Z);
+
+			FNavLocation NavLocation;
+			FNavSample& Sample = NavSamples.Add(Cell);
+			Sample.bWalkable = NavData->ProjectPoint(CellCenter, NavLocation, Extent);
+			Sample.Z = Sample.bWalkable ? NavLocation.Location.Z : TargetLocation.Z;
+		}
+	}
+
+	return true;
+}
+
+void UCombatFlowFieldSubsystem::BuildField(FFlowField& Field, const FVector& TargetLocation)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatFlowFieldBuild);
+	INC_DWORD_STAT(STAT_CombatFlowFieldBuilds);
+
+	const int32 NumCells = FieldCells * FieldCells;
+
+	Field.TargetCell = GetCell(TargetLocation);
+	Field.Origin = Field.TargetCell - FIntPoint(FieldCells / 2, FieldCells / 2);
+
+	Field.Directions.Init(NoDirection, NumCells);
+	Field.Heights.SetNumUninitialized(NumCells);
+
+	// copy the cached samples into the window
+	TBitArray<> Walkable(false, NumCells);
+
+	for (int32 Y = 0; Y < FieldCells; ++Y)
+	{
+		for (int32 X = 0; X < FieldCells; ++X)
+		{
+			const int32 CellIndex = Y * FieldCells + X;
+			const FNavSample& Sample = NavSamples.FindChecked(Field.Origin + FIntPoint(X, Y));
+
+			Walkable[CellIndex] = Sample.bWalkable;
+			Field.Heights[CellIndex] = Sample.Z;
+		}
+	}
+
+	// the target's cell is always the goal, even if the target is off the navmesh
+	const FIntPoint TargetLocalCell = Field.TargetCell - Field.Origin;
+	const int32 TargetIndex = TargetLocalCell.Y * FieldCells + TargetLocalCell.X;
+
+	Walkable[TargetIndex] = true;
+
+	TArray<uint32> Costs;
+	Costs.Init(MAX_uint32, NumCells);
+	Costs[TargetIndex] = 0;
+
+	TArray<CombatFlowField::FOpenNode> OpenList;
+	OpenList.Reserve(NumCells / 4);
+	OpenList.Add({ 0, TargetIndex });
+
+	const auto CheapestFirst = [](const CombatFlowField::FOpenNode& A, const CombatFlowField::FOpenNode& B)
+	{
+		return A.Cost < B.Cost;
+	};
+
+	// integrate outwards from the target. Every reached cell points back at the neighbor it was reached from
+	while (!OpenList.IsEmpty())
+	{
+		CombatFlowField::FOpenNode Node;
+		OpenList.HeapPop(Node, CheapestFirst, EAllowShrinking::No);
+
+		// skip nodes that were improved after they were pushed
+		if (Node.Cost > Costs[Node.Index])
+		{
+			continue;
+		}
+
+		const int32 CellX = Node.Index % FieldCells;
+		const int32 CellY = Node.Index / FieldCells;
+
+		for (uint8 Direction = 0; Direction < 8; ++Direction)
+		{
+			const FIntPoint& Offset = CombatFlowField::Offsets[Direction];
+			const int32 NeighborX = CellX + Offset.X;
+			const int32 NeighborY = CellY + Offset.Y;
+
+			if (NeighborX < 0 || NeighborY < 0 || NeighborX >= FieldCells || NeighborY >= FieldCells)
+			{
+				continue;
+			}
+
+			const int32 NeighborIndex = NeighborY * FieldCells + NeighborX;
+
+			if (!Walkable[NeighborIndex] || FMath::Abs(Field.Heights[NeighborIndex] - Field.Heights[Node.Index]) > MaxStepHeight)
+			{
+				continue;
+			}
+
+			// diagonals can't cut around blocked corners
+			if (Offset.X != 0 && Offset.Y != 0)
+			{
+				if (!Walkable[CellY * FieldCells + NeighborX] || !Walkable[NeighborY * FieldCells + CellX])
+				{
+					continue;
+				}
+			}
+
+			const uint32 NewCost = Node.Cost + CombatFlowField::StepCosts[Direction];
+
+			if (NewCost < Costs[NeighborIndex])
+			{
+				Costs[NeighborIndex] = NewCost;
+
+				// the neighbor flows back the way we came
+				Field.Directions[NeighborIndex] = Direction ^ 1;
+
+				OpenList.HeapPush({ NewCost, NeighborIndex }, CheapestFirst);
+			}
+		}
+	}
+}
+
+void UCombatFlowFieldSubsystem::UpdateFollowers(float DeltaTime)
+{
+	const double TimeSeconds = GetWorld()->GetTimeSeconds();
+	const bool bFieldEnabled = IsFlowFieldEnabled();
+
+	for (int32 Index = Followers.Num() - 1; Index >= 0; --Index)
+	{
+		FFollower& Follower = Followers[Index];
+
+		AAIController* Controller = Follower.Controller.Get();
+
+		// drop chasers whose controller went away
+		if (!Controller)
+		{
+			Followers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		APawn* Pawn = Controller->GetPawn();
+		const AActor* Target = Follower.Target.Get();
+
+		if (!Pawn || !Target)
+		{
+			continue;
+		}
+
+		const FVector PawnLocation = Pawn->GetActorLocation();
+
+		// use regular pathfinding for the final approach, after getting stuck, or when there's no usable field
+		FVector Direction;
+
+		const bool bUsePath = !bFieldEnabled
+			|| FVector::DistSquared2D(PawnLocation, Target->GetActorLocation()) <= FMath::Square(DirectPathDistance)
+			|| TimeSeconds < Follower.PathUntil
+			|| !SampleDirection(Target, PawnLocation, Direction);
+
+		if (bUsePath)
+		{
+			StartPathing(Follower);
+			continue;
+		}
+
+		if (Follower.bPathing)
+		{
+			StopPathing(Follower);
+		}
+
+		// movement input is consumed by the pawn's movement component later this frame, in the pre physics tick group
+		Pawn->AddMovementInput(Direction);
+
+		// fall back to pathfinding for a while if the field leads us into something we can't get past
+		if (Pawn->GetVelocity().SizeSquared2D() < FMath::Square(StuckSpeed))
+		{
+			Follower.StuckTimer += DeltaTime;
+
+			if (Follower.StuckTimer >= StuckTime)
+			{
+				Follower.StuckTimer = 0.0f;
+				Follower.PathUntil = TimeSeconds + StuckPathTime;
+
+				StartPathing(Follower);
+			}
+
+		} else {
+
+			Follower.StuckTimer = 0.0f;
+		}
+	}
+}
+
+void UCombatFlowFieldSubsystem::StartPathing(FFollower& Follower) const
+{
+	AAIController* Controller = Follower.Controller.Get();
+	AActor* Target = Follower.Target.Get();
+	const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+
+	if (!Pawn || !Target)
+	{
+		return;
+	}
+
+	// the move keeps tracking the target, so only request it again if it ended
+	if (Follower.bPathing && Controller->GetMoveStatus() != EPathFollowingStatus::Idle)
+	{
+		return;
+	}
+
+	// don't keep requesting moves once we've arrived
+	if (Follower.bPathing && FVector::DistSquared2D(Pawn->GetActorLocation(), Target->GetActorLocation()) <= FMath::Square(Follower.AcceptanceRadius))
+	{
+		return;
+	}
+
+	Controller->MoveToActor(Target, Follower.AcceptanceRadius);
+	Follower.bPathing = true;
+}
+
+void UCombatFlowFieldSubsystem::StopPathing(FFollower& Follower) const
+{
+	if (AAIController* Controller = Follower.Controller.Get())
+	{
+		Controller->StopMovement();
+	}
+
+	Follower.bPathing = false;
+}
+
+void UCombatFlowFieldSubsystem::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	NavSamples.Reset();
+
+	// keep steering by the old fields until they're rebuilt
+	for (FFlowField& Field : Fields)
+	{
+		Field.bDirty = true;
+	}
+}
@@ -0,0 +1,212 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFlowFieldSubsystem.generated.h"
+
+class AAIController;
+class ANavigationData;
+
+/**
+ *  Flow field navigation for enemy swarms.
+ *  Builds an integration field on a grid derived from the navmesh around every actor that's being chased,
+ *  and steers the chasers along it with one cell lookup each per frame instead of a path query each.
+ *  Chasers fall back to regular pathfinding close to their target, outside the field, or when they get stuck.
+ *  Fields are rebuilt at a throttled rate, at most one per frame, and navmesh samples are cached and spread across frames.
+ *  Chasers are steered ahead of the actor tick groups, so their movement components consume the input in the same frame.
+ */
+UCLASS(Config=Game)
+class UCombatFlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the flow field subsystem for the world the provided object lives in, if any */
+	static UCombatFlowFieldSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Returns true if chasers are steered by flow fields. If false, they always use regular pathfinding */
+	static bool IsFlowFieldEnabled();
+
+	/**
+	 *  Starts steering the controller's pawn towards the target. Calling it again updates the target
+	 *  @param AcceptanceRadius Radius used for the pathfinding fallback
+	 */
+	void StartFollowing(AAIController* Controller, AActor* Target, float AcceptanceRadius);
+
+	/** Stops steering the controller's pawn and stops any fallback path */
+	void StopFollowing(AAIController* Controller);
+
+	/** Samples the flow direction towards the target at the provided location. Returns false if there is no usable field there */
+	bool SampleDirection(const AActor* Target, const FVector& Location, FVector& OutDirection) const;
+
+	/** Returns the number of chasers currently steered by a field */
+	int32 GetNumFollowingField() const;
+
+	/** Returns the number of chasers currently using regular pathfinding */
+	int32 GetNumPathing() const;
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Start steering chasers ahead of the actor tick groups */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Listen for navmesh rebuilds */
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	/** Stop every chaser and stop listening for navmesh rebuilds and world ticks */
+	virtual void Deinitialize() override;
+
+	/** Size of each grid cell */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 50, Units = "cm"))
+	float CellSize = 150.0f;
+
+	/** Number of cells on each side of a field. Fields are centered on their target */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 8, ClampMax = 256))
+	int32 FieldCells = 96;
+
+	/** Time between rebuilds of the same field */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0.05, ClampMax = 5, Units = "s"))
+	float RebuildInterval = 0.25f;
+
+	/** Max number of navmesh samples taken per frame while filling in the grid */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 16))
+	int32 NavSamplesPerFrame = 1024;
+
+	/** Max height difference between neighboring cells for them to connect */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "cm"))
+	float MaxStepHeight = 60.0f;
+
+	/** Vertical distance to look for the navmesh above and below the target */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "cm"))
+	float NavSampleHeight = 300.0f;
+
+	/** Chasers closer than this to their target use regular pathfinding for the final approach */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "cm"))
+	float DirectPathDistance = 600.0f;
+
+	/** Chasers moving slower than this while steered by a field are considered stuck */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "cm/s"))
+	float StuckSpeed = 20.0f;
+
+	/** Time a chaser can be stuck before it falls back to pathfinding */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "s"))
+	float StuckTime = 0.75f;
+
+	/** Time a stuck chaser keeps pathfinding before trying the field again */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 0, Units = "s"))
+	float StuckPathTime = 2.0f;
+
+	/** Max number of cached navmesh samples before the cache is cleared */
+	UPROPERTY(Config, EditAnywhere, Category="Flow Field", meta = (ClampMin = 1024))
+	int32 MaxCachedSamples = 200000;
+
+	/** Navmesh sample for one world grid cell */
+	struct FNavSample
+	{
+		/** Height of the navmesh at the cell center */
+		float Z = 0.0f;
+
+		/** True if the navmesh covers the cell center */
+		bool bWalkable = false;
+	};
+
+	/** Integration field towards one target */
+	struct FFlowField
+	{
+		TWeakObjectPtr<AActor> Target;
+
+		/** World cell at the field's minimum corner */
+		FIntPoint Origin = FIntPoint::ZeroValue;
+
+		/** Target cell the field was built towards */
+		FIntPoint TargetCell = FIntPoint::ZeroValue;
+
+		/** Per-cell direction index into the neighbor table, or NoDirection */
+		TArray<uint8> Directions;
+
+		/** Per-cell navmesh height, so chasers on another floor don't steer by the wrong cell */
+		TArray<float> Heights;
+
+		/** Game time the field was last built */
+		double BuildTime = -1000.0;
+
+		/** True once the field has been built at least once */
+		bool bBuilt = false;
+
+		/** True if the navmesh changed since the field was built */
+		bool bDirty = false;
+	};
+
+	/** Chaser bookkeeping */
+	struct FFollower
+	{
+		TWeakObjectPtr<AAIController> Controller;
+		TWeakObjectPtr<AActor> Target;
+		float AcceptanceRadius = 0.0f;
+
+		/** Time spent stuck while steered by the field */
+		float StuckTimer = 0.0f;
+
+		/** Game time the chaser may go back to the field after getting stuck */
+		double PathUntil = -1000.0;
+
+		/** True while the chaser uses regular pathfinding */
+		bool bPathing = false;
+	};
+
+	/** Direction index for cells without a way to the target */
+	static constexpr uint8 NoDirection = 0xFF;
+
+	/** Returns the world cell containing the provided location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Adds fields for new targets and drops fields nobody is chasing anymore */
+	void UpdateFields();
+
+	/** Samples the navmesh for cells of the field's window that aren't cached yet. Returns false if the budget ran out first */
+	bool SampleField(const FFlowField& Field, const FVector& TargetLocation, ANavigationData* NavData, int32& InOutBudget);
+
+	/** Rebuilds the integration field and per-cell directions towards the target */
+	void BuildField(FFlowField& Field, const FVector& TargetLocation);
+
+	/** Steers every chaser along its field, or hands it to pathfinding. Runs before the actor tick groups */
+	void OnWorldPreActorTick(UWorld* InWorld, ELevelTick TickType, float DeltaSeconds);
+
+	/** Steers every chaser along its field, or hands it to pathfinding */
+	void UpdateFollowers(float DeltaTime);
+
+	/** Switches a chaser to regular pathfinding towards its target */
+	void StartPathing(FFollower& Follower) const;
+
+	/** Switches a chaser back to field steering */
+	void StopPathing(FFollower& Follower) const;
+
+	/** Drops every cached navmesh sample and flags the fields for a rebuild after the navmesh changed */
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	/** Cached navmesh samples, by world cell */
+	TMap<FIntPoint, FNavSample> NavSamples;
+
+	/** Fields, one per chased target */
+	TArray<FFlowField> Fields;
+
+	/** Registered chasers */
+	TArray<FFollower> Followers;
+
+	/** Round-robin cursor into Fields for rebuilds */
+	int32 NextFieldIndex = 0;
+
+	FDelegateHandle PreActorTickHandle;
+};
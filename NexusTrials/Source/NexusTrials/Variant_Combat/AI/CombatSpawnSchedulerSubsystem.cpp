@@ -0,0 +1,255 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSpawnSchedulerSubsystem.h"
+#include "CombatEnemy.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatEncounterDirectorSubsystem.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Scheduler"), STAT_CombatSpawnScheduler, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Spawn Location Resolve"), STAT_CombatSpawnResolve, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Spawns"), STAT_CombatPendingSpawns, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Spawns This Frame"), STAT_CombatSpawnsThisFrame, STATGROUP_NexusTrials);
+
+UCombatSpawnSchedulerSubsystem* UCombatSpawnSchedulerSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatSpawnSchedulerSubsystem>() : nullptr;
+}
+
+bool UCombatSpawnSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatSpawnSchedulerSubsystem::QueueSpawn(const UObject* Requester, TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, FOnCombatEnemySpawned OnSpawned)
+{
+	if (!IsValid(EnemyClass))
+	{
+		return;
+	}
+
+	FPendingSpawn& Spawn = PendingSpawns.AddDefaulted_GetRef();
+	Spawn.Requester = Requester;
+	Spawn.EnemyClass = EnemyClass;
+	Spawn.SpawnTransform = SpawnTransform;
+	Spawn.OnSpawned = MoveTemp(OnSpawned);
+}
+
+void UCombatSpawnSchedulerSubsystem::CancelSpawns(const UObject* Requester)
+{
+	for (int32 Index = PendingSpawns.Num() - 1; Index >= 0; --Index)
+	{
+		if (PendingSpawns[Index].Requester.Get() == Requester)
+		{
+			// keep the resolved spawns packed at the front
+			if (Index < NumResolved)
+			{
+				--NumResolved;
+			}
+
+			PendingSpawns.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+}
+
+int32 UCombatSpawnSchedulerSubsystem::GetNumPendingSpawns(const UObject* Requester) const
+{
+	int32 NumSpawns = 0;
+
+	for (const FPendingSpawn& Spawn : PendingSpawns)
+	{
+		if (Spawn.Requester.Get() == Requester)
+		{
+			++NumSpawns;
+		}
+	}
+
+	return NumSpawns;
+}
+
+TStatId UCombatSpawnSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatSpawnSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatSpawnSchedulerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatSpawnScheduler);
+
+	if (PendingSpawns.Num() == 0)
+	{
+		SET_DWORD_STAT(STAT_CombatSpawnsThisFrame, 0);
+		SET_DWORD_STAT(STAT_CombatPendingSpawns, 0);
+		return;
+	}
+
+	// hold everything back while the encounter director is at its alive limit.
+	// Locations resolved now could be taken by the time the spawns go ahead, so resolve them again once they do
+	const UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(this);
+
+	if (Director && !Director->HasSpawnHeadroom())
+	{
+		NumResolved = 0;
+
+		SET_DWORD_STAT(STAT_CombatSpawnsThisFrame, 0);
+		SET_DWORD_STAT(STAT_CombatPendingSpawns, PendingSpawns.Num());
+		return;
+	}
+
+	const double EndTime = FPlatformTime::Seconds() + FrameBudgetMs * 0.001;
+	const int64 Frame = static_cast<int64>(GFrameCounter);
+
+	int32 NumSpawned = 0;
+	bool bDidWork = false;
+
+	// spawn enemies whose location was resolved on an earlier frame, so the resolve and spawn costs never stack up
+	while (NumResolved > 0 && PendingSpawns[0].ResolvedFrame < Frame)
+	{
+		if (bDidWork && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+
+		// stop once the alive limit is reached by this frame's spawns
+		if (Director && !Director->HasSpawnHeadroom())
+		{
+			break;
+		}
+
+		// take the spawn out of the queue first, since the spawned callback may queue or cancel other spawns
+		FPendingSpawn Spawn = MoveTemp(PendingSpawns[0]);
+		PendingSpawns.RemoveAt(0, 1, EAllowShrinking::No);
+		--NumResolved;
+
+		CarryOutSpawn(Spawn);
+		++NumSpawned;
+		bDidWork = true;
+	}
+
+	// spend what's left of the budget resolving locations ahead of time
+	while (NumResolved < PendingSpawns.Num())
+	{
+		if (bDidWork && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+
+		ResolveLocation(NumResolved);
+		PendingSpawns[NumResolved].ResolvedFrame = Frame;
+		++NumResolved;
+		bDidWork = true;
+	}
+
+	SET_DWORD_STAT(STAT_CombatSpawnsThisFrame, NumSpawned);
+	SET_DWORD_STAT(STAT_CombatPendingSpawns, PendingSpawns.Num());
+}
+
+void UCombatSpawnSchedulerSubsystem::ResolveLocation(int32 SpawnIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatSpawnResolve);
+
+	FPendingSpawn& Spawn = PendingSpawns[SpawnIndex];
+
+	// the class default object has the same capsule the spawned enemy will have, same as SpawnActor uses internally
+	const ACombatEnemy* Template = Spawn.EnemyClass->GetDefaultObject<ACombatEnemy>();
+
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+	Template->GetCapsuleComponent()->GetScaledCapsuleSize(Radius, HalfHeight);
+
+	FVector Location = Spawn.SpawnTransform.GetLocation();
+
+	for (int32 Attempt = 0; Attempt < MaxResolveAttempts; ++Attempt)
+	{
+		FVector SpawnLocation = Location;
+		FRotator SpawnRotation = Spawn.SpawnTransform.Rotator();
+
+		if (!GetWorld()->FindTeleportSpot(Template, SpawnLocation, SpawnRotation))
+		{
+			break;
+		}
+
+		Spawn.SpawnTransform.SetLocation(SpawnLocation);
+		Spawn.SpawnTransform.SetRotation(SpawnRotation.Quaternion());
+
+		// the teleport check can't see spots taken by queued spawns that haven't happened yet
+		const FPendingSpawn* Reserved = FindReservedSpot(SpawnIndex, SpawnLocation, Radius, HalfHeight);
+
+		if (!Reserved)
+		{
+			break;
+		}
+
+		// step just clear of the reserved spot, away from it, or around it if we're right on top of it
+		const FVector ReservedLocation = Reserved->SpawnTransform.GetLocation();
+		FVector Away = (SpawnLocation - ReservedLocation).GetSafeNormal2D();
+
+		if (Away.IsNearlyZero())
+		{
+			Away = FRotator(0.0f, 90.0f * Attempt, 0.0f).RotateVector(FVector::ForwardVector);
+		}
+
+		const float ReservedRadius = Reserved->EnemyClass->GetDefaultObject<ACombatEnemy>()->GetCapsuleComponent()->GetScaledCapsuleRadius();
+
+		Location = FVector(ReservedLocation.X, ReservedLocation.Y, SpawnLocation.Z) + Away * (Radius + ReservedRadius + 1.0f);
+	}
+}
+
+const UCombatSpawnSchedulerSubsystem::FPendingSpawn* UCombatSpawnSchedulerSubsystem::FindReservedSpot(int32 SpawnIndex, const FVector& Location, float Radius, float HalfHeight) const
+{
+	for (int32 Index = 0; Index < SpawnIndex; ++Index)
+	{
+		const FPendingSpawn& Reserved = PendingSpawns[Index];
+
+		// spawns that won't happen don't hold a spot
+		if (Reserved.Requester.IsStale())
+		{
+			continue;
+		}
+
+		float ReservedRadius = 0.0f;
+		float ReservedHalfHeight = 0.0f;
+		Reserved.EnemyClass->GetDefaultObject<ACombatEnemy>()->GetCapsuleComponent()->GetScaledCapsuleSize(ReservedRadius, ReservedHalfHeight);
+
+		const FVector Delta = Location - Reserved.SpawnTransform.GetLocation();
+
+		if (Delta.SizeSquared2D() < FMath::Square(Radius + ReservedRadius) && FMath::Abs(Delta.Z) < HalfHeight + ReservedHalfHeight)
+		{
+			return &Reserved;
+		}
+	}
+
+	return nullptr;
+}
+
+void UCombatSpawnSchedulerSubsystem::CarryOutSpawn(FPendingSpawn& Spawn) const
+{
+	// skip spawns whose requester went away without cancelling them
+	if (Spawn.Requester.IsStale())
+	{
+		return;
+	}
+
+	ACombatEnemy* SpawnedEnemy = nullptr;
+
+	// the location is already resolved, so skip the encroachment check on this frame
+	if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
+	{
+		SpawnedEnemy = Pool->AcquireEnemy(Spawn.EnemyClass, Spawn.SpawnTransform, false);
+
+	} else {
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		SpawnedEnemy = GetWorld()->SpawnActor<ACombatEnemy>(Spawn.EnemyClass, Spawn.SpawnTransform, SpawnParams);
+	}
+
+	// let the requester know even if the spawn failed, so it doesn't wait on it forever
+	Spawn.OnSpawned.ExecuteIfBound(SpawnedEnemy);
+}
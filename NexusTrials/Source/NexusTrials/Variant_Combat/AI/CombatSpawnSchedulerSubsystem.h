@@ -0,0 +1,92 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatSpawnSchedulerSubsystem.generated.h"
+
+class ACombatEnemy;
+
+/** Called when a queued enemy spawn has been carried out */
+DECLARE_DELEGATE_OneParam(FOnCombatEnemySpawned, ACombatEnemy*);
+
+/**
+ *  Spreads enemy spawns across frames.
+ *  Queued spawns first have their location resolved against encroaching geometry and the spots reserved by
+ *  other queued spawns, then get spawned on a later frame with the check skipped.
+ *  Both steps share a per-frame millisecond budget, so many spawners activating together don't cause a hitch.
+ *  Spawns are held in the queue while the encounter director has no headroom for more live enemies.
+ */
+UCLASS(Config=Game)
+class UCombatSpawnSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the spawn scheduler for the world the provided object lives in, if any */
+	static UCombatSpawnSchedulerSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 *  Queues an enemy spawn. OnSpawned runs on the frame the enemy is actually spawned, with nullptr if the spawn failed.
+	 *  Requester is used to cancel the pending spawns of an actor that goes away.
+	 */
+	void QueueSpawn(const UObject* Requester, TSubclassOf<ACombatEnemy> EnemyClass, const FTransform& SpawnTransform, FOnCombatEnemySpawned OnSpawned);
+
+	/** Drops all pending spawns queued by the provided requester */
+	void CancelSpawns(const UObject* Requester);
+
+	/** Returns the number of spawns still waiting to be carried out */
+	int32 GetNumPendingSpawns() const { return PendingSpawns.Num(); }
+
+	/** Returns the number of spawns queued by the provided requester that are still waiting to be carried out */
+	int32 GetNumPendingSpawns(const UObject* Requester) const;
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Only create the scheduler for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Time per frame spent resolving locations and spawning enemies. At least one step always runs per frame */
+	UPROPERTY(Config, EditAnywhere, Category="Spawning", meta = (ClampMin = 0, ClampMax = 33, Units = "ms"))
+	float FrameBudgetMs = 1.5f;
+
+	/** One queued spawn */
+	struct FPendingSpawn
+	{
+		TWeakObjectPtr<const UObject> Requester;
+		TSubclassOf<ACombatEnemy> EnemyClass;
+		FTransform SpawnTransform;
+		FOnCombatEnemySpawned OnSpawned;
+
+		/** Frame the location was resolved on, or INDEX_NONE while it's unresolved */
+		int64 ResolvedFrame = INDEX_NONE;
+	};
+
+	/**
+	 *  Finds an unencroached spot for a queued spawn using the class default object's collision.
+	 *  Also keeps clear of the spots resolved for the spawns queued before it, since those enemies don't exist yet
+	 */
+	void ResolveLocation(int32 SpawnIndex);
+
+	/** Returns the resolved spawn queued before SpawnIndex whose capsule would overlap a capsule at the provided location, if any */
+	const FPendingSpawn* FindReservedSpot(int32 SpawnIndex, const FVector& Location, float Radius, float HalfHeight) const;
+
+	/** Max number of times a spawn steps away from reserved spots before settling for an overlap */
+	static constexpr int32 MaxResolveAttempts = 4;
+
+	/** Spawns or reuses an enemy at an already resolved location */
+	void CarryOutSpawn(FPendingSpawn& Spawn) const;
+
+	/** Spawns in the order they were queued */
+	TArray<FPendingSpawn> PendingSpawns;
+
+	/** Index of the first spawn whose location hasn't been resolved yet */
+	int32 NumResolved = 0;
+};
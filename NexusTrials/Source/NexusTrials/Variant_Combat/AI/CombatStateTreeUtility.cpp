@@ -9,8 +9,13 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "AIController.h"
 #include "CombatEnemy.h"
-#include "Kismet/GameplayStatics.h"
+#include "CombatEncounterDirectorSubsystem.h"
 #include "StateTreeAsyncExecutionContext.h"
+#include "CombatFactionSubsystem.h"
+#include "CombatEQSCacheSubsystem.h"
+#include "CombatFlowFieldSubsystem.h"
+#include "EnvironmentQuery/EnvQuery.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
 
 bool FStateTreeCharacterGroundedCondition::TestCondition(FStateTreeExecutionContext& Context) const
 {
@@ -38,15 +43,13 @@ bool FStateTreeIsInDangerCondition::TestCondition(FStateTreeExecutionContext& Co
 	// ensure we have a valid enemy character
 	if (InstanceData.Character)
 	{
-		// is the last detected danger event within the reaction threshold?
+		// is the last danger event within the reaction threshold? Most of the time there's none and we stop here
 		const float ReactionDelta = InstanceData.Character->GetWorld()->GetTimeSeconds() - InstanceData.Character->GetLastDangerTime();
 
 		if (ReactionDelta < InstanceData.MaxReactionTime && ReactionDelta > InstanceData.MinReactionTime)
 		{
-			// do a dot product check to determine if the danger location is within the character's detection cone
-			const FVector DangerDir = (InstanceData.Character->GetLastDangerLocation() - InstanceData.Character->GetActorLocation()).GetSafeNormal2D();
-
-			const float DangerDot = FVector::DotProduct(DangerDir, InstanceData.Character->GetActorForwardVector());
+			// check the danger direction captured with the event against the character's detection cone
+			const float DangerDot = FVector::DotProduct(InstanceData.Character->GetLastDangerDirection(), InstanceData.Character->GetActorForwardVector());
 			const float ConeAngleCos = FMath::Cos(FMath::DegreesToRadians(InstanceData.DangerSightConeAngle));
 
 			return DangerDot > ConeAngleCos;
@@ -73,17 +76,27 @@ EStateTreeRunStatus FStateTreeComboAttackTask::EnterState(FStateTreeExecutionCon
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
+		// listen for our attack to finish
+		InstanceData.EventHandle = InstanceData.Character->OnCombatEvent.AddLambda(
+			[WeakContext = Context.MakeWeakExecutionContext()](const FCombatEnemyEvent& Event)
 			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				if (Event.Type == ECombatEnemyEvent::AttackFinished)
+				{
+					WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				}
 			}
 		);
 
 
-		// tell the character to do a combo attack
-		InstanceData.Character->DoAIComboAttack();
+		// tell the character to do a combo attack. Fail if the encounter director won't let us attack right now or the montage can't play
+		if (!InstanceData.Character->DoAIComboAttack())
+		{
+			// stop listening, we won't get an attack finished event
+			InstanceData.Character->OnCombatEvent.Remove(InstanceData.EventHandle);
+			InstanceData.EventHandle.Reset();
+
+			return EStateTreeRunStatus::Failed;
+		}
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -97,8 +110,15 @@ void FStateTreeComboAttackTask::ExitState(FStateTreeExecutionContext& Context, c
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.Unbind();
+		// stop listening for attack events
+		InstanceData.Character->OnCombatEvent.Remove(InstanceData.EventHandle);
+		InstanceData.EventHandle.Reset();
+
+		// give our attack token back in case we left the state before the attack montage ended
+		if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(InstanceData.Character))
+		{
+			Director->ReleaseAttackToken(InstanceData.Character);
+		}
 	}
 }
 
@@ -119,16 +139,26 @@ EStateTreeRunStatus FStateTreeChargedAttackTask::EnterState(FStateTreeExecutionC
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
+		// listen for our attack to finish
+		InstanceData.EventHandle = InstanceData.Character->OnCombatEvent.AddLambda(
+			[WeakContext = Context.MakeWeakExecutionContext()](const FCombatEnemyEvent& Event)
 			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				if (Event.Type == ECombatEnemyEvent::AttackFinished)
+				{
+					WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				}
 			}
 		);
 
-		// tell the character to do a charged attack
-		InstanceData.Character->DoAIChargedAttack();
+		// tell the character to do a charged attack. Fail if the encounter director won't let us attack right now or the montage can't play
+		if (!InstanceData.Character->DoAIChargedAttack())
+		{
+			// stop listening, we won't get an attack finished event
+			InstanceData.Character->OnCombatEvent.Remove(InstanceData.EventHandle);
+			InstanceData.EventHandle.Reset();
+
+			return EStateTreeRunStatus::Failed;
+		}
 	}
 
 	return EStateTreeRunStatus::Running;
@@ -142,8 +172,15 @@ void FStateTreeChargedAttackTask::ExitState(FStateTreeExecutionContext& Context,
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the on attack completed delegate
-		InstanceData.Character->OnAttackCompleted.Unbind();
+		// stop listening for attack events
+		InstanceData.Character->OnCombatEvent.Remove(InstanceData.EventHandle);
+		InstanceData.EventHandle.Reset();
+
+		// give our attack token back in case we left the state before the attack montage ended
+		if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(InstanceData.Character))
+		{
+			Director->ReleaseAttackToken(InstanceData.Character);
+		}
 	}
 }
 
@@ -164,11 +201,14 @@ EStateTreeRunStatus FStateTreeWaitForLandingTask::EnterState(FStateTreeExecution
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// bind to the on enemy landed delegate
-		InstanceData.Character->OnEnemyLanded.BindLambda(
-			[WeakContext = Context.MakeWeakExecutionContext()]()
+		// listen for the landing
+		InstanceData.EventHandle = InstanceData.Character->OnCombatEvent.AddLambda(
+			[WeakContext = Context.MakeWeakExecutionContext()](const FCombatEnemyEvent& Event)
 			{
-				WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				if (Event.Type == ECombatEnemyEvent::Landed)
+				{
+					WeakContext.FinishTask(EStateTreeFinishTaskType::Succeeded);
+				}
 			}
 		);
 	}
@@ -184,8 +224,9 @@ void FStateTreeWaitForLandingTask::ExitState(FStateTreeExecutionContext& Context
 		// get the instance data
 		FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-		// unbind the on enemy landed delegate
-		InstanceData.Character->OnEnemyLanded.Unbind();
+		// stop listening for the landing
+		InstanceData.Character->OnCombatEvent.Remove(InstanceData.EventHandle);
+		InstanceData.EventHandle.Reset();
 	}
 }
 
@@ -301,8 +342,37 @@ EStateTreeRunStatus FStateTreeGetPlayerInfoTask::Tick(FStateTreeExecutionContext
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// get the character possessed by the first local player
-	InstanceData.TargetPlayerCharacter = Cast<ACharacter>(UGameplayStatics::GetPlayerPawn(InstanceData.Character, 0));
+	// read our nearest hostile from the shared per-frame snapshot
+	if (const UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(InstanceData.Character))
+	{
+		FNexusTargetInfo TargetInfo;
+
+		if (TargetSnapshot->GetTargetInfo(InstanceData.Character, TargetInfo))
+		{
+			InstanceData.TargetPlayerCharacter = Cast<ACharacter>(TargetInfo.Target.Get());
+
+			// with nobody in range, keep heading for the last known location
+			if (InstanceData.TargetPlayerCharacter)
+			{
+				InstanceData.TargetPlayerLocation = TargetInfo.Location;
+				InstanceData.DistanceToTarget = TargetInfo.Distance;
+
+			} else {
+
+				InstanceData.DistanceToTarget = FVector::Distance(InstanceData.TargetPlayerLocation, InstanceData.Character->GetActorLocation());
+			}
+
+			return EStateTreeRunStatus::Running;
+		}
+
+		// we haven't picked a target yet, so search the snapshot directly
+		const uint32 HostileMask = UCombatFactionSubsystem::GetMatrix(InstanceData.Character).GetTargetMask(UCombatFactionSubsystem::GetActorFaction(InstanceData.Character));
+		InstanceData.TargetPlayerCharacter = Cast<ACharacter>(TargetSnapshot->FindNearestTarget(InstanceData.Character->GetActorLocation(), HostileMask, 0.0f, InstanceData.Character));
+
+	} else {
+
+		InstanceData.TargetPlayerCharacter = nullptr;
+	}
 
 	// do we have a valid target?
 	if (InstanceData.TargetPlayerCharacter)
@@ -322,4 +392,125 @@ FText FStateTreeGetPlayerInfoTask::GetDescription(const FGuid& ID, FStateTreeDat
 {
 	return FText::FromString("<b>Get Player Info</b>");
 }
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeRunCachedEnvQueryTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UCombatEQSCacheSubsystem* Cache = UCombatEQSCacheSubsystem::Get(InstanceData.Querier);
+
+	if (!Cache || !InstanceData.QueryTemplate)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// key the request on where we are and what we're asking about, so we keep polling the same query
+	InstanceData.CacheKey = Cache->MakeKey(InstanceData.QueryTemplate, InstanceData.RunMode, InstanceData.Querier, InstanceData.KeyContext);
+
+	return PollQuery(InstanceData);
+}
+
+EStateTreeRunStatus FStateTreeRunCachedEnvQueryTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	return PollQuery(Context.GetInstanceData(*this));
+}
+
+EStateTreeRunStatus FStateTreeRunCachedEnvQueryTask::PollQuery(FInstanceDataType& InstanceData) const
+{
+	UCombatEQSCacheSubsystem* Cache = UCombatEQSCacheSubsystem::Get(InstanceData.Querier);
+
+	if (!Cache)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	FCombatEQSResult Result;
+
+	if (Cache->RequestQuery(InstanceData.CacheKey, InstanceData.QueryTemplate, InstanceData.RunMode, InstanceData.Querier, Result) == ECombatEQSCacheStatus::Pending)
+	{
+		return EStateTreeRunStatus::Running;
+	}
+
+	if (!Result.bSuccess)
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// queries that return several items spread their requesters across them so a pack doesn't pile onto the same spot
+	const int32 ItemIndex = GetTypeHash(InstanceData.Querier.Get()) % Result.Locations.Num();
+
+	InstanceData.ResultLocation = Result.Locations[ItemIndex];
+	InstanceData.ResultActor = Result.Actors[ItemIndex].Get();
+
+	return EStateTreeRunStatus::Succeeded;
+}
+
+#if WITH_EDITOR
+FText FStateTreeRunCachedEnvQueryTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Run Cached Env Query</b>");
+}
+#endif // WITH_EDITOR
+
+////////////////////////////////////////////////////////////////////
+
+EStateTreeRunStatus FStateTreeFollowFlowFieldTask::EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	UCombatFlowFieldSubsystem* FlowField = UCombatFlowFieldSubsystem::Get(InstanceData.Controller);
+
+	if (!FlowField || !IsValid(InstanceData.Target))
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// hand our movement over to the flow field
+	FlowField->StartFollowing(InstanceData.Controller, InstanceData.Target, InstanceData.AcceptanceRadius);
+
+	return EStateTreeRunStatus::Running;
+}
+
+EStateTreeRunStatus FStateTreeFollowFlowFieldTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
+{
+	// get the instance data
+	const FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	const APawn* Pawn = InstanceData.Controller ? InstanceData.Controller->GetPawn() : nullptr;
+
+	if (!Pawn || !IsValid(InstanceData.Target))
+	{
+		return EStateTreeRunStatus::Failed;
+	}
+
+	// have we caught up with the target?
+	if (FVector::DistSquared2D(Pawn->GetActorLocation(), InstanceData.Target->GetActorLocation()) <= FMath::Square(InstanceData.AcceptanceRadius))
+	{
+		return EStateTreeRunStatus::Succeeded;
+	}
+
+	return EStateTreeRunStatus::Running;
+}
+
+void FStateTreeFollowFlowFieldTask::ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const
+{
+	// get the instance data
+	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
+
+	if (UCombatFlowFieldSubsystem* FlowField = UCombatFlowFieldSubsystem::Get(InstanceData.Controller))
+	{
+		FlowField->StopFollowing(InstanceData.Controller);
+	}
+}
+
+#if WITH_EDITOR
+FText FStateTreeFollowFlowFieldTask::GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting /*= EStateTreeNodeFormatting::Text*/) const
+{
+	return FText::FromString("<b>Follow Flow Field</b>");
+}
 #endif // WITH_EDITOR
\ No newline at end of file
@@ -5,12 +5,16 @@
 #include "CoreMinimal.h"
 #include "StateTreeTaskBase.h"
 #include "StateTreeConditionBase.h"
+#include "EnvironmentQuery/EnvQueryTypes.h"
+#include "CombatEQSCacheSubsystem.h"
 
 #include "CombatStateTreeUtility.generated.h"
 
 class ACharacter;
 class AAIController;
 class ACombatEnemy;
+class UEnvQuery;
+class UEnvQueryContext;
 
 /**
  *  Instance data struct for the FStateTreeCharacterGroundedCondition condition
@@ -85,7 +89,10 @@ struct FStateTreeIsInDangerConditionInstanceData
 STATETREE_POD_INSTANCEDATA(FStateTreeIsInDangerConditionInstanceData);
 
 /**
- *  StateTree condition to check if the character is about to be hit by an attack
+ *  StateTree condition to check if the character is about to be hit by an attack.
+ *  Reads the danger recorded by the character's last danger event, so it costs a single time check until one comes in.
+ *  Danger events come from the threat field at the end of the frame an attack is published, so trees that can wait on
+ *  the Combat.Event.Danger StateTree event don't need to evaluate it every tick
  */
 USTRUCT(DisplayName = "Character is in Danger")
 struct FStateTreeIsInDangerCondition : public FStateTreeConditionCommonBase
@@ -123,10 +130,15 @@ struct FStateTreeAttackInstanceData
 	/** Character that will perform the attack */
 	UPROPERTY(EditAnywhere, Category = Context)
 	TObjectPtr<ACombatEnemy> Character;
+
+	/** Our listener on the character's gameplay event channel */
+	FDelegateHandle EventHandle;
 };
 
 /**
  *  StateTree task to perform a combo attack
+ *  Fails when the encounter director doesn't grant an attack token or the attack montage can't play,
+ *  so the owning state needs an On Failed transition, e.g. back to the approach state
  */
 USTRUCT(meta=(DisplayName="Combo Attack", Category="Combat"))
 struct FStateTreeComboAttackTask : public FStateTreeTaskCommonBase
@@ -150,6 +162,8 @@ struct FStateTreeComboAttackTask : public FStateTreeTaskCommonBase
 
 /**
  *  StateTree task to perform a charged attack
+ *  Fails when the encounter director doesn't grant an attack token or the attack montage can't play,
+ *  so the owning state needs an On Failed transition, e.g. back to the approach state
  */
 USTRUCT(meta=(DisplayName="Charged Attack", Category="Combat"))
 struct FStateTreeChargedAttackTask : public FStateTreeTaskCommonBase
@@ -359,6 +373,124 @@ struct FStateTreeGetPlayerInfoTask : public FStateTreeTaskCommonBase
 	/** Runs while the owning state is active */
 	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
 
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Run Cached Env Query task
+ */
+USTRUCT()
+struct FStateTreeRunCachedEnvQueryInstanceData
+{
+	GENERATED_BODY()
+
+	/** Actor the query runs for */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AActor> Querier;
+
+	/** Query to run */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	TObjectPtr<UEnvQuery> QueryTemplate;
+
+	/** Context whose location is part of the cache key, such as the danger or player context */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	TSubclassOf<UEnvQueryContext> KeyContext;
+
+	/** How the query picks its items */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	TEnumAsByte<EEnvQueryRunMode::Type> RunMode = EEnvQueryRunMode::SingleResult;
+
+	/** Location picked by the query */
+	UPROPERTY(EditAnywhere, Category = Output)
+	FVector ResultLocation = FVector::ZeroVector;
+
+	/** Actor picked by the query, if it returns actors */
+	UPROPERTY(EditAnywhere, Category = Output)
+	TObjectPtr<AActor> ResultActor;
+
+	/** Cache key of the request we're waiting on */
+	FCombatEQSCacheKey CacheKey;
+};
+
+/**
+ *  StateTree task to run an EnvQuery through the shared EQS result cache.
+ *  Nearby enemies asking the same question reuse one query and its scored result.
+ */
+USTRUCT(meta=(DisplayName="Run Cached Env Query", Category="Combat"))
+struct FStateTreeRunCachedEnvQueryTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeRunCachedEnvQueryInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+#if WITH_EDITOR
+	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
+#endif // WITH_EDITOR
+
+protected:
+
+	/** Polls the cache, writing the outputs once the result is ready */
+	EStateTreeRunStatus PollQuery(FInstanceDataType& InstanceData) const;
+};
+
+////////////////////////////////////////////////////////////////////
+
+/**
+ *  Instance data struct for the Follow Flow Field task
+ */
+USTRUCT()
+struct FStateTreeFollowFlowFieldInstanceData
+{
+	GENERATED_BODY()
+
+	/** AI Controller that will chase the target */
+	UPROPERTY(EditAnywhere, Category = Context)
+	TObjectPtr<AAIController> Controller;
+
+	/** Actor to chase */
+	UPROPERTY(EditAnywhere, Category = Input)
+	TObjectPtr<AActor> Target;
+
+	/** The task succeeds once the pawn is this close to the target */
+	UPROPERTY(EditAnywhere, Category = Parameter)
+	float AcceptanceRadius = 150.0f;
+};
+
+/**
+ *  StateTree task to chase an actor along the shared flow field.
+ *  Falls back to regular pathfinding near the target or where the field can't help.
+ *  Meant to replace the Move To task in the enemy StateTree's chase state; the shipped StateTree assets don't use it yet.
+ */
+USTRUCT(meta=(DisplayName="Follow Flow Field", Category="Combat"))
+struct FStateTreeFollowFlowFieldTask : public FStateTreeTaskCommonBase
+{
+	GENERATED_BODY()
+
+	/* Ensure we're using the correct instance data struct */
+	using FInstanceDataType = FStateTreeFollowFlowFieldInstanceData;
+	virtual const UStruct* GetInstanceDataType() const override { return FInstanceDataType::StaticStruct(); }
+
+	/** Runs when the owning state is entered */
+	virtual EStateTreeRunStatus EnterState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
+	/** Runs while the owning state is active */
+	virtual EStateTreeRunStatus Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const override;
+
+	/** Runs when the owning state is ended */
+	virtual void ExitState(FStateTreeExecutionContext& Context, const FStateTreeTransitionResult& Transition) const override;
+
 #if WITH_EDITOR
 	virtual FText GetDescription(const FGuid& ID, FStateTreeDataView InstanceDataView, const IStateTreeBindingLookup& BindingLookup, EStateTreeNodeFormatting Formatting = EStateTreeNodeFormatting::Text) const override;
 #endif // WITH_EDITOR
@@ -0,0 +1,175 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatThreatSubsystem.h"
+#include "CombatFactionSubsystem.h"
+#include "CombatDamageableGrid.h"
+#include "CombatDamageable.h"
+#include "Engine/World.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Threat Notify"), STAT_CombatThreatNotify, STATGROUP_NexusTrials);
+
+UCombatThreatSubsystem* UCombatThreatSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatThreatSubsystem>() : nullptr;
+}
+
+void UCombatThreatSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// allocate all the slots up front so publishing never allocates records
+	Threats.SetNum(MaxThreats);
+	ThreatCells.SetNum(MaxThreats);
+}
+
+bool UCombatThreatSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FIntPoint UCombatThreatSubsystem::GetCell(const FVector& Location)
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UCombatThreatSubsystem::PublishThreat(AActor* Source, const FVector& Origin, const FVector& Direction, float Reach, float Radius, float Lifetime)
+{
+	// recycle the oldest slot
+	const int32 Slot = NextSlot;
+	NextSlot = (NextSlot + 1) % MaxThreats;
+
+	// remove the old threat from its cells
+	for (const FIntPoint& OldCell : ThreatCells[Slot])
+	{
+		if (TArray<int32, TInlineAllocator<4>>* CellSlots = Cells.Find(OldCell))
+		{
+			CellSlots->RemoveSingleSwap(Slot, EAllowShrinking::No);
+		}
+	}
+
+	ThreatCells[Slot].Reset();
+
+	// write the new record
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	FCombatThreat& Threat = Threats[Slot];
+	Threat.Source = Source;
+	Threat.SourceFaction = UCombatFactionSubsystem::GetActorFaction(Source);
+	Threat.Origin = Origin;
+	Threat.Direction = Direction.GetSafeNormal();
+	Threat.Reach = Reach;
+	Threat.Radius = Radius;
+	Threat.PublishTime = TimeSeconds;
+	Threat.ExpiryTime = TimeSeconds + Lifetime;
+
+	// the pawns in the way are told at the end of the frame. A slot recycled within the frame only counts once
+	NumPendingThreats = FMath::Min(NumPendingThreats + 1, MaxThreats);
+
+	// add it to every cell its bounds overlap
+	const FVector End = Origin + Threat.Direction * Reach;
+	const FIntPoint MinCell = GetCell(Origin.ComponentMin(End) - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin.ComponentMax(End) + FVector(Radius));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const FIntPoint Cell(CellX, CellY);
+
+			Cells.FindOrAdd(Cell).Add(Slot);
+			ThreatCells[Slot].Add(Cell);
+		}
+	}
+}
+
+TStatId UCombatThreatSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatThreatSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatThreatSubsystem::Tick(float DeltaTime)
+{
+	if (NumPendingThreats == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatThreatNotify);
+
+	UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this);
+
+	// threats only threaten pawns
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+
+	// the pending threats are the last ones written, so walk back from the next slot
+	for (int32 PendingIndex = 0; PendingIndex < NumPendingThreats && Grid; ++PendingIndex)
+	{
+		const FCombatThreat& Threat = Threats[(NextSlot - NumPendingThreats + PendingIndex + MaxThreats) % MaxThreats];
+		AActor* Source = Threat.Source.Get();
+
+		// sweep the threatened capsule once for every pawn in the way, instead of having each of them query the field
+		TNexusFrameArray<FHitResult> OutHits;
+		const uint32 TargetFactions = UCombatFactionSubsystem::GetMatrix(this).GetTargetMask(Threat.SourceFaction);
+
+		if (Grid->SweepMulti(OutHits, Threat.Origin, Threat.Origin + Threat.Direction * Threat.Reach, Threat.Radius, ObjectParams, Source, TargetFactions))
+		{
+			for (const FHitResult& CurrentHit : OutHits)
+			{
+				if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor()))
+				{
+					Damageable->NotifyDanger(Threat.Origin, Source);
+				}
+			}
+		}
+	}
+
+	NumPendingThreats = 0;
+}
+
+const FCombatThreat* UCombatThreatSubsystem::FindLatestThreat(const FVector& Location, float QueryRadius, const AActor* IgnoredSource, uint32 SourceFactionMask) const
+{
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+	const FCombatThreat* LatestThreat = nullptr;
+
+	// check every cell the query sphere overlaps. Slots found in more than one cell are just tested twice
+	const FIntPoint MinCell = GetCell(Location - FVector(QueryRadius));
+	const FIntPoint MaxCell = GetCell(Location + FVector(QueryRadius));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const TArray<int32, TInlineAllocator<4>>* CellSlots = Cells.Find(FIntPoint(CellX, CellY));
+
+			if (!CellSlots)
+			{
+				continue;
+			}
+
+			for (const int32 Slot : *CellSlots)
+			{
+				const FCombatThreat& Threat = Threats[Slot];
+
+				// skip expired threats, threats from factions we don't care about, our own threats and anything older than what we've already found
+				if (Threat.ExpiryTime < TimeSeconds || !FCombatFactionMatrix::MaskHasFaction(SourceFactionMask, Threat.SourceFaction) || Threat.Source.Get() == IgnoredSource || (LatestThreat && Threat.PublishTime <= LatestThreat->PublishTime))
+				{
+					continue;
+				}
+
+				// is the query sphere touching the threatened capsule?
+				const FVector ClosestPoint = FMath::ClosestPointOnSegment(Location, Threat.Origin, Threat.Origin + Threat.Direction * Threat.Reach);
+
+				if (FVector::DistSquared(ClosestPoint, Location) <= FMath::Square(Threat.Radius + QueryRadius))
+				{
+					LatestThreat = &Threat;
+				}
+			}
+		}
+	}
+
+	return LatestThreat;
+}
@@ -0,0 +1,106 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFaction.h"
+#include "CombatThreatSubsystem.generated.h"
+
+/**
+ *  A short-lived record of an incoming attack.
+ *  Covers a capsule from Origin along Direction for Reach, with the given Radius.
+ */
+struct FCombatThreat
+{
+	/** Actor that published the threat */
+	TWeakObjectPtr<AActor> Source;
+
+	/** Faction of the source at publish time */
+	ECombatFaction SourceFaction = ECombatFaction::Neutral;
+
+	/** Location the attack comes from */
+	FVector Origin = FVector::ZeroVector;
+
+	/** Normalized attack direction */
+	FVector Direction = FVector::ForwardVector;
+
+	/** Distance the threat extends along Direction */
+	float Reach = 0.0f;
+
+	/** Radius of the threatened area around the attack path */
+	float Radius = 0.0f;
+
+	/** Game time the threat was published */
+	float PublishTime = -1000.0f;
+
+	/** Game time the threat stops being relevant */
+	float ExpiryTime = -1000.0f;
+};
+
+/**
+ *  World threat field.
+ *  Attackers publish threats into a fixed size ring buffer bucketed by a uniform 2D grid, so publishing is constant time.
+ *  Once per frame, the threats published that frame are swept against the damageable grid in one batch,
+ *  and every pawn in the way gets NotifyDanger, so AI can wait on the danger event instead of polling the field.
+ *  Actors can still look up the field directly, e.g. to find where the latest danger came from.
+ */
+UCLASS()
+class UCombatThreatSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the threat field for the world the provided object lives in, if any */
+	static UCombatThreatSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Publishes a new threat, overwriting the oldest one if the field is full */
+	void PublishThreat(AActor* Source, const FVector& Origin, const FVector& Direction, float Reach, float Radius, float Lifetime);
+
+	/**
+	 *  Returns the most recently published live threat that covers a sphere at the provided location, or nullptr if there's none.
+	 *  Threats published by IgnoredSource, or by a faction outside SourceFactionMask, are skipped.
+	 */
+	const FCombatThreat* FindLatestThreat(const FVector& Location, float QueryRadius, const AActor* IgnoredSource, uint32 SourceFactionMask = MAX_uint32) const;
+
+	/** Returns the number of threat slots in the ring buffer */
+	static constexpr int32 GetMaxThreats() { return MaxThreats; }
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Allocate the ring buffer */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/** Only create the field for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Max number of threats alive at any time */
+	static constexpr int32 MaxThreats = 64;
+
+	/** Horizontal size of each grid cell */
+	static constexpr float CellSize = 400.0f;
+
+	/** Returns the cell containing the provided location */
+	static FIntPoint GetCell(const FVector& Location);
+
+	/** Threat records */
+	TArray<FCombatThreat> Threats;
+
+	/** Cells each threat slot was added to, so it can be removed when the slot is recycled */
+	TArray<TArray<FIntPoint, TInlineAllocator<4>>> ThreatCells;
+
+	/** Threat slots bucketed by cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+
+	/** Next ring buffer slot to write to */
+	int32 NextSlot = 0;
+
+	/** Number of threats published since the last notification pass. They're the slots right before NextSlot */
+	int32 NumPendingThreats = 0;
+};
@@ -0,0 +1,382 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatWaveSpawner.h"
+#include "Engine/World.h"
+#include "Components/SceneComponent.h"
+#include "Components/ArrowComponent.h"
+#include "TimerManager.h"
+#include "CombatEnemy.h"
+#include "CombatEnemyPoolSubsystem.h"
+#include "CombatSpawnSchedulerSubsystem.h"
+#include "CombatSnapshotSubsystem.h"
+
+ACombatWaveSpawner::ACombatWaveSpawner()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the root
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	SpawnDirection = CreateDefaultSubobject<UArrowComponent>(TEXT("Spawn Direction"));
+	SpawnDirection->SetupAttachment(RootComponent);
+}
+
+void ACombatWaveSpawner::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// create enough enemies of each type for the largest wave, so starting a wave doesn't construct any actors
+	if (bPrewarmPool)
+	{
+		if (UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this))
+		{
+			TMap<TSubclassOf<ACombatEnemy>, int32> PrewarmCounts;
+
+			for (const FCombatSpawnWave& Wave : Waves)
+			{
+				TMap<TSubclassOf<ACombatEnemy>, int32> WaveCounts;
+
+				for (const FCombatSpawnGroup& Group : Wave.Groups)
+				{
+					if (IsValid(Group.EnemyClass))
+					{
+						WaveCounts.FindOrAdd(Group.EnemyClass) += Group.Count;
+					}
+				}
+
+				for (const TPair<TSubclassOf<ACombatEnemy>, int32>& WaveCount : WaveCounts)
+				{
+					int32& PrewarmCount = PrewarmCounts.FindOrAdd(WaveCount.Key);
+					PrewarmCount = FMath::Max(PrewarmCount, WaveCount.Value);
+				}
+			}
+
+			for (const TPair<TSubclassOf<ACombatEnemy>, int32>& PrewarmCount : PrewarmCounts)
+			{
+				Pool->Prewarm(PrewarmCount.Key, PrewarmCount.Value, GetActorTransform());
+			}
+		}
+	}
+
+	// save our progress with the arena snapshot
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
+
+	// should we start right away?
+	if (bShouldStartImmediately)
+	{
+		bHasBeenActivated = true;
+		ScheduleNextWave();
+	}
+}
+
+void ACombatWaveSpawner::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// clear the timers
+	GetWorld()->GetTimerManager().ClearTimer(WaveTimer);
+
+	for (FTimerHandle& GroupTimer : GroupTimers)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(GroupTimer);
+	}
+
+	// drop any spawns we still have queued
+	if (UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this))
+	{
+		Scheduler->CancelSpawns(this);
+	}
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
+}
+
+void ACombatWaveSpawner::ScheduleNextWave()
+{
+	++CurrentWave;
+
+	// are we out of waves?
+	if (!Waves.IsValidIndex(CurrentWave))
+	{
+		// schedule the activation on depleted message
+		GetWorld()->GetTimerManager().SetTimer(WaveTimer, this, &ACombatWaveSpawner::SpawnerDepleted, ActivationDelay);
+		return;
+	}
+
+	const float WaveDelay = Waves[CurrentWave].DelayBeforeWave;
+
+	if (WaveDelay > 0.0f)
+	{
+		GetWorld()->GetTimerManager().SetTimer(WaveTimer, this, &ACombatWaveSpawner::StartWave, WaveDelay);
+
+	} else {
+
+		StartWave();
+	}
+}
+
+void ACombatWaveSpawner::StartWave()
+{
+	const FCombatSpawnWave& Wave = Waves[CurrentWave];
+
+	// count the whole wave up front so it can't be considered cleared while delayed groups are still pending
+	PendingEnemies = 0;
+	AliveEnemies = 0;
+	WaveEnemies.Reset();
+
+	for (const FCombatSpawnGroup& Group : Wave.Groups)
+	{
+		if (IsValid(Group.EnemyClass))
+		{
+			PendingEnemies += Group.Count;
+		}
+	}
+
+	// an empty wave is cleared right away
+	if (PendingEnemies == 0)
+	{
+		ScheduleNextWave();
+		return;
+	}
+
+	GroupTimers.Reset();
+
+	for (int32 GroupIndex = 0; GroupIndex < Wave.Groups.Num(); ++GroupIndex)
+	{
+		const FCombatSpawnGroup& Group = Wave.Groups[GroupIndex];
+
+		if (!IsValid(Group.EnemyClass))
+		{
+			continue;
+		}
+
+		if (Group.Delay > 0.0f)
+		{
+			FTimerHandle& GroupTimer = GroupTimers.AddDefaulted_GetRef();
+			GetWorld()->GetTimerManager().SetTimer(GroupTimer, FTimerDelegate::CreateUObject(this, &ACombatWaveSpawner::QueueGroup, CurrentWave, GroupIndex), Group.Delay, false);
+
+		} else {
+
+			QueueGroup(CurrentWave, GroupIndex);
+		}
+	}
+}
+
+void ACombatWaveSpawner::QueueGroup(int32 WaveIndex, int32 GroupIndex)
+{
+	const FCombatSpawnGroup& Group = Waves[WaveIndex].Groups[GroupIndex];
+
+	const FVector GroupCenter = GetActorTransform().TransformPosition(Group.SpawnOffset);
+	const FRotator SpawnRotation = SpawnDirection->GetComponentRotation();
+
+	UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this);
+
+	for (int32 EnemyIndex = 0; EnemyIndex < Group.Count; ++EnemyIndex)
+	{
+		// spread the group out on a ring so its members don't all resolve to the same spot
+		FVector SpawnLocation = GroupCenter;
+
+		if (Group.Count > 1)
+		{
+			const float Angle = UE_TWO_PI * EnemyIndex / Group.Count;
+			SpawnLocation += SpawnRotation.RotateVector(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f)) * Group.SpreadRadius;
+		}
+
+		const FTransform SpawnTransform(SpawnRotation, SpawnLocation);
+
+		if (Scheduler)
+		{
+			Scheduler->QueueSpawn(this, Group.EnemyClass, SpawnTransform, FOnCombatEnemySpawned::CreateUObject(this, &ACombatWaveSpawner::OnEnemySpawned));
+
+		} else {
+
+			// no scheduler, so spawn right away
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+			OnEnemySpawned(GetWorld()->SpawnActor<ACombatEnemy>(Group.EnemyClass, SpawnTransform, SpawnParams));
+		}
+	}
+}
+
+void ACombatWaveSpawner::OnEnemySpawned(ACombatEnemy* SpawnedEnemy)
+{
+	--PendingEnemies;
+
+	// was the enemy successfully created?
+	if (SpawnedEnemy)
+	{
+		++AliveEnemies;
+		WaveEnemies.Add(SpawnedEnemy);
+
+		// subscribe to the death delegate
+		SpawnedEnemy->OnEnemyDied.AddDynamic(this, &ACombatWaveSpawner::OnEnemyDied);
+		return;
+	}
+
+	// a failed spawn shouldn't stall the wave
+	CheckWaveCleared();
+}
+
+void ACombatWaveSpawner::OnEnemyDied()
+{
+	--AliveEnemies;
+
+	CheckWaveCleared();
+}
+
+void ACombatWaveSpawner::CheckWaveCleared()
+{
+	if (PendingEnemies <= 0 && AliveEnemies <= 0)
+	{
+		ScheduleNextWave();
+	}
+}
+
+void ACombatWaveSpawner::SpawnerDepleted()
+{
+	// process the actors to activate list
+	for (AActor* CurrentActor : ActorsToActivateWhenDepleted)
+	{
+		// check if the actor is activatable
+		if (ICombatActivatable* CombatActivatable = Cast<ICombatActivatable>(CurrentActor))
+		{
+			// activate the actor
+			CombatActivatable->ActivateInteraction(this);
+		}
+	}
+}
+
+void ACombatWaveSpawner::ToggleInteraction(AActor* ActivationInstigator)
+{
+	// stub
+}
+
+void ACombatWaveSpawner::ActivateInteraction(AActor* ActivationInstigator)
+{
+	// ensure we're only activated once
+	if (bHasBeenActivated)
+	{
+		return;
+	}
+
+	// raise the activation flag
+	bHasBeenActivated = true;
+
+	// start the first wave
+	ScheduleNextWave();
+}
+
+void ACombatWaveSpawner::DeactivateInteraction(AActor* ActivationInstigator)
+{
+	// stub
+}
+
+void ACombatWaveSpawner::SerializeSnapshot(FArchive& Ar)
+{
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+
+	float WaveTimerRemaining = TimerManager.GetTimerRemaining(WaveTimer);
+
+	Ar << bHasBeenActivated;
+	Ar << CurrentWave;
+	Ar << PendingEnemies;
+	Ar << WaveEnemies;
+	Ar << WaveTimerRemaining;
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	// drop whatever we were about to do
+	TimerManager.ClearTimer(WaveTimer);
+
+	for (FTimerHandle& GroupTimer : GroupTimers)
+	{
+		TimerManager.ClearTimer(GroupTimer);
+	}
+
+	GroupTimers.Reset();
+
+	if (UCombatSpawnSchedulerSubsystem* Scheduler = UCombatSpawnSchedulerSubsystem::Get(this))
+	{
+		Scheduler->CancelSpawns(this);
+	}
+
+	// alive enemies are counted once they've all been restored
+	AliveEnemies = 0;
+
+	// timers never fire during the restore, so we don't take enemies from the pool before they're all back in place
+	if (WaveTimerRemaining >= 0.0f)
+	{
+		if (Waves.IsValidIndex(CurrentWave))
+		{
+			TimerManager.SetTimer(WaveTimer, this, &ACombatWaveSpawner::StartWave, FMath::Max(WaveTimerRemaining, UE_KINDA_SMALL_NUMBER));
+
+		} else {
+
+			TimerManager.SetTimer(WaveTimer, this, &ACombatWaveSpawner::SpawnerDepleted, FMath::Max(WaveTimerRemaining, UE_KINDA_SMALL_NUMBER));
+		}
+
+	} else if (PendingEnemies > 0) {
+
+		// the wave was still spawning, so start it over
+		TimerManager.SetTimer(WaveTimer, this, &ACombatWaveSpawner::StartWave, UE_KINDA_SMALL_NUMBER);
+	}
+}
+
+void ACombatWaveSpawner::PostSnapshotRestore()
+{
+	// the wave is restarting, so take out the enemies it had already spawned
+	if (PendingEnemies > 0)
+	{
+		UCombatEnemyPoolSubsystem* Pool = UCombatEnemyPoolSubsystem::Get(this);
+
+		for (const TWeakObjectPtr<ACombatEnemy>& WaveEnemy : WaveEnemies)
+		{
+			ACombatEnemy* Enemy = WaveEnemy.Get();
+
+			if (!Enemy || Enemy->IsPooled())
+			{
+				continue;
+			}
+
+			if (Pool)
+			{
+				Pool->ReleaseEnemy(Enemy);
+
+			} else {
+
+				Enemy->Destroy();
+			}
+		}
+
+		WaveEnemies.Reset();
+		return;
+	}
+
+	// subscribe to the deaths of the wave enemies that are back in play
+	for (const TWeakObjectPtr<ACombatEnemy>& WaveEnemy : WaveEnemies)
+	{
+		ACombatEnemy* Enemy = WaveEnemy.Get();
+
+		if (Enemy && Enemy->IsAlive())
+		{
+			++AliveEnemies;
+			Enemy->OnEnemyDied.AddUniqueDynamic(this, &ACombatWaveSpawner::OnEnemyDied);
+		}
+	}
+
+	// enemies destroyed since the capture can't come back, so the wave may already be cleared
+	if (Waves.IsValidIndex(CurrentWave) && !GetWorld()->GetTimerManager().IsTimerActive(WaveTimer))
+	{
+		CheckWaveCleared();
+	}
+}
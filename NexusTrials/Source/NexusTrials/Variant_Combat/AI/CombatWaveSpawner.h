@@ -0,0 +1,184 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatActivatable.h"
+#include "CombatSnapshotable.h"
+#include "CombatWaveSpawner.generated.h"
+
+class UArrowComponent;
+class ACombatEnemy;
+
+/**
+ *  A group of enemies of the same type spawned together around a point
+ */
+USTRUCT(BlueprintType)
+struct FCombatSpawnGroup
+{
+	GENERATED_BODY()
+
+	/** Type of enemy to spawn */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Group")
+	TSubclassOf<ACombatEnemy> EnemyClass;
+
+	/** Number of enemies in this group */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Group", meta = (ClampMin = 1, ClampMax = 100))
+	int32 Count = 1;
+
+	/** Center of the group, relative to the spawner */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Group", meta = (MakeEditWidget))
+	FVector SpawnOffset = FVector(0.0f, 0.0f, 90.0f);
+
+	/** Radius of the ring the group's enemies are spread out on */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Group", meta = (ClampMin = 0, ClampMax = 2000, Units = "cm"))
+	float SpreadRadius = 150.0f;
+
+	/** Time to wait after the wave starts before spawning this group */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Group", meta = (ClampMin = 0, ClampMax = 60, Units = "s"))
+	float Delay = 0.0f;
+};
+
+/**
+ *  A set of spawn groups. The wave ends when every enemy in it has died
+ */
+USTRUCT(BlueprintType)
+struct FCombatSpawnWave
+{
+	GENERATED_BODY()
+
+	/** Groups spawned as part of this wave */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Wave")
+	TArray<FCombatSpawnGroup> Groups;
+
+	/** Time to wait before starting this wave, after the previous one ends or the spawner is activated */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Spawn Wave", meta = (ClampMin = 0, ClampMax = 60, Units = "s"))
+	float DelayBeforeWave = 1.0f;
+};
+
+/**
+ *  An Actor that spawns enemies in waves of spawn groups.
+ *  Spawns are queued with the spawn scheduler, which spreads them over several frames within a time budget,
+ *  so large encounters can be triggered without a frame spike.
+ *  The spawner can be remotely activated through the ICombatActivatable interface
+ *  When the last wave is cleared, the spawner can also activate other ICombatActivatables
+ *  Its progress is saved in arena snapshots through the ICombatSnapshotable interface.
+ *  A wave that was still spawning when the snapshot was captured is restarted on restore
+ */
+UCLASS()
+class ACombatWaveSpawner : public AActor, public ICombatActivatable, public ICombatSnapshotable
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UArrowComponent* SpawnDirection;
+
+protected:
+
+	/** Waves to spawn, in order */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Wave Spawner")
+	TArray<FCombatSpawnWave> Waves;
+
+	/** If true, the first wave will start as soon as the game starts */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Wave Spawner")
+	bool bShouldStartImmediately = false;
+
+	/** If true, enough enemies for the largest wave are created up front and parked in the enemy pool */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Wave Spawner")
+	bool bPrewarmPool = true;
+
+	/** Time to wait after the last wave is cleared before activating the actor list */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation", meta = (ClampMin = 0, ClampMax = 10))
+	float ActivationDelay = 1.0f;
+
+	/** List of actors to activate after the last wave is cleared */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Activation")
+	TArray<AActor*> ActorsToActivateWhenDepleted;
+
+	/** Flag to ensure this is only activated once */
+	bool bHasBeenActivated = false;
+
+	/** Index of the wave currently in progress */
+	int32 CurrentWave = INDEX_NONE;
+
+	/** Enemies of the current wave that haven't been spawned yet */
+	int32 PendingEnemies = 0;
+
+	/** Enemies of the current wave that are still alive */
+	int32 AliveEnemies = 0;
+
+	/** Enemies spawned for the current wave so far */
+	TArray<TWeakObjectPtr<ACombatEnemy>> WaveEnemies;
+
+	/** Timer to start the next wave, or to activate the actor list */
+	FTimerHandle WaveTimer;
+
+	/** Timers for the delayed groups of the current wave */
+	TArray<FTimerHandle> GroupTimers;
+
+public:
+
+	/** Constructor */
+	ACombatWaveSpawner();
+
+public:
+
+	/** Initialization */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+protected:
+
+	/** Schedules the next wave, or the depleted activation if there are none left */
+	void ScheduleNextWave();
+
+	/** Starts the current wave, queueing or scheduling each of its groups */
+	void StartWave();
+
+	/** Queues every enemy of a spawn group with the spawn scheduler */
+	void QueueGroup(int32 WaveIndex, int32 GroupIndex);
+
+	/** Called when a queued enemy has been spawned */
+	void OnEnemySpawned(ACombatEnemy* SpawnedEnemy);
+
+	/** Called when a spawned enemy has died */
+	UFUNCTION()
+	void OnEnemyDied();
+
+	/** Starts the next wave once the current one has been fully spawned and cleared */
+	void CheckWaveCleared();
+
+	/** Called after the last wave has been cleared */
+	void SpawnerDepleted();
+
+public:
+
+	// ~begin ICombatActivatable interface
+
+	/** Toggles the Spawner */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void ToggleInteraction(AActor* ActivationInstigator) override;
+
+	/** Activates the Spawner */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void ActivateInteraction(AActor* ActivationInstigator) override;
+
+	/** Deactivates the Spawner */
+	UFUNCTION(BlueprintCallable, Category="Activatable")
+	virtual void DeactivateInteraction(AActor* ActivationInstigator) override;
+
+	// ~end IActivatable interface
+
+	// ~begin ICombatSnapshotable interface
+
+	/** Saves or restores the activation, current wave, wave enemies and wave timer */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	/** Subscribes to the restored wave enemies' deaths again, or clears them out if the wave is restarting */
+	virtual void PostSnapshotRestore() override;
+
+	// ~end ICombatSnapshotable interface
+};
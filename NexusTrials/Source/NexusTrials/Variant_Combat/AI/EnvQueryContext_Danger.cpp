@@ -7,11 +7,33 @@
 #include "EnvironmentQuery/Items/EnvQueryItemType_Point.h"
 
 void UEnvQueryContext_Danger::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
+{
+	FVector DangerLocation;
+
+	if (GetContextLocation(Cast<AActor>(QueryInstance.Owner.Get()), DangerLocation))
+	{
+		// add the danger location to the context
+		UEnvQueryItemType_Point::SetContextHelper(ContextData, DangerLocation);
+	}
+}
+
+bool UEnvQueryContext_Danger::GetContextLocation(const AActor* Querier, FVector& OutLocation) const
 {
 	// get the querying enemy
-	if (ACombatEnemy* QuerierActor = Cast<ACombatEnemy>(QueryInstance.Owner.Get()))
+	const ACombatEnemy* QuerierEnemy = Cast<ACombatEnemy>(Querier);
+
+	if (!QuerierEnemy)
 	{
-		// add the last recorded danger location to the context
-		UEnvQueryItemType_Point::SetContextHelper(ContextData, QuerierActor->GetLastDangerLocation());
+		return false;
 	}
+
+	// look up the latest danger location, falling back to the last one recorded on the enemy
+	float DangerTime;
+
+	if (!QuerierEnemy->GetMostRecentDanger(OutLocation, DangerTime))
+	{
+		OutLocation = QuerierEnemy->GetLastDangerLocation();
+	}
+
+	return true;
 }
\ No newline at end of file
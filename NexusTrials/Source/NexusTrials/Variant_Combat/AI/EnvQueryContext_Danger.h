@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "EnvironmentQuery/EnvQueryContext.h"
+#include "CombatCachedEnvQueryContext.h"
 #include "EnvQueryContext_Danger.generated.h"
 
 /**
@@ -11,7 +12,7 @@
  *  Returns the enemy character's last known danger location
  */
 UCLASS()
-class NEXUSTRIALS_API UEnvQueryContext_Danger : public UEnvQueryContext
+class NEXUSTRIALS_API UEnvQueryContext_Danger : public UEnvQueryContext, public ICombatCachedEnvQueryContext
 {
 	GENERATED_BODY()
 	
@@ -20,4 +21,7 @@ public:
 	/** Provides the context locations or actors for this EnvQuery */
 	virtual void ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const override;
 
+	/** Returns the danger location for the querying enemy */
+	virtual bool GetContextLocation(const AActor* Querier, FVector& OutLocation) const override;
+
 };
@@ -2,17 +2,60 @@
 
 
 #include "EnvQueryContext_Player.h"
-#include "Kismet/GameplayStatics.h"
 #include "EnvironmentQuery/EnvQueryTypes.h"
 #include "EnvironmentQuery/Items/EnvQueryItemType_Actor.h"
+#include "GameFramework/Controller.h"
 #include "GameFramework/Pawn.h"
+#include "CombatFactionSubsystem.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
 
 void UEnvQueryContext_Player::ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const
 {
-	// get the player pawn for the first local player
-	AActor* PlayerPawn = UGameplayStatics::GetPlayerPawn(QueryInstance.Owner.Get(), 0);
-	check(PlayerPawn);
+	// leave the context empty if there's nobody to target
+	if (APawn* Target = FindTarget(Cast<AActor>(QueryInstance.Owner.Get())))
+	{
+		// add the actor data to the context
+		UEnvQueryItemType_Actor::SetContextHelper(ContextData, Target);
+	}
+}
+
+bool UEnvQueryContext_Player::GetContextLocation(const AActor* Querier, FVector& OutLocation) const
+{
+	const APawn* Target = FindTarget(Querier);
+
+	if (!Target)
+	{
+		return false;
+	}
+
+	OutLocation = Target->GetActorLocation();
+	return true;
+}
+
+APawn* UEnvQueryContext_Player::FindTarget(const AActor* Querier)
+{
+	// queries are usually run by the AI controller, so resolve it to the pawn it controls
+	if (const AController* Controller = Cast<AController>(Querier))
+	{
+		Querier = Controller->GetPawn();
+	}
+
+	const UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(Querier);
+
+	if (!Querier || !TargetSnapshot)
+	{
+		return nullptr;
+	}
+
+	// use the querier's current target if it has picked one
+	FNexusTargetInfo TargetInfo;
+
+	if (TargetSnapshot->GetTargetInfo(Querier, TargetInfo))
+	{
+		return TargetInfo.Target.Get();
+	}
 
-	// add the actor data to the context
-	UEnvQueryItemType_Actor::SetContextHelper(ContextData, PlayerPawn);
+	// otherwise search for the nearest hostile right away
+	const uint32 HostileMask = UCombatFactionSubsystem::GetMatrix(Querier).GetTargetMask(UCombatFactionSubsystem::GetActorFaction(Querier));
+	return TargetSnapshot->FindNearestTarget(Querier->GetActorLocation(), HostileMask, 0.0f, Querier);
 }
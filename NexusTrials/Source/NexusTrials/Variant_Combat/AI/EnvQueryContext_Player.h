@@ -4,14 +4,15 @@
 
 #include "CoreMinimal.h"
 #include "EnvironmentQuery/EnvQueryContext.h"
+#include "CombatCachedEnvQueryContext.h"
 #include "EnvQueryContext_Player.generated.h"
 
 /**
  *  UEnvQueryContext_Player
- *  Basic EnvQuery Context that returns the first local player
+ *  EnvQuery Context that returns the querier's nearest hostile target, or nothing if there is none
  */
 UCLASS()
-class UEnvQueryContext_Player : public UEnvQueryContext
+class UEnvQueryContext_Player : public UEnvQueryContext, public ICombatCachedEnvQueryContext
 {
 	GENERATED_BODY()
 	
@@ -19,4 +20,12 @@ public:
 
 	/** Provides the context locations or actors for this EnvQuery */
 	virtual void ProvideContext(FEnvQueryInstance& QueryInstance, FEnvQueryContextData& ContextData) const override;
+
+	/** Returns the location of the querier's nearest hostile target */
+	virtual bool GetContextLocation(const AActor* Querier, FVector& OutLocation) const override;
+
+protected:
+
+	/** Returns the querier's nearest hostile target, if any. Controllers are resolved to their pawn */
+	static APawn* FindTarget(const AActor* Querier);
 };
@@ -0,0 +1,38 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotifyState.h"
+#include "AnimNotifyState_AttackWindow.generated.h"
+
+/**
+ *  AnimNotifyState that opens an attack window on the actor.
+ *  While the window is open, the attack bone's path is swept every frame so fast swings can't skip targets,
+ *  and each target can only be damaged once per window.
+ */
+UCLASS()
+class UAnimNotifyState_AttackWindow : public UAnimNotifyState
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Source bone for the attack sweeps */
+	UPROPERTY(EditAnywhere, Category="Attack")
+	FName AttackBoneName;
+
+public:
+
+	/** Opens the attack window */
+	virtual void NotifyBegin(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float TotalDuration, const FAnimNotifyEventReference& EventReference) override;
+
+	/** Sweeps the attack bone's path since last frame */
+	virtual void NotifyTick(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, float FrameDeltaTime, const FAnimNotifyEventReference& EventReference) override;
+
+	/** Closes the attack window */
+	virtual void NotifyEnd(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation, const FAnimNotifyEventReference& EventReference) override;
+
+	/** Get the notify name */
+	virtual FString GetNotifyName_Implementation() const override;
+};
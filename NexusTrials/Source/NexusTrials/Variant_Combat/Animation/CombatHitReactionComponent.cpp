@@ -0,0 +1,141 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHitReactionComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/Actor.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hit Reaction Springs"), STAT_CombatHitReactionSprings, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Procedural Hit Reactions"), STAT_CombatProceduralHitReactions, STATGROUP_NexusTrials);
+
+UCombatHitReactionComponent::UCombatHitReactionComponent()
+{
+	// only tick while the springs are moving
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	// step the springs before the anim update reads them
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+}
+
+void UCombatHitReactionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// express the offsets in the space of the mesh the AnimBP runs on
+	Mesh = GetOwner()->FindComponentByClass<USkeletalMeshComponent>();
+
+	BoneOffsets.Init(FRotator::ZeroRotator, Bones.Num());
+	Angles.Init(FVector::ZeroVector, Bones.Num());
+	AngularVelocities.Init(FVector::ZeroVector, Bones.Num());
+}
+
+bool UCombatHitReactionComponent::AddHitReaction(const FVector& Direction, float Strength)
+{
+	// nothing would show on the mesh
+	if (!CanReact())
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_CombatProceduralHitReactions);
+
+	// bring the hit direction into component space, flattened so the bones tip over instead of twisting
+	const USceneComponent* Space = Mesh.Get();
+	FVector LocalDirection = Space ? Space->GetComponentTransform().InverseTransformVectorNoScale(Direction) : Direction;
+	LocalDirection.Z = 0.0f;
+
+	// a hit straight up or down has nothing to tip the bones over with, but it still counts as shown
+	if (!LocalDirection.Normalize())
+	{
+		return true;
+	}
+
+	// rotate the bones' up axis towards the hit direction
+	const FVector KickAxis = FVector::CrossProduct(FVector::UpVector, LocalDirection);
+
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		AngularVelocities[BoneIndex] += KickAxis * (KickSpeed * Strength * Bones[BoneIndex].Weight);
+	}
+
+	SetComponentTickEnabled(true);
+
+	return true;
+}
+
+void UCombatHitReactionComponent::ResetHitReactions()
+{
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		BoneOffsets[BoneIndex] = FRotator::ZeroRotator;
+		Angles[BoneIndex] = FVector::ZeroVector;
+		AngularVelocities[BoneIndex] = FVector::ZeroVector;
+	}
+
+	SetComponentTickEnabled(false);
+}
+
+FRotator UCombatHitReactionComponent::GetBoneOffset(FName BoneName) const
+{
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		if (Bones[BoneIndex].BoneName == BoneName && BoneOffsets.IsValidIndex(BoneIndex))
+		{
+			return BoneOffsets[BoneIndex];
+		}
+	}
+
+	return FRotator::ZeroRotator;
+}
+
+void UCombatHitReactionComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatHitReactionSprings);
+
+	const float Damping = 2.0f * DampingRatio * FMath::Sqrt(Stiffness);
+
+	// substep long frames so stiff springs stay stable
+	const int32 NumSteps = FMath::Clamp(FMath::CeilToInt32(DeltaTime * 60.0f), 1, 4);
+	const float StepTime = DeltaTime / NumSteps;
+
+	bool bAnyMoving = false;
+
+	for (int32 BoneIndex = 0; BoneIndex < Bones.Num(); ++BoneIndex)
+	{
+		FVector& Angle = Angles[BoneIndex];
+		FVector& AngularVelocity = AngularVelocities[BoneIndex];
+
+		// semi-implicit euler on a damped spring pulling back to the animated pose
+		for (int32 Step = 0; Step < NumSteps; ++Step)
+		{
+			AngularVelocity += (Angle * -Stiffness - AngularVelocity * Damping) * StepTime;
+			Angle += AngularVelocity * StepTime;
+		}
+
+		Angle = Angle.GetClampedToMaxSize(MaxAngle);
+
+		const bool bMoving = Angle.SizeSquared() > FMath::Square(RestThreshold) || AngularVelocity.SizeSquared() > FMath::Square(RestThreshold);
+
+		if (!bMoving)
+		{
+			Angle = FVector::ZeroVector;
+			AngularVelocity = FVector::ZeroVector;
+		}
+
+		bAnyMoving |= bMoving;
+
+		// convert the rotation vector into the rotator the AnimBP adds to the bone
+		const float AngleDegrees = Angle.Size();
+		BoneOffsets[BoneIndex] = AngleDegrees > UE_KINDA_SMALL_NUMBER ? FQuat(Angle / AngleDegrees, FMath::DegreesToRadians(AngleDegrees)).Rotator() : FRotator::ZeroRotator;
+	}
+
+	// stop ticking once everything has settled
+	if (!bAnyMoving)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
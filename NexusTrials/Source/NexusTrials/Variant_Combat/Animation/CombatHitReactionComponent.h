@@ -0,0 +1,116 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "CombatHitReactionComponent.generated.h"
+
+/**
+ *  A bone that flinches on hit reactions
+ */
+USTRUCT(BlueprintType)
+struct FCombatHitReactionBone
+{
+	GENERATED_BODY()
+
+	/** Bone to offset. Only used to identify the bone in the AnimBP */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Hit Reaction")
+	FName BoneName;
+
+	/** Share of the hit this bone reacts with */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 2))
+	float Weight = 1.0f;
+};
+
+/**
+ *  Procedural hit reactions.
+ *  Each hit kicks a damped spring per bone, and the resulting rotation offsets are read by the AnimBP
+ *  through BoneOffsets and applied with Transform (Modify) Bone nodes in component space, additive to the pose.
+ *  This replaces waking the physics bodies for a partial ragdoll on every hit.
+ *  Until Bones is filled in and bAnimBlueprintAppliesOffsets is set, AddHitReaction returns false and hits outside
+ *  the partial ragdoll budget show no reaction, so set both up on every mesh that takes hits.
+ *  The component only ticks while a spring is still moving.
+ */
+UCLASS(ClassGroup=(Combat), meta=(BlueprintSpawnableComponent))
+class UCombatHitReactionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Bones that react to hits. The order matches BoneOffsets */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction")
+	TArray<FCombatHitReactionBone> Bones;
+
+	/** Set once the owner's AnimBP applies BoneOffsets to the pose. Procedural reactions are skipped without it, since nothing would show */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction")
+	bool bAnimBlueprintAppliesOffsets = false;
+
+	/** Angular speed a hit of unit strength kicks the springs with */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 5000, Units = "deg/s"))
+	float KickSpeed = 600.0f;
+
+	/** How hard the springs pull the bones back to the animated pose */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 2000))
+	float Stiffness = 250.0f;
+
+	/** Damping ratio of the springs. 1 is critically damped, lower values overshoot */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 2))
+	float DampingRatio = 0.5f;
+
+	/** Largest rotation offset any bone can reach */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 90, Units = "deg"))
+	float MaxAngle = 35.0f;
+
+	/** Springs slower and closer to rest than this stop ticking */
+	UPROPERTY(EditAnywhere, Category="Hit Reaction", meta = (ClampMin = 0, ClampMax = 5, Units = "deg"))
+	float RestThreshold = 0.1f;
+
+	/** Current rotation offset of each bone, in component space. Read by the AnimBP */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Transient, Category="Hit Reaction")
+	TArray<FRotator> BoneOffsets;
+
+	/** Spring angle of each bone, as a rotation vector in degrees */
+	TArray<FVector> Angles;
+
+	/** Spring angular velocity of each bone, in degrees per second */
+	TArray<FVector> AngularVelocities;
+
+	/** Mesh whose component space the offsets are expressed in */
+	TWeakObjectPtr<USceneComponent> Mesh;
+
+public:
+
+	/** Constructor */
+	UCombatHitReactionComponent();
+
+	/** Initialization */
+	virtual void BeginPlay() override;
+
+	/** Steps the springs */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 *  Kicks the springs away from the hit.
+	 *  @param Direction	World space direction the hit pushes in
+	 *  @param Strength	Scale of the reaction. 1 is a regular hit
+	 *  @return false if this component can't show hit reactions, so the caller should react some other way
+	 */
+	UFUNCTION(BlueprintCallable, Category="Hit Reaction")
+	bool AddHitReaction(const FVector& Direction, float Strength = 1.0f);
+
+	/** Snaps every bone back to the animated pose */
+	UFUNCTION(BlueprintCallable, Category="Hit Reaction")
+	void ResetHitReactions();
+
+	/** Returns the rotation offset of a bone, by name. Returns a zero rotator for bones that don't react */
+	UFUNCTION(BlueprintPure, Category="Hit Reaction")
+	FRotator GetBoneOffset(FName BoneName) const;
+
+	/** Returns true if there are bones to kick and the AnimBP applies their offsets */
+	bool CanReact() const { return bAnimBlueprintAppliesOffsets && Bones.Num() > 0; }
+
+	/** Returns true while any bone is still moving */
+	bool IsReacting() const { return IsComponentTickEnabled(); }
+};
@@ -3,18 +3,25 @@
 
 #include "CombatCharacter.h"
 #include "Components/CapsuleComponent.h"
-#include "Components/WidgetComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Components/SkeletalMeshComponent.h"
 #include "Camera/CameraComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "EnhancedInputComponent.h"
-#include "CombatLifeBar.h"
+#include "CombatHealthBarSubsystem.h"
+#include "CombatHitReactionComponent.h"
+#include "CombatRagdollSubsystem.h"
 #include "Engine/DamageEvents.h"
 #include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
 #include "CombatPlayerController.h"
+#include "CombatDamageableGrid.h"
+#include "CombatSwingTracker.h"
+#include "CombatThreatSubsystem.h"
+#include "CombatFactionSubsystem.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
 
 ACombatCharacter::ACombatCharacter()
 {
@@ -43,11 +50,10 @@ ACombatCharacter::ACombatCharacter()
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName);
 	FollowCamera->bUsePawnControlRotation = false;
 
-	// create the life bar widget component
-	LifeBar = CreateDefaultSubobject<UWidgetComponent>(TEXT("LifeBar"));
-	LifeBar->SetupAttachment(RootComponent);
+	// create the hit reaction springs
+	HitReaction = CreateDefaultSubobject<UCombatHitReactionComponent>(TEXT("HitReaction"));
 
-	// set the player tag
+	// set the player tag. Combat filtering uses the faction instead, the tag is kept for Blueprint and EQS lookups
 	Tags.Add(FName("Player"));
 }
 
@@ -176,7 +182,10 @@ void ACombatCharacter::ResetHP()
 	CurrentHP = MaxHP;
 
 	// update the life bar
-	LifeBarWidget->SetLifePercentage(1.0f);
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->SetPercent(LifeBarHandle, 1.0f);
+	}
 }
 
 void ACombatCharacter::ComboAttack()
@@ -254,31 +263,86 @@ void ACombatCharacter::AttackMontageEnded(UAnimMontage* Montage, bool bInterrupt
 
 void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
+	// a single trace is a swing of its own, unless it happens inside an attack window
+	if (!SwingTracker.IsActive())
+	{
+		SwingTracker.ResetHits();
+	}
 
 	// start at the provided socket location, sweep forward
 	const FVector TraceStart = GetMesh()->GetSocketLocation(DamageSourceBone);
 	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * MeleeTraceDistance);
 
+	SweepAttackSegment(TraceStart, TraceEnd);
+}
+
+void ACombatCharacter::BeginAttackWindow(FName DamageSourceBone)
+{
+	// start tracking the bone's path and clear the hit list for this swing
+	SwingTracker.Begin(GetMesh(), DamageSourceBone);
+}
+
+void ACombatCharacter::TickAttackWindow(FName DamageSourceBone)
+{
+	// ignore if the window was never opened
+	if (!SwingTracker.IsActive())
+	{
+		return;
+	}
+
+	// get the connected path the bone followed since the last update
+	FCombatSwingTracker::FSwingPath SwingPath;
+	SwingTracker.Advance(GetMesh(), DamageSourceBone, SwingSampleSpacing, SwingPath);
+
+	// sweep each segment of the path, then again pushed forward along our reach, so the window covers
+	// everything a single attack trace from the bone would
+	const FVector Reach = GetActorForwardVector() * MeleeTraceDistance;
+	const int32 NumReachLayers = FCombatSwingTracker::GetNumReachLayers(MeleeTraceDistance, MeleeTraceRadius);
+
+	for (int32 Layer = 0; Layer <= NumReachLayers; ++Layer)
+	{
+		const FVector Offset = NumReachLayers > 0 ? Reach * (static_cast<float>(Layer) / NumReachLayers) : FVector::ZeroVector;
+
+		for (int32 PointIndex = 1; PointIndex < SwingPath.Num(); ++PointIndex)
+		{
+			SweepAttackSegment(SwingPath[PointIndex - 1] + Offset, SwingPath[PointIndex] + Offset);
+		}
+	}
+}
+
+void ACombatCharacter::EndAttackWindow(FName DamageSourceBone)
+{
+	// sweep whatever is left of the path before closing the window
+	TickAttackWindow(DamageSourceBone);
+
+	SwingTracker.End();
+}
+
+void ACombatCharacter::SweepAttackSegment(const FVector& TraceStart, const FVector& TraceEnd)
+{
+	// sweep for objects along the segment to be hit by the attack. The results only live until the end of the frame
+	TNexusFrameArray<FHitResult> OutHits;
+
 	// check for pawn and world dynamic collision object types
 	FCollisionObjectQueryParams ObjectParams;
 	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
 	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
 
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(MeleeTraceRadius);
-
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
+	// only factions we're hostile to can be hit
+	const uint32 TargetFactions = UCombatFactionSubsystem::GetMatrix(this).GetTargetMask(Faction);
 
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// sweep a sphere against the damageable grid, ignoring self
+	if (UCombatDamageableGrid::SweepDamageables(this, OutHits, TraceStart, TraceEnd, MeleeTraceRadius, ObjectParams, this, TargetFactions))
 	{
 		// iterate over each object hit
 		for (const FHitResult& CurrentHit : OutHits)
 		{
+			// skip targets we've already hit this swing
+			if (!SwingTracker.RegisterHit(CurrentHit.GetActor(), CurrentHit.Item))
+			{
+				continue;
+			}
+
 			// check if we've hit a damageable actor
 			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
 
@@ -288,7 +352,7 @@ void ACombatCharacter::DoAttackTrace(FName DamageSourceBone)
 				const FVector Impulse = (CurrentHit.ImpactNormal * -MeleeKnockbackImpulse) + (FVector::UpVector * MeleeLaunchImpulse);
 
 				// pass the damage event to the actor
-				Damageable->ApplyDamage(MeleeDamage, this, CurrentHit.ImpactPoint, Impulse);
+				Damageable->ApplyHitDamage(MeleeDamage, this, CurrentHit, Impulse);
 
 				// call the BP handler to play effects, etc.
 				DealtDamage(MeleeDamage, CurrentHit.ImpactPoint);
@@ -341,39 +405,10 @@ void ACombatCharacter::CheckChargedAttack()
 
 void ACombatCharacter::NotifyEnemiesOfIncomingAttack()
 {
-	// sweep for objects in front of the character to be hit by the attack
-	TArray<FHitResult> OutHits;
-
-	// start at the actor location, sweep forward
-	const FVector TraceStart = GetActorLocation();
-	const FVector TraceEnd = TraceStart + (GetActorForwardVector() * DangerTraceDistance);
-
-	// check for pawn object types only
-	FCollisionObjectQueryParams ObjectParams;
-	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
-
-	// use a sphere shape for the sweep
-	FCollisionShape CollisionShape;
-	CollisionShape.SetSphere(DangerTraceRadius);
-
-	// ignore self
-	FCollisionQueryParams QueryParams;
-	QueryParams.AddIgnoredActor(this);
-
-	if (GetWorld()->SweepMultiByObjectType(OutHits, TraceStart, TraceEnd, FQuat::Identity, ObjectParams, CollisionShape, QueryParams))
+	// publish the attack to the threat field. Enemies look it up when their AI checks for danger
+	if (UCombatThreatSubsystem* ThreatField = UCombatThreatSubsystem::Get(this))
 	{
-		// iterate over each object hit
-		for (const FHitResult& CurrentHit : OutHits)
-		{
-			// check if we've hit a damageable actor
-			ICombatDamageable* Damageable = Cast<ICombatDamageable>(CurrentHit.GetActor());
-
-			if (Damageable)
-			{
-				// notify the enemy
-				Damageable->NotifyDanger(GetActorLocation(), this);
-			}
-		}
+		ThreatField->PublishThreat(this, GetActorLocation(), GetActorForwardVector(), DangerTraceDistance, DangerTraceRadius, DangerLifetime);
 	}
 }
 
@@ -389,6 +424,12 @@ void ACombatCharacter::ApplyDamage(float Damage, AActor* DamageCauser, const FVe
 		// apply the knockback impulse
 		GetCharacterMovement()->AddImpulse(DamageImpulse, true);
 
+		// flinch if we survived the hit
+		if (CurrentHP > 0.0f)
+		{
+			PlayHitReaction(DamageImpulse);
+		}
+
 		// is the character ragdolling?
 		if (GetMesh()->IsSimulatingPhysics())
 		{
@@ -411,7 +452,10 @@ void ACombatCharacter::HandleDeath()
 	GetMesh()->SetSimulatePhysics(true);
 
 	// hide the life bar
-	LifeBar->SetHiddenInGame(true);
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->SetVisible(LifeBarHandle, false);
+	}
 
 	// pull back the camera
 	GetCameraBoom()->TargetArmLength = DeathCameraDistance;
@@ -430,16 +474,87 @@ void ACombatCharacter::NotifyDanger(const FVector& DangerLocation, AActor* Dange
 	// stub
 }
 
+ECombatFaction ACombatCharacter::GetFaction() const
+{
+	return Faction;
+}
+
 void ACombatCharacter::RespawnCharacter()
 {
+	// let the Player Controller reuse this character if it can
+	if (ACombatPlayerController* PC = Cast<ACombatPlayerController>(GetController()))
+	{
+		if (PC->RespawnInPlace(this))
+		{
+			return;
+		}
+	}
+
 	// destroy the character and let it be respawned by the Player Controller
 	Destroy();
 }
 
+void ACombatCharacter::ResetForRespawn(const FTransform& SpawnTransform)
+{
+	// make sure a pending respawn doesn't fire again
+	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	// stop any attacks that were in progress when we died
+	if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+	{
+		AnimInstance->StopAllMontages(0.0f);
+	}
+
+	SwingTracker.End();
+	bIsAttacking = false;
+	bIsChargingAttack = false;
+	bHasLoopedChargedAttack = false;
+	ComboCount = 0;
+	CachedAttackInputTime = 0.0f;
+
+	// disable ragdoll physics and hit reactions
+	if (UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+	{
+		RagdollBudget->UnregisterRagdoll(GetMesh());
+	}
+
+	GetMesh()->SetSimulatePhysics(false);
+	GetMesh()->SetPhysicsBlendWeight(0.0f);
+	HitReaction->ResetHitReactions();
+
+	// simulating physics detaches the mesh, so reattach it and restore its original relative transform
+	GetMesh()->AttachToComponent(GetCapsuleComponent(), FAttachmentTransformRules::KeepRelativeTransform);
+	GetMesh()->SetRelativeTransform(MeshStartingTransform);
+
+	// move to the respawn point
+	TeleportTo(SpawnTransform.GetLocation(), SpawnTransform.Rotator(), false, true);
+
+	if (AController* OwningController = GetController())
+	{
+		OwningController->SetControlRotation(SpawnTransform.Rotator());
+	}
+
+	// re-enable movement
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+
+	// reset the camera
+	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
+
+	// show the life bar again
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->SetVisible(LifeBarHandle, true);
+	}
+
+	// reset HP to maximum
+	ResetHP();
+}
+
 float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	// only process damage if the character is still alive
-	if (CurrentHP <= 0.0f)
+	// only process damage if the character is still alive and can be hurt at all
+	if (CurrentHP <= 0.0f || !CanBeDamaged())
 	{
 		return 0.0f;
 	}
@@ -456,11 +571,11 @@ float ACombatCharacter::TakeDamage(float Damage, struct FDamageEvent const& Dama
 	else
 	{
 		// update the life bar
-		LifeBarWidget->SetLifePercentage(CurrentHP / MaxHP);
+		if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+		{
+			HealthBars->SetPercent(LifeBarHandle, CurrentHP / MaxHP);
+		}
 
-		// enable partial ragdoll physics, but keep the pelvis vertical
-		GetMesh()->SetPhysicsBlendWeight(0.5f);
-		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
 	}
 
 	// return the received damage amount
@@ -474,30 +589,79 @@ void ACombatCharacter::Landed(const FHitResult& Hit)
 	// is the character still alive?
 	if (CurrentHP >= 0.0f)
 	{
-		// disable ragdoll physics
-		GetMesh()->SetPhysicsBlendWeight(0.0f);
+		// end any partial ragdoll hit reaction
+		if (UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this))
+		{
+			RagdollBudget->EndPhysicsHitReaction(GetMesh());
+
+		} else {
+
+			GetMesh()->SetPhysicsBlendWeight(0.0f);
+		}
+	}
+}
+
+void ACombatCharacter::PlayHitReaction(const FVector& DamageImpulse)
+{
+	// let the budget pick the few hits that get a partial ragdoll
+	UCombatRagdollSubsystem* RagdollBudget = UCombatRagdollSubsystem::Get(this);
+
+	if (RagdollBudget)
+	{
+		if (RagdollBudget->TryStartPhysicsHitReaction(GetMesh(), PelvisBoneName))
+		{
+			return;
+		}
+
+	} else {
+
+		// enable partial ragdoll physics, but keep the pelvis vertical
+		GetMesh()->SetPhysicsBlendWeight(0.5f);
+		GetMesh()->SetBodySimulatePhysics(PelvisBoneName, false);
+		return;
 	}
+
+	// otherwise flinch procedurally in the anim graph
+	// if the mesh isn't set up for it, the hit gets no reaction rather than going over the physics budget
+	HitReaction->AddHitReaction(DamageImpulse.GetSafeNormal());
 }
 
 void ACombatCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// get the life bar from the widget component
-	LifeBarWidget = Cast<UCombatLifeBar>(LifeBar->GetUserWidgetObject());
-	check(LifeBarWidget);
-
 	// initialize the camera
 	GetCameraBoom()->TargetArmLength = DefaultCameraDistance;
 
 	// save the relative transform for the mesh so we can reset the ragdoll later
 	MeshStartingTransform = GetMesh()->GetRelativeTransform();
 
-	// set the life bar color
-	LifeBarWidget->SetBarColor(LifeBarColor);
+	// add our life bar to the batched health bar list
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		LifeBarHandle = HealthBars->RegisterBar(GetRootComponent(), LifeBarOffset, LifeBarColor);
+	}
 
 	// reset HP to maximum
 	ResetHP();
+
+	// add ourselves to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Register(this, GetCapsuleComponent());
+	}
+
+	// register with the significance manager. Player controlled pawns always stay at full tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this, false);
+	}
+
+	// let hostile AI pick us as a target under our faction
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->RegisterTarget(this, 1u << static_cast<uint32>(Faction));
+	}
 }
 
 void ACombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
@@ -506,6 +670,30 @@ void ACombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
 	// clear the respawn timer
 	GetWorld()->GetTimerManager().ClearTimer(RespawnTimer);
+
+	// remove our life bar
+	if (UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this))
+	{
+		HealthBars->UnregisterBar(LifeBarHandle);
+	}
+
+	// remove ourselves from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Unregister(this);
+	}
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
+
+	// stop being targeted
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->UnregisterTarget(this);
+	}
 }
 
 void ACombatCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
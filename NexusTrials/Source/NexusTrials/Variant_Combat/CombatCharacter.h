@@ -6,15 +6,15 @@
 #include "GameFramework/Character.h"
 #include "CombatAttacker.h"
 #include "CombatDamageable.h"
+#include "CombatSwingTracker.h"
 #include "Animation/AnimInstance.h"
 #include "CombatCharacter.generated.h"
 
 class USpringArmComponent;
 class UCameraComponent;
+class UCombatHitReactionComponent;
 class UInputAction;
 struct FInputActionValue;
-class UCombatLifeBar;
-class UWidgetComponent;
 
 DECLARE_LOG_CATEGORY_EXTERN(LogCombatCharacter, Log, All);
 
@@ -39,9 +39,9 @@ class ACombatCharacter : public ACharacter, public ICombatAttacker, public IComb
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FollowCamera;
 
-	/** Life bar widget component */
+	/** Procedural hit reactions */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
-	UWidgetComponent* LifeBar;
+	UCombatHitReactionComponent* HitReaction;
 	
 protected:
 
@@ -73,6 +73,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category ="Input")
 	UInputAction* ToggleCameraAction;
 
+	/** Side this character fights for. Decides who its attacks can hit */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Faction")
+	ECombatFaction Faction = ECombatFaction::Player;
+
 	/** Max amount of HP the character will have on respawn */
 	UPROPERTY(EditAnywhere, Category="Damage", meta = (ClampMin = 0, ClampMax = 100))
 	float MaxHP = 5.0f;
@@ -81,17 +85,20 @@ protected:
 	UPROPERTY(VisibleAnywhere, Category="Damage")
 	float CurrentHP = 0.0f;
 
-	/** Life bar widget fill color */
+	/** Life bar fill color */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FLinearColor LifeBarColor;
 
+	/** Life bar position, relative to the actor */
+	UPROPERTY(EditAnywhere, Category="Damage")
+	FVector LifeBarOffset = FVector(0.0f, 0.0f, 120.0f);
+
 	/** Name of the pelvis bone, for damage ragdoll physics */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	FName PelvisBoneName;
 
-	/** Pointer to the life bar widget */
-	UPROPERTY(EditAnywhere, Category="Damage")
-	TObjectPtr<UCombatLifeBar> LifeBarWidget;
+	/** Handle to our entry in the batched health bar list */
+	int32 LifeBarHandle = INDEX_NONE;
 
 	/** Max amount of time that may elapse for a non-combo attack input to not be considered stale */
 	UPROPERTY(EditAnywhere, Category="Melee Attack", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
@@ -111,6 +118,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 200, Units = "cm"))
 	float MeleeTraceRadius = 75.0f;
 
+	/** Max distance between sampled points of the attack bone's path inside an attack window */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 5, ClampMax = 200, Units = "cm"))
+	float SwingSampleSpacing = 25.0f;
+
+	/** Path sampling and hit list for the current swing */
+	FCombatSwingTracker SwingTracker;
+
 	/** Distance ahead of the character that enemies will be notified of incoming attacks */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 500, Units="cm"))
 	float DangerTraceDistance = 300.0f;
@@ -119,6 +133,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 200, Units = "cm"))
 	float DangerTraceRadius = 100.0f;
 
+	/** How long enemies can perceive an incoming attack after it's been started. Should cover the enemy's max reaction time */
+	UPROPERTY(EditAnywhere, Category="Melee Attack|Trace", meta = (ClampMin = 0, ClampMax = 5, Units = "s"))
+	float DangerLifetime = 1.0f;
+
 	/** Amount of damage a melee attack will deal */
 	UPROPERTY(EditAnywhere, Category="Melee Attack|Damage", meta = (ClampMin = 0, ClampMax = 100))
 	float MeleeDamage = 1.0f;
@@ -254,6 +272,12 @@ protected:
 	/** Called from a delegate when the attack montage ends */
 	void AttackMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
+	/** Sweeps one segment of an attack and damages anything hit for the first time this swing */
+	void SweepAttackSegment(const FVector& TraceStart, const FVector& TraceEnd);
+
+	/** Flinches from a non-lethal hit. Uses a partial ragdoll if the physics budget allows it, a procedural reaction otherwise, and never goes over the budget */
+	void PlayHitReaction(const FVector& DamageImpulse);
+
 	
 public:
 
@@ -262,6 +286,15 @@ public:
 	/** Performs the collision check for an attack */
 	virtual void DoAttackTrace(FName DamageSourceBone) override;
 
+	/** Opens an attack window for the provided bone */
+	virtual void BeginAttackWindow(FName DamageSourceBone) override;
+
+	/** Sweeps the bone's path since the last window update */
+	virtual void TickAttackWindow(FName DamageSourceBone) override;
+
+	/** Sweeps the rest of the bone's path and closes the attack window */
+	virtual void EndAttackWindow(FName DamageSourceBone) override;
+
 	/** Performs the combo string check */
 	virtual void CheckCombo() override;
 
@@ -272,7 +305,7 @@ public:
 
 	// ~begin CombatDamageable interface
 
-	/** Notifies nearby enemies that an attack is coming so they can react */
+	/** Publishes the incoming attack to the world threat field so nearby enemies can react */
 	void NotifyEnemiesOfIncomingAttack();
 
 	/** Handles damage and knockback events */
@@ -287,11 +320,17 @@ public:
 	/** Allows reaction to incoming attacks */
 	virtual void NotifyDanger(const FVector& DangerLocation, AActor* DangerSource) override;
 
+	/** Returns the side this character fights for */
+	virtual ECombatFaction GetFaction() const override;
+
 	// ~end CombatDamageable interface
 
-	/** Called from the respawn timer to destroy and re-create the character */
+	/** Called from the respawn timer. Resets the character in place if the controller allows it, otherwise destroys it so it can be re-created */
 	void RespawnCharacter();
 
+	/** Brings the character back to life at the provided transform without destroying it */
+	void ResetForRespawn(const FTransform& SpawnTransform);
+
 public:
 
 	/** Overrides the default TakeDamage functionality */
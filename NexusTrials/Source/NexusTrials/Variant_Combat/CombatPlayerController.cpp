@@ -7,12 +7,16 @@
 #include "Kismet/GameplayStatics.h"
 #include "GameFramework/PlayerStart.h"
 #include "CombatCharacter.h"
+#include "CombatSnapshotSubsystem.h"
 #include "Engine/LocalPlayer.h"
 #include "Engine/World.h"
 #include "Blueprint/UserWidget.h"
 #include "NexusTrials.h"
 #include "Widgets/Input/SVirtualJoystick.h"
 
+DECLARE_CYCLE_STAT(TEXT("Respawn In Place"), STAT_CombatRespawnInPlace, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Respawn Spawn Actor"), STAT_CombatRespawnSpawnActor, STATGROUP_NexusTrials);
+
 void ACombatPlayerController::BeginPlay()
 {
 	Super::BeginPlay();
@@ -78,8 +82,30 @@ void ACombatPlayerController::SetRespawnTransform(const FTransform& NewRespawn)
 	RespawnTransform = NewRespawn;
 }
 
+bool ACombatPlayerController::RespawnInPlace(ACombatCharacter* DeadCharacter)
+{
+	// ignore if in-place respawning is disabled or we don't own this character
+	if (!bRespawnInPlace || !IsValid(DeadCharacter) || DeadCharacter != GetPawn())
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatRespawnInPlace);
+
+	RestoreCheckpointSnapshot();
+
+	// reset the character and move it to the respawn transform
+	DeadCharacter->ResetForRespawn(RespawnTransform);
+
+	return true;
+}
+
 void ACombatPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 {
+	SCOPE_CYCLE_COUNTER(STAT_CombatRespawnSpawnActor);
+
+	RestoreCheckpointSnapshot();
+
 	// spawn a new character at the respawn transform
 	if (ACombatCharacter* RespawnedCharacter = GetWorld()->SpawnActor<ACombatCharacter>(CharacterClass, RespawnTransform))
 	{
@@ -88,6 +114,15 @@ void ACombatPlayerController::OnPawnDestroyed(AActor* DestroyedActor)
 	}
 }
 
+void ACombatPlayerController::RestoreCheckpointSnapshot()
+{
+	// put the arena back the way it was when we reached the checkpoint
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RestoreSnapshot();
+	}
+}
+
 bool ACombatPlayerController::ShouldUseTouchControls() const
 {
 	// are we on a mobile platform? Should we force touch?
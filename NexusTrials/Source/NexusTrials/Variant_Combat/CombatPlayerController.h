@@ -13,6 +13,7 @@ class ACombatCharacter;
  *  Simple Player Controller for a third person combat game
  *  Manages input mappings
  *  Respawns the player character at the checkpoint when it's destroyed
+ *  Respawning also restores the arena snapshot captured at the checkpoint, if any
  */
 UCLASS(abstract, Config="Game")
 class ACombatPlayerController : public APlayerController
@@ -45,6 +46,10 @@ protected:
 	UPROPERTY(EditAnywhere, Category="Respawn")
 	TSubclassOf<ACombatCharacter> CharacterClass;
 
+	/** If true, a dead character is reset and moved to the respawn transform instead of being destroyed and re-spawned */
+	UPROPERTY(EditAnywhere, Config, Category="Respawn")
+	bool bRespawnInPlace = true;
+
 	/** Transform to respawn the character at. Can be set to create checkpoints */
 	FTransform RespawnTransform;
 
@@ -64,12 +69,21 @@ public:
 	/** Updates the character respawn transform */
 	void SetRespawnTransform(const FTransform& NewRespawn);
 
+	/**
+	 *  Reuses the possessed character for a respawn instead of destroying it.
+	 *  Returns false if in-place respawning is disabled, so the caller can fall back to destroying the character.
+	 */
+	bool RespawnInPlace(ACombatCharacter* DeadCharacter);
+
 protected:
 
 	/** Called if the possessed pawn is destroyed */
 	UFUNCTION()
 	void OnPawnDestroyed(AActor* DestroyedActor);
 
+	/** Restores the arena to the state it was in when the last checkpoint was reached */
+	void RestoreCheckpointSnapshot();
+
 	/** Returns true if the player should use UMG touch controls */
 	bool ShouldUseTouchControls() const;
 
@@ -4,6 +4,7 @@
 #include "CombatCheckpointVolume.h"
 #include "CombatCharacter.h"
 #include "CombatPlayerController.h"
+#include "CombatSnapshotSubsystem.h"
 
 ACombatCheckpointVolume::ACombatCheckpointVolume()
 {
@@ -41,7 +42,39 @@ void ACombatCheckpointVolume::OnOverlap(UPrimitiveComponent* OverlappedComponent
 
 			// update the player's respawn checkpoint
 			PC->SetRespawnTransform(PlayerCharacter->GetActorTransform());
+
+			// save the arena as it is now, so respawning restores it instead of reloading the level
+			if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+			{
+				Snapshots->CaptureSnapshot();
+			}
 		}
 
 	}
 }
+
+void ACombatCheckpointVolume::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// checkpoints reached after a snapshot are made available again when it's restored
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
+}
+
+void ACombatCheckpointVolume::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
+}
+
+void ACombatCheckpointVolume::SerializeSnapshot(FArchive& Ar)
+{
+	Ar << bCheckpointUsed;
+}
@@ -5,10 +5,15 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Components/BoxComponent.h"
+#include "CombatSnapshotable.h"
 #include "CombatCheckpointVolume.generated.h"
 
+/**
+ *  A volume that saves the player's respawn point when entered,
+ *  and captures an arena snapshot so respawning restores the arena to how it was at this point
+ */
 UCLASS(abstract)
-class ACombatCheckpointVolume : public AActor
+class ACombatCheckpointVolume : public AActor, public ICombatSnapshotable
 {
 	GENERATED_BODY()
 	
@@ -29,4 +34,19 @@ protected:
 	/** Handles overlaps with the box volume */
 	UFUNCTION()
 	void OnOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	/** Initialization */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+public:
+
+	// ~begin ICombatSnapshotable interface
+
+	/** Saves or restores whether the checkpoint has been used */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	// ~end ICombatSnapshotable interface
 };
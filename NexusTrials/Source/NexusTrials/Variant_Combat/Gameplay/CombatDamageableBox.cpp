@@ -5,6 +5,9 @@
 #include "Components/StaticMeshComponent.h"
 #include "TimerManager.h"
 #include "Engine/World.h"
+#include "CombatDamageableGrid.h"
+#include "CombatDamageableBoxField.h"
+#include "CombatSnapshotSubsystem.h"
 
 ACombatDamageableBox::ACombatDamageableBox()
 {
@@ -25,20 +28,123 @@ ACombatDamageableBox::ACombatDamageableBox()
 
 void ACombatDamageableBox::RemoveFromLevel()
 {
+	// go back to the pool of the field we were promoted from
+	if (ACombatDamageableBoxField* Field = OwningField.Get())
+	{
+		Field->ReleaseBox(this);
+		return;
+	}
+
+	// stay around hidden so an arena snapshot restore can bring us back
+	if (UCombatSnapshotSubsystem::Get(this) && UCombatSnapshotSubsystem::IsSnapshotEnabled())
+	{
+		DeactivateForPool();
+		return;
+	}
+
 	// destroy this actor
 	Destroy();
 }
 
+void ACombatDamageableBox::DeactivateForPool()
+{
+	// clear the death timer in case we're pooled before it fires
+	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// remove ourselves from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Unregister(this);
+	}
+
+	// stop simulating and hide
+	Mesh->SetSimulatePhysics(false);
+
+	SetActorHiddenInGame(true);
+	SetActorEnableCollision(false);
+}
+
+void ACombatDamageableBox::ActivateFromPool(const FTransform& SpawnTransform)
+{
+	// reset HP and collision
+	CurrentHP = StartingHP;
+	PromotingCauser.Reset();
+	Mesh->SetCollisionObjectType(StartingObjectType);
+
+	// move into place with no leftover motion
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+
+	Mesh->SetSimulatePhysics(true);
+	Mesh->SetPhysicsLinearVelocity(FVector::ZeroVector);
+	Mesh->SetPhysicsAngularVelocityInDegrees(FVector::ZeroVector);
+
+	// add ourselves back to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Register(this, Mesh);
+	}
+}
+
+void ACombatDamageableBox::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// save the starting state so we can be reused by a box field
+	StartingHP = CurrentHP;
+	StartingObjectType = Mesh->GetCollisionObjectType();
+
+	// add ourselves to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Register(this, Mesh);
+	}
+
+	// save our state with the arena snapshot
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
+}
+
 void ACombatDamageableBox::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the death timer
 	GetWorld()->GetTimerManager().ClearTimer(DeathTimer);
+
+	// remove ourselves from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Unregister(this);
+	}
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
+}
+
+void ACombatDamageableBox::ApplyPromotionDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse, float GuardTime)
+{
+	ApplyDamage(Damage, DamageCauser, DamageLocation, DamageImpulse);
+
+	// the rest of the swing would find us again as a new actor
+	PromotingCauser = DamageCauser;
+	PromotionGuardEndTime = GetWorld()->GetTimeSeconds() + GuardTime;
 }
 
 void ACombatDamageableBox::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	// ignore the remainder of the swing that promoted us from a box field
+	if (DamageCauser && DamageCauser == PromotingCauser.Get() && GetWorld()->GetTimeSeconds() < PromotionGuardEndTime)
+	{
+		return;
+	}
+
 	// only process damage if we still have HP
 	if (CurrentHP > 0.0f)
 	{
@@ -81,3 +187,50 @@ void ACombatDamageableBox::NotifyDanger(const FVector& DangerLocation, AActor* D
 	// stub
 }
 
+void ACombatDamageableBox::SerializeSnapshot(FArchive& Ar)
+{
+	// boxes that are breaking apart are on their way out, so they're saved as removed
+	bool bIntact = !IsHidden() && CurrentHP > 0.0f;
+	FTransform BoxTransform = GetActorTransform();
+	float SavedHP = CurrentHP;
+
+	Ar << bIntact;
+	Ar << BoxTransform;
+	Ar << SavedHP;
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	if (bIntact)
+	{
+		// reset from wherever we are now, clearing any pending removal
+		if (IsHidden())
+		{
+			if (ACombatDamageableBoxField* Field = OwningField.Get())
+			{
+				Field->RemoveFromPool(this);
+			}
+
+		} else {
+
+			DeactivateForPool();
+		}
+
+		ActivateFromPool(BoxTransform);
+		CurrentHP = SavedHP;
+
+	} else if (!IsHidden()) {
+
+		RemoveFromLevel();
+	}
+}
+
+void ACombatDamageableBox::DiscardForSnapshot()
+{
+	if (!IsHidden())
+	{
+		RemoveFromLevel();
+	}
+}
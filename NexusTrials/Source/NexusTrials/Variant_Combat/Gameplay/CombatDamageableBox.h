@@ -5,13 +5,17 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "CombatDamageable.h"
+#include "CombatSnapshotable.h"
 #include "CombatDamageableBox.generated.h"
 
+class ACombatDamageableBoxField;
+
 /**
  *  A simple physics box that reacts to damage through the ICombatDamageable interface
+ *  While arena snapshots are enabled, destroyed boxes are hidden instead of removed so a restore can bring them back
  */
 UCLASS(abstract)
-class ACombatDamageableBox : public AActor, public ICombatDamageable
+class ACombatDamageableBox : public AActor, public ICombatDamageable, public ICombatSnapshotable
 {
 	GENERATED_BODY()
 	
@@ -37,6 +41,21 @@ protected:
 	/** Timer to defer destruction of this box after its HP are depleted */
 	FTimerHandle DeathTimer;
 
+	/** HP the box had on BeginPlay, restored when reused from a box field's pool */
+	float StartingHP = 0.0f;
+
+	/** Collision object type the box had on BeginPlay, restored when reused from a box field's pool */
+	TEnumAsByte<ECollisionChannel> StartingObjectType = ECC_WorldDynamic;
+
+	/** Box field this box was promoted from, if any. Dead boxes are returned to it instead of being destroyed */
+	TWeakObjectPtr<ACombatDamageableBoxField> OwningField;
+
+	/** Attacker whose hit promoted this box. Its swing already damaged us through the field, so its next sweeps are ignored briefly */
+	TWeakObjectPtr<AActor> PromotingCauser;
+
+	/** Time until which damage from the promoting attacker is ignored */
+	float PromotionGuardEndTime = 0.0f;
+
 	/** Blueprint damage handler for effect playback */
 	UFUNCTION(BlueprintImplementableEvent, Category="Damage")
 	void OnBoxDamaged(const FVector& DamageLocation, const FVector& DamageImpulse);
@@ -50,6 +69,24 @@ protected:
 
 public:
 
+	/** Returns the box mesh */
+	UStaticMeshComponent* GetMesh() const { return Mesh; }
+
+	/** Sets the box field this box was promoted from */
+	void SetOwningField(ACombatDamageableBoxField* Field) { OwningField = Field; }
+
+	/** Puts the box to sleep so it can wait in a box field's pool */
+	void DeactivateForPool();
+
+	/** Wakes a pooled box up at the provided transform with its HP and collision reset */
+	void ActivateFromPool(const FTransform& SpawnTransform);
+
+	/** Applies the damage that caused a box field to promote this box, and ignores the rest of that attacker's swing */
+	void ApplyPromotionDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse, float GuardTime);
+
+	/** BeginPlay initialization */
+	virtual void BeginPlay() override;
+
 	/** EndPlay cleanup */
 	void EndPlay(EEndPlayReason::Type EndPlayReason) override;
 
@@ -68,4 +105,14 @@ public:
 	virtual void NotifyDanger(const FVector& DangerLocation, AActor* DangerSource) override;
 
 	// ~End CombatDamageable interface
+
+	// ~Begin CombatSnapshotable interface
+
+	/** Saves or restores whether the box is intact, its transform and HP */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	/** Removes the box if it was promoted after the snapshot was captured */
+	virtual void DiscardForSnapshot() override;
+
+	// ~End CombatSnapshotable interface
 };
@@ -0,0 +1,359 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatDamageableBoxField.h"
+#include "CombatDamageableBox.h"
+#include "CombatDamageableGrid.h"
+#include "CombatSnapshotSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Box Promote"), STAT_CombatBoxPromote, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Promoted Boxes"), STAT_CombatPromotedBoxes, STATGROUP_NexusTrials);
+
+ACombatDamageableBoxField::ACombatDamageableBoxField()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	// create the instanced mesh
+	RootComponent = Boxes = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Boxes"));
+
+	// intact boxes block like the promoted ones do, but never simulate
+	Boxes->SetCollisionProfileName(FName("BlockAllDynamic"));
+
+	// we need hit events to know when something bumps into a box
+	Boxes->SetNotifyRigidBodyCollision(true);
+
+	// disable navigation relevance so boxes don't affect NavMesh generation
+	Boxes->bNavigationRelevant = false;
+}
+
+void ACombatDamageableBoxField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	// draw the instances with the same mesh and materials as the promoted box
+	if (IsValid(BoxClass))
+	{
+		const UStaticMeshComponent* BoxMesh = BoxClass->GetDefaultObject<ACombatDamageableBox>()->GetMesh();
+
+		Boxes->SetStaticMesh(BoxMesh->GetStaticMesh());
+
+		for (int32 MaterialIndex = 0; MaterialIndex < BoxMesh->GetNumMaterials(); ++MaterialIndex)
+		{
+			Boxes->SetMaterial(MaterialIndex, BoxMesh->GetMaterial(MaterialIndex));
+		}
+	}
+}
+
+void ACombatDamageableBoxField::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// listen for physics bumping into the boxes
+	Boxes->OnComponentHit.AddDynamic(this, &ACombatDamageableBoxField::OnBoxesHit);
+
+	RegisterIntactBoxes();
+
+	// create the promoted boxes up front, so the first hit doesn't spawn an actor
+	if (IsValid(BoxClass))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		while (FreeBoxes.Num() < PoolSize)
+		{
+			ACombatDamageableBox* Box = GetWorld()->SpawnActor<ACombatDamageableBox>(BoxClass, GetActorTransform(), SpawnParams);
+
+			if (!Box)
+			{
+				break;
+			}
+
+			Box->SetOwningField(this);
+			Box->DeactivateForPool();
+			FreeBoxes.Add(Box);
+		}
+	}
+
+	// save the intact boxes with the arena snapshot
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->RegisterActor(this);
+	}
+}
+
+void ACombatDamageableBoxField::EndPlay(EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+
+	UnregisterIntactBoxes();
+
+	GridHandles.Empty();
+
+	if (UCombatSnapshotSubsystem* Snapshots = UCombatSnapshotSubsystem::Get(this))
+	{
+		Snapshots->UnregisterActor(this);
+	}
+}
+
+void ACombatDamageableBoxField::RegisterIntactBoxes()
+{
+	// add each intact box to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		const UStaticMesh* StaticMesh = Boxes->GetStaticMesh();
+
+		GridHandles.SetNumUninitialized(Boxes->GetInstanceCount());
+
+		for (int32 InstanceIndex = 0; InstanceIndex < GridHandles.Num(); ++InstanceIndex)
+		{
+			FTransform InstanceTransform;
+			Boxes->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+
+			GridHandles[InstanceIndex] = StaticMesh ? Grid->RegisterStatic(this, Boxes, StaticMesh->GetBounds().TransformBy(InstanceTransform)) : INDEX_NONE;
+		}
+	}
+}
+
+void ACombatDamageableBoxField::UnregisterIntactBoxes()
+{
+	// remove the intact boxes from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		for (int32& GridHandle : GridHandles)
+		{
+			Grid->UnregisterStatic(GridHandle);
+		}
+	}
+
+	GridHandles.Reset();
+}
+
+int32 ACombatDamageableBoxField::GetNumIntactBoxes() const
+{
+	return Boxes->GetInstanceCount();
+}
+
+int32 ACombatDamageableBoxField::FindBoxAt(const FVector& Location) const
+{
+	const UStaticMesh* StaticMesh = Boxes->GetStaticMesh();
+
+	if (!StaticMesh)
+	{
+		return INDEX_NONE;
+	}
+
+	// hits are rare, so a linear scan over the field is cheaper than keeping another index around
+	const FBoxSphereBounds MeshBounds = StaticMesh->GetBounds();
+
+	int32 ClosestIndex = INDEX_NONE;
+	float ClosestDistanceSquared = TNumericLimits<float>::Max();
+
+	for (int32 InstanceIndex = 0; InstanceIndex < Boxes->GetInstanceCount(); ++InstanceIndex)
+	{
+		FTransform InstanceTransform;
+		Boxes->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+
+		const FBoxSphereBounds InstanceBounds = MeshBounds.TransformBy(InstanceTransform);
+		const float DistanceSquared = static_cast<float>(FVector::DistSquared(Location, InstanceBounds.Origin));
+
+		// only consider boxes the location could actually be touching
+		if (DistanceSquared <= FMath::Square(InstanceBounds.SphereRadius * 1.5f) && DistanceSquared < ClosestDistanceSquared)
+		{
+			ClosestIndex = InstanceIndex;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+
+	return ClosestIndex;
+}
+
+ACombatDamageableBox* ACombatDamageableBoxField::PromoteBox(int32 InstanceIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatBoxPromote);
+
+	if (!IsValid(BoxClass) || InstanceIndex < 0 || InstanceIndex >= Boxes->GetInstanceCount())
+	{
+		return nullptr;
+	}
+
+	FTransform InstanceTransform;
+	Boxes->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+
+	// take the box out of the melee broadphase. Handles are kept in instance order, so they shift along with the instances
+	if (GridHandles.IsValidIndex(InstanceIndex))
+	{
+		if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+		{
+			Grid->UnregisterStatic(GridHandles[InstanceIndex]);
+		}
+
+		GridHandles.RemoveAt(InstanceIndex);
+	}
+
+	Boxes->RemoveInstance(InstanceIndex);
+
+	INC_DWORD_STAT(STAT_CombatPromotedBoxes);
+
+	return AcquireBox(InstanceTransform);
+}
+
+ACombatDamageableBox* ACombatDamageableBoxField::AcquireBox(const FTransform& BoxTransform)
+{
+	// reuse a pooled box if we have one
+	while (FreeBoxes.Num() > 0)
+	{
+		ACombatDamageableBox* Box = FreeBoxes.Pop(EAllowShrinking::No);
+
+		if (IsValid(Box))
+		{
+			Box->ActivateFromPool(BoxTransform);
+			return Box;
+		}
+	}
+
+	// the intact box was occupying this spot, so there's no need to check for encroachment
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ACombatDamageableBox* Box = GetWorld()->SpawnActor<ACombatDamageableBox>(BoxClass, BoxTransform, SpawnParams);
+
+	if (Box)
+	{
+		Box->SetOwningField(this);
+	}
+
+	return Box;
+}
+
+void ACombatDamageableBoxField::ReleaseBox(ACombatDamageableBox* Box)
+{
+	if (!IsValid(Box))
+	{
+		return;
+	}
+
+	// only keep a small pool around
+	if (FreeBoxes.Num() >= PoolSize)
+	{
+		Box->Destroy();
+		return;
+	}
+
+	Box->DeactivateForPool();
+	FreeBoxes.AddUnique(Box);
+}
+
+void ACombatDamageableBoxField::RemoveFromPool(ACombatDamageableBox* Box)
+{
+	FreeBoxes.RemoveSingleSwap(Box, EAllowShrinking::No);
+}
+
+void ACombatDamageableBoxField::OnBoxesHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	// ignore anything resting on or gently brushing the boxes
+	if (!OtherComp || OtherActor == this || OtherComp->GetComponentVelocity().SizeSquared() < FMath::Square(DisturbSpeed))
+	{
+		return;
+	}
+
+	if (PendingDisturbances.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().SetTimerForNextTick(this, &ACombatDamageableBoxField::PromoteDisturbedBoxes);
+	}
+
+	PendingDisturbances.Add(Hit.ImpactPoint);
+}
+
+void ACombatDamageableBoxField::PromoteDisturbedBoxes()
+{
+	for (const FVector& Disturbance : PendingDisturbances)
+	{
+		PromoteBox(FindBoxAt(Disturbance));
+	}
+
+	PendingDisturbances.Reset();
+}
+
+void ACombatDamageableBoxField::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	DamageBox(FindBoxAt(DamageLocation), Damage, DamageCauser, DamageLocation, DamageImpulse);
+}
+
+void ACombatDamageableBoxField::ApplyHitDamage(float Damage, AActor* DamageCauser, const FHitResult& Hit, const FVector& DamageImpulse)
+{
+	// hits without a grid handle come from a physics sweep, so find the box by location instead
+	if (Hit.Item == INDEX_NONE)
+	{
+		ApplyDamage(Damage, DamageCauser, Hit.ImpactPoint, DamageImpulse);
+		return;
+	}
+
+	// handles are kept in instance order. A handle we no longer have belongs to a box promoted earlier in the same sweep
+	DamageBox(GridHandles.IndexOfByKey(Hit.Item), Damage, DamageCauser, Hit.ImpactPoint, DamageImpulse);
+}
+
+void ACombatDamageableBoxField::DamageBox(int32 InstanceIndex, float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
+{
+	// promote the box we hit and pass the damage on to it, so it reacts exactly like a standalone box
+	if (ACombatDamageableBox* Box = PromoteBox(InstanceIndex))
+	{
+		Box->ApplyPromotionDamage(Damage, DamageCauser, DamageLocation, DamageImpulse, PromotionGuardTime);
+	}
+}
+
+void ACombatDamageableBoxField::HandleDeath()
+{
+	// stub
+}
+
+void ACombatDamageableBoxField::ApplyHealing(float Healing, AActor* Healer)
+{
+	// stub
+}
+
+void ACombatDamageableBoxField::NotifyDanger(const FVector& DangerLocation, AActor* DangerSource)
+{
+	// stub
+}
+
+void ACombatDamageableBoxField::SerializeSnapshot(FArchive& Ar)
+{
+	TArray<FTransform> InstanceTransforms;
+
+	if (Ar.IsSaving())
+	{
+		InstanceTransforms.SetNumUninitialized(Boxes->GetInstanceCount());
+
+		for (int32 InstanceIndex = 0; InstanceIndex < InstanceTransforms.Num(); ++InstanceIndex)
+		{
+			Boxes->GetInstanceTransform(InstanceIndex, InstanceTransforms[InstanceIndex], false);
+		}
+	}
+
+	Ar << InstanceTransforms;
+
+	if (!Ar.IsLoading())
+	{
+		return;
+	}
+
+	// forget about any disturbances that haven't been promoted yet
+	GetWorld()->GetTimerManager().ClearAllTimersForObject(this);
+	PendingDisturbances.Reset();
+
+	// rebuild the intact boxes in one go
+	UnregisterIntactBoxes();
+
+	Boxes->ClearInstances();
+	Boxes->AddInstances(InstanceTransforms, false, false);
+
+	RegisterIntactBoxes();
+}
@@ -0,0 +1,134 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CombatDamageable.h"
+#include "CombatSnapshotable.h"
+#include "CombatDamageableBoxField.generated.h"
+
+class UInstancedStaticMeshComponent;
+class ACombatDamageableBox;
+
+/**
+ *  A field of damageable boxes drawn as instances of a single instanced static mesh.
+ *  Intact boxes share the instanced mesh's collision and don't simulate physics.
+ *  A box is promoted to a simulating ACombatDamageableBox, taken from a small pool, only when it's hit or disturbed.
+ *  Arena snapshots save the intact boxes, while promoted boxes save themselves.
+ */
+UCLASS()
+class ACombatDamageableBoxField : public AActor, public ICombatDamageable, public ICombatSnapshotable
+{
+	GENERATED_BODY()
+
+	/** Intact boxes */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components", meta = (AllowPrivateAccess = "true"))
+	UInstancedStaticMeshComponent* Boxes;
+
+protected:
+
+	/** Type of box to promote intact boxes to. Its mesh is also used for the instances */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Box Field")
+	TSubclassOf<ACombatDamageableBox> BoxClass;
+
+	/** Number of promoted boxes to create up front, and to keep around for reuse once they're destroyed */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Box Field", meta = (ClampMin = 0, ClampMax = 32))
+	int32 PoolSize = 4;
+
+	/** Anything bumping into an intact box faster than this promotes it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Box Field", meta = (ClampMin = 0, ClampMax = 5000, Units = "cm/s"))
+	float DisturbSpeed = 150.0f;
+
+	/** Time a promoted box ignores further damage from the attacker that promoted it, so the rest of the swing doesn't hit it twice */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category="Box Field", meta = (ClampMin = 0, ClampMax = 2, Units = "s"))
+	float PromotionGuardTime = 0.3f;
+
+	/** Melee broadphase handles for each intact box, in instance order */
+	TArray<int32> GridHandles;
+
+	/** Boxes waiting to be reused */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<ACombatDamageableBox>> FreeBoxes;
+
+	/** Instances disturbed by physics this frame, promoted on the next tick so we don't edit the instances during a hit callback */
+	TArray<FVector> PendingDisturbances;
+
+public:
+
+	/** Constructor */
+	ACombatDamageableBoxField();
+
+	/** Copies the box class mesh onto the instances */
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	/** BeginPlay initialization */
+	virtual void BeginPlay() override;
+
+	/** EndPlay cleanup */
+	virtual void EndPlay(EEndPlayReason::Type EndPlayReason) override;
+
+	/** Returns a destroyed promoted box to the pool */
+	void ReleaseBox(ACombatDamageableBox* Box);
+
+	/** Takes a specific box out of the pool without waking it up, e.g. so a snapshot restore can put it back in play */
+	void RemoveFromPool(ACombatDamageableBox* Box);
+
+	/** Returns the number of intact boxes */
+	int32 GetNumIntactBoxes() const;
+
+protected:
+
+	/** Adds every intact box to the melee broadphase */
+	void RegisterIntactBoxes();
+
+	/** Removes every intact box from the melee broadphase */
+	void UnregisterIntactBoxes();
+
+	/** Returns the intact box closest to the provided location, or INDEX_NONE if none are close enough to have been touched */
+	int32 FindBoxAt(const FVector& Location) const;
+
+	/** Promotes an intact box and passes the damage on to it */
+	void DamageBox(int32 InstanceIndex, float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse);
+
+	/** Replaces an intact box with a simulating actor */
+	ACombatDamageableBox* PromoteBox(int32 InstanceIndex);
+
+	/** Takes a box from the pool, or spawns one */
+	ACombatDamageableBox* AcquireBox(const FTransform& BoxTransform);
+
+	/** Handles physics bumping into the intact boxes */
+	UFUNCTION()
+	void OnBoxesHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	/** Promotes the boxes disturbed by physics */
+	void PromoteDisturbedBoxes();
+
+public:
+
+	// ~Begin CombatDamageable interface
+
+	/** Promotes the box at the damage location and passes the damage on to it */
+	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) override;
+
+	/** Promotes the box the hit's grid handle belongs to and passes the damage on to it */
+	virtual void ApplyHitDamage(float Damage, AActor* DamageCauser, const FHitResult& Hit, const FVector& DamageImpulse) override;
+
+	/** Handles death events */
+	virtual void HandleDeath() override;
+
+	/** Handles healing events */
+	virtual void ApplyHealing(float Healing, AActor* Healer) override;
+
+	/** Allows reaction to incoming attacks */
+	virtual void NotifyDanger(const FVector& DangerLocation, AActor* DangerSource) override;
+
+	// ~End CombatDamageable interface
+
+	// ~Begin CombatSnapshotable interface
+
+	/** Saves or restores the intact boxes */
+	virtual void SerializeSnapshot(FArchive& Ar) override;
+
+	// ~End CombatSnapshotable interface
+};
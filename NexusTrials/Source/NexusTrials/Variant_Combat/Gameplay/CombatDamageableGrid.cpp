@@ -0,0 +1,542 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatDamageableGrid.h"
+#include "CombatMeleeMath.h"
+#include "CombatEncounterDirectorSubsystem.h"
+#include "CombatFactionSubsystem.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Grid Sweep"), STAT_CombatMeleeGridSweep, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Melee Grid Update"), STAT_CombatMeleeGridUpdate, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarMeleeGridEnabled(
+	TEXT("Combat.MeleeGrid.Enable"),
+	true,
+	TEXT("If true, melee attacks resolve against the damageable grid. If false, they sweep the physics scene."));
+
+static FAutoConsoleCommandWithWorldAndArgs CmdMeleeGridBenchmark(
+	TEXT("Combat.MeleeGrid.Benchmark"),
+	TEXT("Times grid and physics melee sweeps around every registered damageable. Usage: Combat.MeleeGrid.Benchmark [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(World))
+		{
+			Grid->RunBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+		}
+	}));
+
+UCombatDamageableGrid* UCombatDamageableGrid::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatDamageableGrid>() : nullptr;
+}
+
+bool UCombatDamageableGrid::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatDamageableGrid::Deinitialize()
+{
+	// unbind from every shape that is still around
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		UnbindShape(It.GetIndex());
+	}
+
+	Entries.Empty();
+	EntryIndices.Empty();
+	Cells.Empty();
+	MaxShapeExtent = 0.0f;
+
+	Super::Deinitialize();
+}
+
+void UCombatDamageableGrid::Register(AActor* Actor, UPrimitiveComponent* Shape)
+{
+	if (!IsValid(Actor) || !IsValid(Shape))
+	{
+		return;
+	}
+
+	// already registered actors just get their shape updated
+	if (EntryIndices.Contains(Actor))
+	{
+		SetShape(Actor, Shape);
+		return;
+	}
+
+	FGridEntry NewEntry;
+	NewEntry.Actor = Actor;
+	NewEntry.Key = Actor;
+	NewEntry.Shape = Shape;
+	NewEntry.Faction = UCombatFactionSubsystem::GetActorFaction(Actor);
+
+	const int32 EntryIndex = Entries.Add(NewEntry);
+	EntryIndices.Add(NewEntry.Key, EntryIndex);
+
+	AddToCell(EntryIndex);
+	BindShape(EntryIndex);
+}
+
+void UCombatDamageableGrid::SetShape(AActor* Actor, UPrimitiveComponent* Shape)
+{
+	const int32* EntryIndex = EntryIndices.Find(Actor);
+
+	if (!EntryIndex || !IsValid(Shape))
+	{
+		return;
+	}
+
+	// swap the shape and re-bucket from its location
+	UnbindShape(*EntryIndex);
+	RemoveFromCell(*EntryIndex);
+
+	const float OldExtent = Entries[*EntryIndex].Extent;
+	Entries[*EntryIndex].Shape = Shape;
+
+	AddToCell(*EntryIndex);
+	BindShape(*EntryIndex);
+
+	// the old shape may have been the largest one
+	if (Entries[*EntryIndex].Extent < OldExtent)
+	{
+		OnExtentRemoved(OldExtent);
+	}
+}
+
+void UCombatDamageableGrid::Unregister(AActor* Actor)
+{
+	if (const int32* EntryIndex = EntryIndices.Find(Actor))
+	{
+		RemoveEntry(*EntryIndex);
+	}
+}
+
+void UCombatDamageableGrid::SetFaction(AActor* Actor, ECombatFaction Faction)
+{
+	if (const int32* EntryIndex = EntryIndices.Find(Actor))
+	{
+		Entries[*EntryIndex].Faction = Faction;
+	}
+}
+
+int32 UCombatDamageableGrid::RegisterStatic(AActor* Actor, UPrimitiveComponent* Component, const FBoxSphereBounds& Bounds)
+{
+	if (!IsValid(Actor) || !IsValid(Component))
+	{
+		return INDEX_NONE;
+	}
+
+	FGridEntry NewEntry;
+	NewEntry.Actor = Actor;
+	NewEntry.Key = Actor;
+	NewEntry.Shape = Component;
+	NewEntry.Faction = UCombatFactionSubsystem::GetActorFaction(Actor);
+	NewEntry.bStatic = true;
+	GetBoundsCapsule(Bounds, NewEntry.StaticA, NewEntry.StaticB, NewEntry.StaticRadius);
+
+	const int32 EntryIndex = Entries.Add(NewEntry);
+
+	// static entries never move, so there's nothing to bind to
+	AddToCell(EntryIndex);
+
+	return EntryIndex;
+}
+
+void UCombatDamageableGrid::UnregisterStatic(int32& EntryHandle)
+{
+	if (Entries.IsValidIndex(EntryHandle) && Entries[EntryHandle].bStatic)
+	{
+		RemoveEntry(EntryHandle);
+	}
+
+	EntryHandle = INDEX_NONE;
+}
+
+void UCombatDamageableGrid::RemoveEntry(int32 EntryIndex)
+{
+	const FGridEntry& Entry = Entries[EntryIndex];
+	const float RemovedExtent = Entry.Extent;
+
+	// static entries aren't in the actor lookup
+	if (!Entry.bStatic)
+	{
+		if (const int32* Mapped = EntryIndices.Find(Entry.Key); Mapped && *Mapped == EntryIndex)
+		{
+			EntryIndices.Remove(Entry.Key);
+		}
+	}
+
+	UnbindShape(EntryIndex);
+	RemoveFromCell(EntryIndex);
+
+	Entries.RemoveAt(EntryIndex);
+
+	OnExtentRemoved(RemovedExtent);
+}
+
+void UCombatDamageableGrid::RemoveStaleEntry(int32 EntryIndex)
+{
+	FGridEntry& Entry = Entries[EntryIndex];
+
+	if (!Entry.bStatic)
+	{
+		RemoveEntry(EntryIndex);
+		return;
+	}
+
+	// a static entry's owner holds its handle, so keep the slot until the handle is released, or a new entry could take it over.
+	// Taking it out of its cell is enough to keep sweeps from finding it again
+	const float RemovedExtent = Entry.Extent;
+
+	RemoveFromCell(EntryIndex);
+	Entry.Extent = 0.0f;
+
+	OnExtentRemoved(RemovedExtent);
+}
+
+void UCombatDamageableGrid::OnExtentRemoved(float RemovedExtent)
+{
+	// only the largest shape going away can shrink the padding
+	if (RemovedExtent < MaxShapeExtent)
+	{
+		return;
+	}
+
+	MaxShapeExtent = 0.0f;
+
+	for (const FGridEntry& Entry : Entries)
+	{
+		MaxShapeExtent = FMath::Max(MaxShapeExtent, Entry.Extent);
+	}
+}
+
+FIntPoint UCombatDamageableGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UCombatDamageableGrid::AddToCell(int32 EntryIndex)
+{
+	FGridEntry& Entry = Entries[EntryIndex];
+
+	if (Entry.bStatic)
+	{
+		Entry.Cell = GetCell((Entry.StaticA + Entry.StaticB) * 0.5f);
+		Entry.Extent = Entry.StaticRadius;
+
+	} else if (const UPrimitiveComponent* Shape = Entry.Shape.Get())
+	{
+		Entry.Cell = GetCell(Shape->GetComponentLocation());
+		Entry.Extent = static_cast<float>(Shape->Bounds.BoxExtent.Size2D());
+	}
+
+	// keep track of the largest shape so queries can be padded enough to catch it from a neighboring cell
+	MaxShapeExtent = FMath::Max(MaxShapeExtent, Entry.Extent);
+
+	Cells.FindOrAdd(Entry.Cell).Add(EntryIndex);
+}
+
+void UCombatDamageableGrid::RemoveFromCell(int32 EntryIndex)
+{
+	const FIntPoint Cell = Entries[EntryIndex].Cell;
+
+	if (TArray<int32, TInlineAllocator<8>>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(EntryIndex, EAllowShrinking::No);
+
+		if (CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void UCombatDamageableGrid::BindShape(int32 EntryIndex)
+{
+	FGridEntry& Entry = Entries[EntryIndex];
+
+	if (UPrimitiveComponent* Shape = Entry.Shape.Get())
+	{
+		Entry.TransformHandle = Shape->TransformUpdated.AddUObject(this, &UCombatDamageableGrid::OnShapeMoved, EntryIndex);
+	}
+}
+
+void UCombatDamageableGrid::UnbindShape(int32 EntryIndex)
+{
+	FGridEntry& Entry = Entries[EntryIndex];
+
+	if (UPrimitiveComponent* Shape = Entry.Shape.Get())
+	{
+		Shape->TransformUpdated.Remove(Entry.TransformHandle);
+	}
+
+	Entry.TransformHandle.Reset();
+}
+
+void UCombatDamageableGrid::OnShapeMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 EntryIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatMeleeGridUpdate);
+
+	// only touch the cell map when the shape actually crosses a cell boundary
+	const FIntPoint NewCell = GetCell(UpdatedComponent->GetComponentLocation());
+
+	if (Entries.IsValidIndex(EntryIndex) && Entries[EntryIndex].Cell != NewCell)
+	{
+		RemoveFromCell(EntryIndex);
+		AddToCell(EntryIndex);
+	}
+}
+
+void UCombatDamageableGrid::GetShapeCapsule(const UPrimitiveComponent* Shape, FVector& OutA, FVector& OutB, float& OutRadius)
+{
+	// use the exact capsule if we have one
+	if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(Shape))
+	{
+		const FVector Center = Capsule->GetComponentLocation();
+		const FVector Axis = Capsule->GetUpVector() * Capsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+
+		OutA = Center - Axis;
+		OutB = Center + Axis;
+		OutRadius = Capsule->GetScaledCapsuleRadius();
+		return;
+	}
+
+	// approximate anything else with an upright capsule around its bounds
+	GetBoundsCapsule(Shape->Bounds, OutA, OutB, OutRadius);
+}
+
+void UCombatDamageableGrid::GetBoundsCapsule(const FBoxSphereBounds& Bounds, FVector& OutA, FVector& OutB, float& OutRadius)
+{
+	OutRadius = static_cast<float>(Bounds.BoxExtent.Size2D());
+
+	const float HalfSegment = FMath::Max(0.0f, static_cast<float>(Bounds.BoxExtent.Z) - OutRadius);
+	OutA = Bounds.Origin - FVector(0.0f, 0.0f, HalfSegment);
+	OutB = Bounds.Origin + FVector(0.0f, 0.0f, HalfSegment);
+}
+
+bool UCombatDamageableGrid::SweepMulti(TNexusFrameArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FCollisionObjectQueryParams& ObjectParams, const AActor* IgnoredActor, uint32 TargetFactionMask)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatMeleeGridSweep);
+	CSV_SCOPED_TIMING_STAT(NexusTrials, MeleeSweep);
+
+	OutHits.Reset();
+
+	// entries that went away without unregistering, dropped once we're done walking the cells
+	TNexusFrameArray<int32> StaleEntries;
+
+	// pad the sweep bounds so shapes centered in neighboring cells are still found
+	const float Padding = Radius + MaxShapeExtent;
+	const FIntPoint MinCell = GetCell(Start.ComponentMin(End) - FVector(Padding));
+	const FIntPoint MaxCell = GetCell(Start.ComponentMax(End) + FVector(Padding));
+
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			const TArray<int32, TInlineAllocator<8>>* CellEntries = Cells.Find(FIntPoint(CellX, CellY));
+
+			if (!CellEntries)
+			{
+				continue;
+			}
+
+			for (const int32 EntryIndex : *CellEntries)
+			{
+				const FGridEntry& Entry = Entries[EntryIndex];
+
+				// skip friendly targets before touching the actor
+				if (!FCombatFactionMatrix::MaskHasFaction(TargetFactionMask, Entry.Faction))
+				{
+					continue;
+				}
+
+				AActor* Actor = Entry.Actor.Get();
+				UPrimitiveComponent* Shape = Entry.Shape.Get();
+
+				if (!Actor || !Shape)
+				{
+					StaleEntries.Add(EntryIndex);
+					continue;
+				}
+
+				if (Actor == IgnoredActor)
+				{
+					continue;
+				}
+
+				// mirror the object type filtering of a physics sweep
+				if (!(ObjectParams.GetObjectTypesToQuery() & ECC_TO_BITFIELD(Shape->GetCollisionObjectType())) || !CollisionEnabledHasQuery(Shape->GetCollisionEnabled()))
+				{
+					continue;
+				}
+
+				FVector CapsuleA, CapsuleB;
+				float CapsuleRadius;
+
+				if (Entry.bStatic)
+				{
+					CapsuleA = Entry.StaticA;
+					CapsuleB = Entry.StaticB;
+					CapsuleRadius = Entry.StaticRadius;
+
+				} else {
+
+					GetShapeCapsule(Shape, CapsuleA, CapsuleB, CapsuleRadius);
+				}
+
+				float Time;
+				FVector ImpactPoint, ImpactNormal;
+
+				if (FCombatMeleeMath::SphereSweepVsCapsule(Start, End, Radius, CapsuleA, CapsuleB, CapsuleRadius, Time, ImpactPoint, ImpactNormal))
+				{
+					FHitResult& Hit = OutHits.Emplace_GetRef(Actor, Shape, ImpactPoint, ImpactNormal);
+					Hit.ImpactNormal = ImpactNormal;
+					Hit.Time = Time;
+					Hit.TraceStart = Start;
+					Hit.TraceEnd = End;
+					Hit.bBlockingHit = false;
+
+					// tell the owner of a static shape which one of its shapes was hit
+					Hit.Item = Entry.bStatic ? EntryIndex : INDEX_NONE;
+				}
+			}
+		}
+	}
+
+	for (const int32 EntryIndex : StaleEntries)
+	{
+		RemoveStaleEntry(EntryIndex);
+	}
+
+	// return hits in sweep order like the physics scene does
+	OutHits.Sort([](const FHitResult& A, const FHitResult& B) { return A.Time < B.Time; });
+
+	return OutHits.Num() > 0;
+}
+
+bool UCombatDamageableGrid::SweepDamageables(const UObject* WorldContextObject, TNexusFrameArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FCollisionObjectQueryParams& ObjectParams, AActor* IgnoredActor, uint32 TargetFactionMask)
+{
+	// count the trace towards the encounter director's load
+	if (UCombatEncounterDirectorSubsystem* Director = UCombatEncounterDirectorSubsystem::Get(WorldContextObject))
+	{
+		Director->NotifyMeleeTrace();
+	}
+
+	// use the grid for the common case
+	if (CVarMeleeGridEnabled.GetValueOnGameThread())
+	{
+		if (UCombatDamageableGrid* Grid = Get(WorldContextObject))
+		{
+			return Grid->SweepMulti(OutHits, Start, End, Radius, ObjectParams, IgnoredActor, TargetFactionMask);
+		}
+	}
+
+	// fall back to sweeping the physics scene
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+
+	if (!World)
+	{
+		return false;
+	}
+
+	FCollisionShape CollisionShape;
+	CollisionShape.SetSphere(Radius);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(IgnoredActor);
+
+	// the physics scene only fills heap arrays, so this path allocates. It's only used to compare against the grid
+	TArray<FHitResult> PhysicsHits;
+	World->SweepMultiByObjectType(PhysicsHits, Start, End, FQuat::Identity, ObjectParams, CollisionShape, QueryParams);
+
+	// apply the same faction filtering the grid does
+	OutHits.Reset();
+
+	for (const FHitResult& Hit : PhysicsHits)
+	{
+		if (FCombatFactionMatrix::MaskHasFaction(TargetFactionMask, UCombatFactionSubsystem::GetActorFaction(Hit.GetActor())))
+		{
+			// physics items are body or instance indices, not grid handles, so targets resolve by impact point on this path
+			OutHits.Add_GetRef(Hit).Item = INDEX_NONE;
+		}
+	}
+
+	return OutHits.Num() > 0;
+}
+
+void UCombatDamageableGrid::RunBenchmark(int32 Iterations)
+{
+	const UWorld* World = GetWorld();
+
+	if (Entries.Num() == 0 || Iterations <= 0 || !World)
+	{
+		UE_LOG(LogNexusTrials, Warning, TEXT("Melee grid benchmark: nothing to do (%d damageables, %d iterations)"), Entries.Num(), Iterations);
+		return;
+	}
+
+	// gather the shape locations so both paths sweep through the same spots
+	TArray<FVector> Targets;
+	for (const FGridEntry& Entry : Entries)
+	{
+		if (Entry.bStatic)
+		{
+			Targets.Add((Entry.StaticA + Entry.StaticB) * 0.5f);
+
+		} else if (const UPrimitiveComponent* Shape = Entry.Shape.Get())
+		{
+			Targets.Add(Shape->GetComponentLocation());
+		}
+	}
+
+	if (Targets.Num() == 0)
+	{
+		return;
+	}
+
+	// use the same query as a melee attack
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+
+	const float SweepRadius = 75.0f;
+	const FVector SweepOffset(-75.0f, 0.0f, 0.0f);
+
+	FCollisionShape CollisionShape;
+	CollisionShape.SetSphere(SweepRadius);
+
+	TNexusFrameArray<FHitResult> GridResults;
+	TArray<FHitResult> Hits;
+	int32 GridHits = 0;
+	int32 PhysicsHits = 0;
+
+	const double GridStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const FVector& Target = Targets[Iteration % Targets.Num()];
+		SweepMulti(GridResults, Target + SweepOffset, Target - SweepOffset, SweepRadius, ObjectParams, nullptr);
+		GridHits += GridResults.Num();
+	}
+	const double GridSeconds = FPlatformTime::Seconds() - GridStart;
+
+	const double PhysicsStart = FPlatformTime::Seconds();
+	for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+	{
+		const FVector& Target = Targets[Iteration % Targets.Num()];
+		Hits.Reset();
+		World->SweepMultiByObjectType(Hits, Target + SweepOffset, Target - SweepOffset, FQuat::Identity, ObjectParams, CollisionShape);
+		PhysicsHits += Hits.Num();
+	}
+	const double PhysicsSeconds = FPlatformTime::Seconds() - PhysicsStart;
+
+	UE_LOG(LogNexusTrials, Display, TEXT("Melee grid benchmark: %d damageables, %d sweeps | grid %.2f us/sweep (%d hits) | physics %.2f us/sweep (%d hits)"),
+		Entries.Num(), Iterations,
+		GridSeconds * 1000000.0 / Iterations, GridHits,
+		PhysicsSeconds * 1000000.0 / Iterations, PhysicsHits);
+}
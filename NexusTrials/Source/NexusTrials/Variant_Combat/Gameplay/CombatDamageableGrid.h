@@ -0,0 +1,159 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Containers/SparseArray.h"
+#include "CollisionQueryParams.h"
+#include "CombatFaction.h"
+#include "Performance/NexusFrameScratch.h"
+#include "CombatDamageableGrid.generated.h"
+
+class UPrimitiveComponent;
+class USceneComponent;
+
+/**
+ *  Uniform grid of damageable actors used as a gameplay-side broadphase for melee attacks.
+ *  Damageables register a primitive that stands in for their hit shape. Capsules are tested exactly,
+ *  any other primitive is approximated by an upright capsule around its bounds.
+ *  Entries are re-bucketed only when their shape moves to a different cell.
+ *  Entries whose actor or shape went away without unregistering are dropped the first time a sweep finds them.
+ *  Melee queries resolve against the grid with an analytic sphere sweep instead of a physics scene sweep.
+ */
+UCLASS()
+class UCombatDamageableGrid : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the grid for the world the provided object lives in, if any */
+	static UCombatDamageableGrid* Get(const UObject* WorldContextObject);
+
+	/** Adds a damageable actor to the grid, using the provided primitive as its hit shape. The entry takes the actor's current faction */
+	void Register(AActor* Actor, UPrimitiveComponent* Shape);
+
+	/** Swaps the hit shape of a registered actor, e.g. from the capsule to the ragdoll mesh */
+	void SetShape(AActor* Actor, UPrimitiveComponent* Shape);
+
+	/** Removes an actor from the grid */
+	void Unregister(AActor* Actor);
+
+	/** Updates the faction stored for a registered actor, e.g. when it switches sides */
+	void SetFaction(AActor* Actor, ECombatFaction Faction);
+
+	/**
+	 *  Adds a static hit shape owned by an actor that may own many of them, e.g. one instance of an instanced mesh.
+	 *  The shape is an upright capsule around the provided bounds and never moves.
+	 *  @return handle to unregister the shape with
+	 */
+	int32 RegisterStatic(AActor* Actor, UPrimitiveComponent* Component, const FBoxSphereBounds& Bounds);
+
+	/** Removes a static hit shape and resets the handle */
+	void UnregisterStatic(int32& EntryHandle);
+
+	/** Returns the number of registered damageables */
+	int32 Num() const { return Entries.Num(); }
+
+	/**
+	 *  Sweeps a sphere against the registered damageables whose shape matches the object types and has query collision.
+	 *  Hits are sorted along the sweep, with at most one hit per registered shape.
+	 *  Hits on static shapes carry the shape's handle in FHitResult::Item, so owners of many shapes know which one was hit.
+	 *  Item is INDEX_NONE for every other hit.
+	 *  Results go into frame scratch memory, so they must be consumed within the frame.
+	 *  Stale entries found along the way are dropped.
+	 *  @param TargetFactionMask	One bit per faction that can be hit, usually the attacker's row of the hostility matrix
+	 *  @return true if anything was hit
+	 */
+	bool SweepMulti(TNexusFrameArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FCollisionObjectQueryParams& ObjectParams, const AActor* IgnoredActor, uint32 TargetFactionMask = MAX_uint32);
+
+	/**
+	 *  Melee sweep entry point. Uses the grid unless it's disabled through Combat.MeleeGrid.Enable,
+	 *  in which case it falls back to a physics scene sweep. Physics hits have no grid handle, so their Item is always INDEX_NONE.
+	 */
+	static bool SweepDamageables(const UObject* WorldContextObject, TNexusFrameArray<FHitResult>& OutHits, const FVector& Start, const FVector& End, float Radius, const FCollisionObjectQueryParams& ObjectParams, AActor* IgnoredActor, uint32 TargetFactionMask = MAX_uint32);
+
+	/** Times grid and physics sweeps around the registered damageables and logs the results */
+	void RunBenchmark(int32 Iterations);
+
+protected:
+
+	/** Only create the grid for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Cleanup */
+	virtual void Deinitialize() override;
+
+	/** Horizontal size of each grid cell */
+	float CellSize = 400.0f;
+
+	/** One registered damageable */
+	struct FGridEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		TWeakObjectPtr<UPrimitiveComponent> Shape;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+		FDelegateHandle TransformHandle;
+
+		/** Lookup key, kept so stale actors can still be removed from the index */
+		TObjectKey<AActor> Key;
+
+		/** Horizontal extent of the shape when it was last bucketed */
+		float Extent = 0.0f;
+
+		/** Faction of the owning actor, so sweeps can filter targets without touching the actor */
+		ECombatFaction Faction = ECombatFaction::Neutral;
+
+		/** If true, the entry uses the fixed capsule below instead of following its shape */
+		bool bStatic = false;
+		FVector StaticA = FVector::ZeroVector;
+		FVector StaticB = FVector::ZeroVector;
+		float StaticRadius = 0.0f;
+	};
+
+	/** Returns the cell containing the provided location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Adds an entry to its current cell */
+	void AddToCell(int32 EntryIndex);
+
+	/** Removes an entry from its current cell */
+	void RemoveFromCell(int32 EntryIndex);
+
+	/** Removes an entry from its cell and the entry list */
+	void RemoveEntry(int32 EntryIndex);
+
+	/** Drops an entry whose actor or shape went away without unregistering */
+	void RemoveStaleEntry(int32 EntryIndex);
+
+	/** Shrinks MaxShapeExtent back down if the shape that set it is gone */
+	void OnExtentRemoved(float RemovedExtent);
+
+	/** Binds to the shape's transform updates so the entry can follow it */
+	void BindShape(int32 EntryIndex);
+
+	/** Unbinds from the shape's transform updates */
+	void UnbindShape(int32 EntryIndex);
+
+	/** Called when a registered shape moves */
+	void OnShapeMoved(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport, int32 EntryIndex);
+
+	/** Builds the capsule that stands in for an entry's shape */
+	static void GetShapeCapsule(const UPrimitiveComponent* Shape, FVector& OutA, FVector& OutB, float& OutRadius);
+
+	/** Builds an upright capsule around the provided bounds */
+	static void GetBoundsCapsule(const FBoxSphereBounds& Bounds, FVector& OutA, FVector& OutB, float& OutRadius);
+
+	/** Registered damageables. Sparse so indices stay stable while cells reference them */
+	TSparseArray<FGridEntry> Entries;
+
+	/** Actor to entry lookup. Static entries aren't in here, since an actor can own many of them */
+	TMap<TObjectKey<AActor>, int32> EntryIndices;
+
+	/** Entry indices bucketed by cell */
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> Cells;
+
+	/** Largest horizontal extent of any registered shape, used to pad queries */
+	float MaxShapeExtent = 0.0f;
+};
@@ -5,6 +5,8 @@
 #include "Components/SceneComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "CombatDamageableGrid.h"
+#include "Performance/NexusSignificanceSubsystem.h"
 
 ACombatDummy::ACombatDummy()
 {
@@ -31,8 +33,48 @@ ACombatDummy::ACombatDummy()
 	PhysicsConstraint->SetConstrainedComponents(BasePlate, NAME_None, Dummy, NAME_None);
 }
 
+void ACombatDummy::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// add ourselves to the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Register(this, Dummy);
+	}
+
+	// let the significance manager put us to sleep when the player is far away
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this);
+	}
+}
+
+void ACombatDummy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// remove ourselves from the melee broadphase
+	if (UCombatDamageableGrid* Grid = UCombatDamageableGrid::Get(this))
+	{
+		Grid->Unregister(this);
+	}
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
+}
+
 void ACombatDummy::ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse)
 {
+	// wake up at full tick rate while we're being hit
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->NotifyCombatActivity(this);
+	}
+
 	// apply impulse to the dummy
 	Dummy->AddImpulseAtLocation(DamageImpulse, DamageLocation);
 
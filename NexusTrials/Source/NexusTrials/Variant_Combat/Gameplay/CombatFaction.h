@@ -0,0 +1,121 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CombatFaction.generated.h"
+
+/**
+ *  Side a combatant fights for.
+ *  Stored as a single byte on combatants and melee grid entries, and used as a bit index into the hostility matrix.
+ */
+UENUM(BlueprintType)
+enum class ECombatFaction : uint8
+{
+	/** Props, dummies and anything else that doesn't pick a side */
+	Neutral,
+
+	/** The player character */
+	Player,
+
+	/** Regular enemies */
+	Enemy,
+
+	/** Extra teams for enemy versus enemy and multi-team fights */
+	TeamRed,
+	TeamBlue,
+
+	Count UMETA(Hidden)
+};
+
+/**
+ *  Who may attack whom, as a bit matrix indexed by faction.
+ *  Hostility is directional: an attacker's row holds one bit per faction it may hit,
+ *  so filtering a target costs a byte load and a bit test.
+ *  Columns are kept alongside so targets can also ask which factions may threaten them.
+ */
+struct FCombatFactionMatrix
+{
+	/** The matrix is stored in 32 bit rows */
+	static constexpr int32 MaxFactions = 32;
+	static_assert(static_cast<int32>(ECombatFaction::Count) <= MaxFactions, "Too many combat factions for the hostility matrix");
+
+	/** Sets whether Attacker may attack Target */
+	void SetHostile(ECombatFaction Attacker, ECombatFaction Target, bool bHostile)
+	{
+		const uint32 AttackerBit = 1u << static_cast<uint32>(Attacker);
+		const uint32 TargetBit = 1u << static_cast<uint32>(Target);
+
+		if (bHostile)
+		{
+			Rows[static_cast<uint8>(Attacker)] |= TargetBit;
+			Columns[static_cast<uint8>(Target)] |= AttackerBit;
+
+		} else {
+
+			Rows[static_cast<uint8>(Attacker)] &= ~TargetBit;
+			Columns[static_cast<uint8>(Target)] &= ~AttackerBit;
+		}
+	}
+
+	/** Sets whether two factions may attack each other */
+	void SetMutuallyHostile(ECombatFaction A, ECombatFaction B, bool bHostile)
+	{
+		SetHostile(A, B, bHostile);
+		SetHostile(B, A, bHostile);
+	}
+
+	/** Returns true if Attacker may attack Target */
+	bool IsHostile(ECombatFaction Attacker, ECombatFaction Target) const
+	{
+		return (Rows[static_cast<uint8>(Attacker)] >> static_cast<uint32>(Target)) & 1u;
+	}
+
+	/** Returns one bit per faction the attacker may attack */
+	uint32 GetTargetMask(ECombatFaction Attacker) const
+	{
+		return Rows[static_cast<uint8>(Attacker)];
+	}
+
+	/** Returns one bit per faction that may attack the target */
+	uint32 GetAttackerMask(ECombatFaction Target) const
+	{
+		return Columns[static_cast<uint8>(Target)];
+	}
+
+	/** Tests a faction against a mask returned by GetTargetMask or GetAttackerMask */
+	static bool MaskHasFaction(uint32 Mask, ECombatFaction Faction)
+	{
+		return (Mask >> static_cast<uint32>(Faction)) & 1u;
+	}
+
+	/**
+	 *  Builds the default matrix: the player fights enemies and can break neutral props,
+	 *  enemies only fight the player, and the extra teams fight everyone but themselves and neutrals
+	 */
+	static FCombatFactionMatrix MakeDefault()
+	{
+		FCombatFactionMatrix Matrix;
+
+		Matrix.SetHostile(ECombatFaction::Player, ECombatFaction::Neutral, true);
+		Matrix.SetMutuallyHostile(ECombatFaction::Player, ECombatFaction::Enemy, true);
+
+		for (const ECombatFaction Team : { ECombatFaction::TeamRed, ECombatFaction::TeamBlue })
+		{
+			Matrix.SetMutuallyHostile(Team, ECombatFaction::Player, true);
+			Matrix.SetMutuallyHostile(Team, ECombatFaction::Enemy, true);
+		}
+
+		Matrix.SetMutuallyHostile(ECombatFaction::TeamRed, ECombatFaction::TeamBlue, true);
+
+		return Matrix;
+	}
+
+private:
+
+	/** One bit per target faction, per attacker faction */
+	uint32 Rows[MaxFactions] = {};
+
+	/** One bit per attacker faction, per target faction */
+	uint32 Columns[MaxFactions] = {};
+};
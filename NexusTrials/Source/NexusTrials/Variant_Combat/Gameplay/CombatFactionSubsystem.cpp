@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatFactionSubsystem.h"
+#include "CombatDamageable.h"
+#include "Engine/World.h"
+
+UCombatFactionSubsystem* UCombatFactionSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatFactionSubsystem>() : nullptr;
+}
+
+const FCombatFactionMatrix& UCombatFactionSubsystem::GetMatrix(const UObject* WorldContextObject)
+{
+	if (const UCombatFactionSubsystem* Factions = Get(WorldContextObject))
+	{
+		return Factions->Matrix;
+	}
+
+	static const FCombatFactionMatrix DefaultMatrix = FCombatFactionMatrix::MakeDefault();
+	return DefaultMatrix;
+}
+
+ECombatFaction UCombatFactionSubsystem::GetActorFaction(const AActor* Actor)
+{
+	const ICombatDamageable* Damageable = Cast<ICombatDamageable>(Actor);
+	return Damageable ? Damageable->GetFaction() : ECombatFaction::Neutral;
+}
+
+bool UCombatFactionSubsystem::IsHostile(const AActor* Attacker, const AActor* Target)
+{
+	return Attacker && Target && GetMatrix(Attacker).IsHostile(GetActorFaction(Attacker), GetActorFaction(Target));
+}
+
+void UCombatFactionSubsystem::SetHostile(ECombatFaction Attacker, ECombatFaction Target, bool bHostile)
+{
+	Matrix.SetHostile(Attacker, Target, bHostile);
+}
+
+void UCombatFactionSubsystem::SetMutuallyHostile(ECombatFaction A, ECombatFaction B, bool bHostile)
+{
+	Matrix.SetMutuallyHostile(A, B, bHostile);
+}
+
+bool UCombatFactionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
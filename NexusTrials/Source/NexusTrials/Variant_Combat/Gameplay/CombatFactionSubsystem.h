@@ -0,0 +1,51 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatFaction.h"
+#include "CombatFactionSubsystem.generated.h"
+
+/**
+ *  Holds the faction hostility matrix for a world.
+ *  Starts from the default matrix, and can be changed at runtime to set up enemy infighting or team fights.
+ */
+UCLASS()
+class UCombatFactionSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the faction registry for the world the provided object lives in, if any */
+	static UCombatFactionSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Returns the hostility matrix for the provided object's world, or the default matrix if the world has no registry */
+	static const FCombatFactionMatrix& GetMatrix(const UObject* WorldContextObject);
+
+	/** Returns the faction of a combat actor. Actors that aren't damageable are neutral */
+	static ECombatFaction GetActorFaction(const AActor* Actor);
+
+	/** Returns true if Attacker's faction may attack Target's faction */
+	static bool IsHostile(const AActor* Attacker, const AActor* Target);
+
+	/** Sets whether Attacker may attack Target */
+	UFUNCTION(BlueprintCallable, Category="Faction")
+	void SetHostile(ECombatFaction Attacker, ECombatFaction Target, bool bHostile);
+
+	/** Sets whether two factions may attack each other */
+	UFUNCTION(BlueprintCallable, Category="Faction")
+	void SetMutuallyHostile(ECombatFaction A, ECombatFaction B, bool bHostile);
+
+	/** Returns the hostility matrix */
+	const FCombatFactionMatrix& GetFactionMatrix() const { return Matrix; }
+
+protected:
+
+	/** Only create the registry for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Who may attack whom */
+	FCombatFactionMatrix Matrix = FCombatFactionMatrix::MakeDefault();
+};
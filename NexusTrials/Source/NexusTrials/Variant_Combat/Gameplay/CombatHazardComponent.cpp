@@ -0,0 +1,163 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHazardComponent.h"
+#include "CombatDamageable.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hazard Damage"), STAT_CombatHazardDamage, STATGROUP_NexusTrials);
+
+UCombatHazardComponent::UCombatHazardComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	// overlap pawns and physics objects without blocking them
+	SetCollisionProfileName(FName("OverlapAllDynamic"));
+	SetGenerateOverlapEvents(true);
+
+	// the hazard is a trigger, not a navigation obstacle
+	SetCanEverAffectNavigation(false);
+}
+
+void UCombatHazardComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OnComponentBeginOverlap.AddDynamic(this, &UCombatHazardComponent::OnHazardBeginOverlap);
+	OnComponentEndOverlap.AddDynamic(this, &UCombatHazardComponent::OnHazardEndOverlap);
+
+	// pick up anything that was already in contact when we started
+	TArray<UPrimitiveComponent*> OverlappingComponents;
+	GetOverlappingComponents(OverlappingComponents);
+
+	for (UPrimitiveComponent* OverlappingComponent : OverlappingComponents)
+	{
+		AddContact(OverlappingComponent->GetOwner());
+	}
+}
+
+void UCombatHazardComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// clear the damage timer
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(DamageTimer);
+	}
+
+	Contacts.Empty();
+}
+
+void UCombatHazardComponent::FitToComponent(const UPrimitiveComponent* Surface, float ContactHeight)
+{
+	if (!Surface)
+	{
+		return;
+	}
+
+	// cover the surface's local bounds, and stretch upwards so anything standing on it overlaps
+	const FBoxSphereBounds LocalBounds = Surface->CalcBounds(FTransform::Identity);
+	const FVector Extent = LocalBounds.BoxExtent + FVector(0.0f, 0.0f, ContactHeight * 0.5f);
+
+	SetBoxExtent(Extent, false);
+	SetRelativeLocation(LocalBounds.Origin + FVector(0.0f, 0.0f, ContactHeight * 0.5f));
+}
+
+void UCombatHazardComponent::OnHazardBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	AddContact(OtherActor);
+}
+
+void UCombatHazardComponent::OnHazardEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	const int32 ContactIndex = Contacts.IndexOfByPredicate([OtherActor](const FHazardContact& Contact) { return Contact.Actor.Get() == OtherActor; });
+
+	if (ContactIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	// only stop tracking the actor once none of its components are in contact
+	if (--Contacts[ContactIndex].NumOverlaps <= 0)
+	{
+		Contacts.RemoveAtSwap(ContactIndex, 1, EAllowShrinking::No);
+	}
+
+	// stop the timer once the hazard is empty
+	if (Contacts.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(DamageTimer);
+	}
+}
+
+void UCombatHazardComponent::AddContact(AActor* OtherActor)
+{
+	// only track damageables
+	if (!OtherActor || OtherActor == GetOwner() || !Cast<ICombatDamageable>(OtherActor))
+	{
+		return;
+	}
+
+	// count additional overlapping components on actors we already track
+	if (FHazardContact* Contact = Contacts.FindByPredicate([OtherActor](const FHazardContact& Contact) { return Contact.Actor.Get() == OtherActor; }))
+	{
+		++Contact->NumOverlaps;
+		return;
+	}
+
+	FHazardContact& NewContact = Contacts.AddDefaulted_GetRef();
+	NewContact.Actor = OtherActor;
+	NewContact.NumOverlaps = 1;
+
+	// start the fixed rate damage timer for the first contact
+	if (!GetWorld()->GetTimerManager().IsTimerActive(DamageTimer))
+	{
+		GetWorld()->GetTimerManager().SetTimer(DamageTimer, this, &UCombatHazardComponent::ApplyHazardDamage, DamageInterval, true);
+	}
+
+	if (bDamageOnEnter)
+	{
+		DamageActor(OtherActor);
+	}
+}
+
+void UCombatHazardComponent::ApplyHazardDamage()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHazardDamage);
+
+	// damage can kill and remove actors, so walk backwards and drop any that went away
+	for (int32 ContactIndex = Contacts.Num() - 1; ContactIndex >= 0; --ContactIndex)
+	{
+		if (!Contacts.IsValidIndex(ContactIndex))
+		{
+			continue;
+		}
+
+		AActor* Target = Contacts[ContactIndex].Actor.Get();
+
+		if (!IsValid(Target))
+		{
+			Contacts.RemoveAtSwap(ContactIndex, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		DamageActor(Target);
+	}
+
+	if (Contacts.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(DamageTimer);
+	}
+}
+
+void UCombatHazardComponent::DamageActor(AActor* Target)
+{
+	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(Target))
+	{
+		// damage at the actor's location, without knockback
+		Damageable->ApplyDamage(Damage, GetOwner(), Target->GetActorLocation(), FVector::ZeroVector);
+	}
+}
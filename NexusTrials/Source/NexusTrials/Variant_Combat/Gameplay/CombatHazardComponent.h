@@ -0,0 +1,85 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/BoxComponent.h"
+#include "CombatHazardComponent.generated.h"
+
+/**
+ *  A box volume that damages anything damageable in contact with it.
+ *  Contacts are tracked through overlap enter and exit events, and damage is applied to all of them
+ *  at a fixed rate from a single timer, so it doesn't depend on how often physics reports hits or on frame rate.
+ */
+UCLASS(ClassGroup=(Combat), meta=(BlueprintSpawnableComponent))
+class UCombatHazardComponent : public UBoxComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Amount of damage to deal each damage interval */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hazard")
+	float Damage = 1.0f;
+
+	/** Time between damage applications */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hazard", meta = (ClampMin = 0.05, ClampMax = 10, Units = "s"))
+	float DamageInterval = 0.5f;
+
+	/** If true, damage is dealt as soon as something enters the hazard instead of waiting for the next interval */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Hazard")
+	bool bDamageOnEnter = true;
+
+protected:
+
+	/** One damageable in contact with the hazard */
+	struct FHazardContact
+	{
+		TWeakObjectPtr<AActor> Actor;
+
+		/** Number of the actor's components overlapping the hazard */
+		int32 NumOverlaps = 0;
+	};
+
+	/** Damageables currently in contact */
+	TArray<FHazardContact> Contacts;
+
+	/** Fixed rate damage timer. Only runs while there are contacts */
+	FTimerHandle DamageTimer;
+
+public:
+
+	/** Constructor */
+	UCombatHazardComponent();
+
+	/** Initialization */
+	virtual void BeginPlay() override;
+
+	/** Cleanup */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Sizes the hazard to cover the provided component's local bounds, extended upwards so anything standing on it is in contact */
+	void FitToComponent(const UPrimitiveComponent* Surface, float ContactHeight);
+
+	/** Returns the number of damageables in contact */
+	int32 GetNumContacts() const { return Contacts.Num(); }
+
+protected:
+
+	/** Overlap enter handler */
+	UFUNCTION()
+	void OnHazardBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	/** Overlap exit handler */
+	UFUNCTION()
+	void OnHazardEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
+	/** Starts tracking a damageable */
+	void AddContact(AActor* OtherActor);
+
+	/** Damages every damageable in contact */
+	void ApplyHazardDamage();
+
+	/** Damages a single damageable */
+	void DamageActor(AActor* Target);
+};
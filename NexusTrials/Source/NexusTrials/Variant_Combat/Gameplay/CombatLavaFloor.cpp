@@ -2,7 +2,7 @@
 
 
 #include "CombatLavaFloor.h"
-#include "CombatDamageable.h"
+#include "CombatHazardComponent.h"
 #include "Components/StaticMeshComponent.h"
 
 ACombatLavaFloor::ACombatLavaFloor()
@@ -12,16 +12,20 @@ ACombatLavaFloor::ACombatLavaFloor()
 	// create the mesh
 	RootComponent = Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 
-	// bind the hit handler
-	Mesh->OnComponentHit.AddDynamic(this, &ACombatLavaFloor::OnFloorHit);
+	// create the hazard volume
+	Hazard = CreateDefaultSubobject<UCombatHazardComponent>(TEXT("Hazard"));
+	Hazard->SetupAttachment(Mesh);
 }
 
-void ACombatLavaFloor::OnFloorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+void ACombatLavaFloor::OnConstruction(const FTransform& Transform)
 {
-	// check if the hit actor is damageable by casting to the interface
-	if (ICombatDamageable* Damageable = Cast<ICombatDamageable>(OtherActor))
-	{
-		// damage the actor
-		Damageable->ApplyDamage(Damage, this, Hit.ImpactPoint, FVector::ZeroVector);
-	}
+	Super::OnConstruction(Transform);
+
+	// cover the floor with the hazard
+	Hazard->FitToComponent(Mesh, ContactHeight);
+
+	// damage on contact, then at a fixed rate while contact lasts
+	Hazard->Damage = Damage;
+	Hazard->DamageInterval = DamageInterval;
+	Hazard->bDamageOnEnter = true;
 }
@@ -7,7 +7,7 @@
 #include "CombatLavaFloor.generated.h"
 
 class UStaticMeshComponent;
-class UPrimitiveComponent;
+class UCombatHazardComponent;
 
 /**
  *  A basic actor that applies damage on contact through the ICombatDamageable interface. 
@@ -21,20 +21,29 @@ class ACombatLavaFloor : public AActor
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
 	UStaticMeshComponent* Mesh;
 
+	/** Hazard volume covering the floor. Tracks what's in contact and damages it at a fixed rate */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Components", meta = (AllowPrivateAccess = "true"))
+	UCombatHazardComponent* Hazard;
+
 protected:
 
-	/** Amount of damage to deal on contact */
+	/** Amount of damage to deal on contact, and again every damage interval while contact lasts */
 	UPROPERTY(EditAnywhere, Category="Damage")
 	float Damage = 10000.0f;
 
+	/** Time between damage applications while something stays in contact */
+	UPROPERTY(EditAnywhere, Category="Damage", meta = (ClampMin = 0.05, ClampMax = 10, Units = "s"))
+	float DamageInterval = 0.5f;
+
+	/** How far above the floor surface counts as contact */
+	UPROPERTY(EditAnywhere, Category="Damage", meta = (ClampMin = 0, ClampMax = 100, Units = "cm"))
+	float ContactHeight = 10.0f;
+
 public:	
 
 	/** Constructor */
 	ACombatLavaFloor();
 
-protected:
-
-	/** Blocking hit handler */
-	UFUNCTION()
-	void OnFloorHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+	/** Sizes and configures the hazard volume */
+	virtual void OnConstruction(const FTransform& Transform) override;
 };
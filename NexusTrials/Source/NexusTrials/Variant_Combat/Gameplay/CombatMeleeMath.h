@@ -0,0 +1,65 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ *  Pure, testable geometry helpers for melee hit detection.
+ *  Used by the damageable grid to resolve attacks without touching the physics scene.
+ */
+struct FCombatMeleeMath
+{
+	/**
+	 *  Tests a sphere swept along a segment against a capsule.
+	 *
+	 *  @param SweepStart Start of the sphere sweep
+	 *  @param SweepEnd End of the sphere sweep
+	 *  @param SweepRadius Radius of the swept sphere
+	 *  @param CapsuleA First end of the capsule's inner segment
+	 *  @param CapsuleB Second end of the capsule's inner segment
+	 *  @param CapsuleRadius Radius of the capsule
+	 *  @param OutTime 0-1 position along the sweep of the closest approach, used to order hits
+	 *  @param OutImpactPoint Point on the capsule surface closest to the sweep
+	 *  @param OutImpactNormal Capsule surface normal at the impact point, facing the sweep
+	 *  @return true if the swept sphere touches the capsule
+	 */
+	static bool SphereSweepVsCapsule(const FVector& SweepStart, const FVector& SweepEnd, float SweepRadius,
+		const FVector& CapsuleA, const FVector& CapsuleB, float CapsuleRadius,
+		float& OutTime, FVector& OutImpactPoint, FVector& OutImpactNormal)
+	{
+		// find the closest points between the sweep path and the capsule's inner segment
+		FVector SweepPoint, CapsulePoint;
+		FMath::SegmentDistToSegmentSafe(SweepStart, SweepEnd, CapsuleA, CapsuleB, SweepPoint, CapsulePoint);
+
+		const float CombinedRadius = SweepRadius + CapsuleRadius;
+		const FVector Separation = SweepPoint - CapsulePoint;
+
+		if (Separation.SizeSquared() > FMath::Square(CombinedRadius))
+		{
+			return false;
+		}
+
+		// position of the closest approach along the sweep
+		const FVector SweepDelta = SweepEnd - SweepStart;
+		const float SweepLengthSq = SweepDelta.SizeSquared();
+		OutTime = SweepLengthSq > UE_KINDA_SMALL_NUMBER ? FMath::Clamp(FVector::DotProduct(SweepPoint - SweepStart, SweepDelta) / SweepLengthSq, 0.0f, 1.0f) : 0.0f;
+
+		// if the sweep passes right through the capsule axis, push out towards the sweep start instead
+		OutImpactNormal = Separation.GetSafeNormal();
+
+		if (OutImpactNormal.IsNearlyZero())
+		{
+			OutImpactNormal = (SweepStart - CapsulePoint).GetSafeNormal();
+		}
+
+		if (OutImpactNormal.IsNearlyZero())
+		{
+			OutImpactNormal = FVector::UpVector;
+		}
+
+		OutImpactPoint = CapsulePoint + OutImpactNormal * CapsuleRadius;
+
+		return true;
+	}
+};
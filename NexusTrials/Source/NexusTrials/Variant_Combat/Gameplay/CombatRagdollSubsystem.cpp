@@ -0,0 +1,223 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatRagdollSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Ragdoll Budget"), STAT_CombatRagdollBudget, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Ragdolls"), STAT_CombatActiveRagdolls, STATGROUP_NexusTrials);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Retired Ragdolls"), STAT_CombatRetiredRagdolls, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Physics Body Activations"), STAT_CombatPhysicsActivations, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Physics Hit Reactions"), STAT_CombatPhysicsHitReactions, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarProceduralHitReactions(
+	TEXT("Combat.HitReaction.Procedural"),
+	true,
+	TEXT("If true, hits play procedural reactions and only a budgeted few blend physics. If false, every hit wakes the physics bodies for a partial ragdoll."));
+
+UCombatRagdollSubsystem* UCombatRagdollSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatRagdollSubsystem>() : nullptr;
+}
+
+bool UCombatRagdollSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatRagdollSubsystem::RegisterRagdoll(USkeletalMeshComponent* Mesh)
+{
+	if (!IsValid(Mesh))
+	{
+		return;
+	}
+
+	// re-registering restarts the ragdoll as the newest one
+	UnregisterRagdoll(Mesh);
+
+	// the mesh just started simulating all of its bodies
+	INC_DWORD_STAT(STAT_CombatPhysicsActivations);
+
+	FActiveRagdoll& Ragdoll = Ragdolls.AddDefaulted_GetRef();
+	Ragdoll.Mesh = Mesh;
+	Ragdoll.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UCombatRagdollSubsystem::UnregisterRagdoll(USkeletalMeshComponent* Mesh)
+{
+	// keep the array ordered so the oldest ragdoll stays first
+	Ragdolls.RemoveAll([Mesh](const FActiveRagdoll& Ragdoll) { return Ragdoll.Mesh.Get() == Mesh; });
+
+	// a full ragdoll supersedes any hit reaction the mesh was playing
+	HitReactions.RemoveAll([Mesh](const FPhysicsHitReaction& HitReaction) { return HitReaction.Mesh.Get() == Mesh; });
+}
+
+bool UCombatRagdollSubsystem::TryStartPhysicsHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName)
+{
+	if (!IsValid(Mesh))
+	{
+		return false;
+	}
+
+	const bool bAlreadyReacting = HitReactions.ContainsByPredicate([Mesh](const FPhysicsHitReaction& HitReaction) { return HitReaction.Mesh.Get() == Mesh; });
+
+	if (CVarProceduralHitReactions.GetValueOnGameThread() && !bAlreadyReacting)
+	{
+		// is there room in the budget?
+		if (HitReactions.Num() >= MaxPhysicsHitReactions)
+		{
+			return false;
+		}
+
+		// only spend it on characters close enough to the player to notice
+		if (const UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+		{
+			if (Significance->GetBucket(Mesh->GetOwner()) != ENexusTickBucket::Full)
+			{
+				return false;
+			}
+		}
+	}
+
+	StartPhysicsHitReaction(Mesh, PelvisBoneName);
+
+	return true;
+}
+
+void UCombatRagdollSubsystem::StartPhysicsHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName)
+{
+	if (!IsValid(Mesh))
+	{
+		return;
+	}
+
+	// enable partial ragdoll physics, but keep the pelvis vertical
+	Mesh->SetPhysicsBlendWeight(0.5f);
+	Mesh->SetBodySimulatePhysics(PelvisBoneName, false);
+
+	INC_DWORD_STAT(STAT_CombatPhysicsActivations);
+
+	// a repeated hit restarts the reaction
+	HitReactions.RemoveAll([Mesh](const FPhysicsHitReaction& HitReaction) { return HitReaction.Mesh.Get() == Mesh; });
+
+	FPhysicsHitReaction& HitReaction = HitReactions.AddDefaulted_GetRef();
+	HitReaction.Mesh = Mesh;
+	HitReaction.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UCombatRagdollSubsystem::EndPhysicsHitReaction(USkeletalMeshComponent* Mesh)
+{
+	const int32 NumRemoved = HitReactions.RemoveAll([Mesh](const FPhysicsHitReaction& HitReaction) { return HitReaction.Mesh.Get() == Mesh; });
+
+	// disable ragdoll physics
+	if (NumRemoved > 0 && IsValid(Mesh))
+	{
+		Mesh->SetPhysicsBlendWeight(0.0f);
+	}
+}
+
+TStatId UCombatRagdollSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCombatRagdollSubsystem, STATGROUP_Tickables);
+}
+
+void UCombatRagdollSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatRagdollBudget);
+
+	const float TimeSeconds = GetWorld()->GetTimeSeconds();
+
+	// end hit reactions that have gone on for too long
+	for (int32 Index = HitReactions.Num() - 1; Index >= 0; --Index)
+	{
+		USkeletalMeshComponent* Mesh = HitReactions[Index].Mesh.Get();
+
+		if (!Mesh)
+		{
+			HitReactions.RemoveAt(Index, 1, EAllowShrinking::No);
+
+		} else if (TimeSeconds - HitReactions[Index].StartTime >= MaxPhysicsHitReactionTime)
+		{
+			Mesh->SetPhysicsBlendWeight(0.0f);
+			HitReactions.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_CombatPhysicsHitReactions, HitReactions.Num());
+
+	// retire anything that has come to rest, and forget meshes that stopped simulating on their own
+	for (int32 Index = Ragdolls.Num() - 1; Index >= 0; --Index)
+	{
+		FActiveRagdoll& Ragdoll = Ragdolls[Index];
+		USkeletalMeshComponent* Mesh = Ragdoll.Mesh.Get();
+
+		if (!Mesh || !Mesh->IsSimulatingPhysics())
+		{
+			Ragdolls.RemoveAt(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		if (TimeSeconds - Ragdoll.StartTime < MinSimulationTime)
+		{
+			continue;
+		}
+
+		// accumulate resting time while the body is slow
+		if (Mesh->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(RestSpeed))
+		{
+			Ragdoll.RestingTime += DeltaTime;
+		}
+		else
+		{
+			Ragdoll.RestingTime = 0.0f;
+		}
+
+		if (Ragdoll.RestingTime >= RestTime)
+		{
+			RetireRagdoll(Mesh);
+			Ragdolls.RemoveAt(Index, 1, EAllowShrinking::No);
+		}
+	}
+
+	// enforce the cap, oldest first
+	const int32 NumOverBudget = Ragdolls.Num() - MaxActiveRagdolls;
+
+	if (NumOverBudget > 0)
+	{
+		for (int32 Index = 0; Index < NumOverBudget; ++Index)
+		{
+			if (USkeletalMeshComponent* Mesh = Ragdolls[Index].Mesh.Get())
+			{
+				RetireRagdoll(Mesh);
+			}
+		}
+
+		Ragdolls.RemoveAt(0, NumOverBudget, EAllowShrinking::No);
+	}
+
+	SET_DWORD_STAT(STAT_CombatActiveRagdolls, Ragdolls.Num());
+}
+
+void UCombatRagdollSubsystem::RetireRagdoll(USkeletalMeshComponent* Mesh) const
+{
+	INC_DWORD_STAT(STAT_CombatRetiredRagdolls);
+
+	if (RetireMode == ECombatRagdollRetireMode::Sleep)
+	{
+		Mesh->PutAllRigidBodiesToSleep();
+		return;
+	}
+
+	// stop refreshing the skeleton so the mesh holds its last simulated pose once physics is off
+	Mesh->bNoSkeletonUpdate = true;
+	Mesh->SetSimulatePhysics(false);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// a frozen mesh has nothing left to tick
+	Mesh->SetComponentTickEnabled(false);
+}
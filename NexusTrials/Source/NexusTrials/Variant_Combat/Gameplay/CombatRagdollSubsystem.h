@@ -0,0 +1,130 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatRagdollSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ *  How the ragdoll budget takes a ragdoll out of the simulation
+ */
+UENUM()
+enum class ECombatRagdollRetireMode : uint8
+{
+	/** Put the bodies to sleep. They stay in the physics scene and can be woken up by collisions */
+	Sleep,
+
+	/** Stop simulating and hold the last pose. The bodies leave the physics scene entirely */
+	Freeze
+};
+
+/**
+ *  Keeps the number of simulating ragdolls bounded.
+ *  When the cap is exceeded the oldest ragdolls are retired first,
+ *  and ragdolls that come to rest before then are retired early.
+ *  Also budgets the partial ragdolls used for hit reactions, so most hits use procedural reactions instead of waking physics bodies.
+ */
+UCLASS(Config=Game)
+class UCombatRagdollSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the ragdoll budget for the world the provided object lives in, if any */
+	static UCombatRagdollSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Starts tracking a mesh that just started simulating as a ragdoll */
+	void RegisterRagdoll(USkeletalMeshComponent* Mesh);
+
+	/** Stops tracking a mesh, e.g. when its owner is destroyed or reused */
+	void UnregisterRagdoll(USkeletalMeshComponent* Mesh);
+
+	/** Returns the number of ragdolls currently simulating */
+	int32 GetNumActiveRagdolls() const { return Ragdolls.Num(); }
+
+	/** Returns the max number of ragdolls allowed to simulate at once */
+	int32 GetMaxActiveRagdolls() const { return MaxActiveRagdolls; }
+
+	/**
+	 *  Starts a partial ragdoll hit reaction on the mesh if the budget allows it.
+	 *  Only meshes whose owner is at full significance are eligible.
+	 *  If procedural hit reactions are disabled through Combat.HitReaction.Procedural, every request is granted.
+	 *  @return true if the mesh is now blending physics. If false, the caller should play a procedural reaction
+	 */
+	bool TryStartPhysicsHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName);
+
+	/** Ends a partial ragdoll hit reaction, e.g. when the character lands */
+	void EndPhysicsHitReaction(USkeletalMeshComponent* Mesh);
+
+	/** Returns the number of partial ragdoll hit reactions currently blending physics */
+	int32 GetNumPhysicsHitReactions() const { return HitReactions.Num(); }
+
+	// ~begin UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+	// ~end UTickableWorldSubsystem interface
+
+protected:
+
+	/** Only create the budget for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Max number of ragdolls simulating at once */
+	UPROPERTY(Config, EditAnywhere, Category="Ragdoll", meta = (ClampMin = 0, ClampMax = 100))
+	int32 MaxActiveRagdolls = 8;
+
+	/** How ragdolls are taken out of the simulation */
+	UPROPERTY(Config, EditAnywhere, Category="Ragdoll")
+	ECombatRagdollRetireMode RetireMode = ECombatRagdollRetireMode::Freeze;
+
+	/** Ragdolls always simulate for at least this long, so death impulses can play out */
+	UPROPERTY(Config, EditAnywhere, Category="Ragdoll", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
+	float MinSimulationTime = 0.5f;
+
+	/** Ragdolls slower than this are considered at rest */
+	UPROPERTY(Config, EditAnywhere, Category="Ragdoll", meta = (ClampMin = 0, ClampMax = 100, Units = "cm/s"))
+	float RestSpeed = 5.0f;
+
+	/** Time a ragdoll must stay at rest before being retired early */
+	UPROPERTY(Config, EditAnywhere, Category="Ragdoll", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
+	float RestTime = 0.5f;
+
+	/** Max number of partial ragdoll hit reactions blending physics at once */
+	UPROPERTY(Config, EditAnywhere, Category="Hit Reactions", meta = (ClampMin = 0, ClampMax = 32))
+	int32 MaxPhysicsHitReactions = 2;
+
+	/** Partial ragdoll hit reactions end after this long even if the character hasn't landed */
+	UPROPERTY(Config, EditAnywhere, Category="Hit Reactions", meta = (ClampMin = 0, ClampMax = 10, Units = "s"))
+	float MaxPhysicsHitReactionTime = 1.0f;
+
+	/** One partial ragdoll hit reaction */
+	struct FPhysicsHitReaction
+	{
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		float StartTime = 0.0f;
+	};
+
+	/** Partial ragdoll hit reactions, oldest first */
+	TArray<FPhysicsHitReaction> HitReactions;
+
+	/** One simulating ragdoll */
+	struct FActiveRagdoll
+	{
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		float StartTime = 0.0f;
+		float RestingTime = 0.0f;
+	};
+
+	/** Starts a partial ragdoll hit reaction on the mesh once the budget has allowed it */
+	void StartPhysicsHitReaction(USkeletalMeshComponent* Mesh, FName PelvisBoneName);
+
+	/** Takes a ragdoll out of the simulation */
+	void RetireRagdoll(USkeletalMeshComponent* Mesh) const;
+
+	/** Simulating ragdolls, oldest first */
+	TArray<FActiveRagdoll> Ragdolls;
+};
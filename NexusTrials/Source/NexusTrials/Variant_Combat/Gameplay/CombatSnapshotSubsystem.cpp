@@ -0,0 +1,158 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSnapshotSubsystem.h"
+#include "CombatSnapshotable.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Snapshot Capture"), STAT_CombatSnapshotCapture, STATGROUP_NexusTrials);
+DECLARE_CYCLE_STAT(TEXT("Snapshot Restore"), STAT_CombatSnapshotRestore, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Snapshot Bytes"), STAT_CombatSnapshotBytes, STATGROUP_NexusTrials);
+
+static TAutoConsoleVariable<bool> CVarSnapshotEnabled(
+	TEXT("Combat.Snapshot.Enable"),
+	true,
+	TEXT("If true, checkpoints capture the state of the arena and respawning restores it. If false, only the player's respawn point is saved."));
+
+UCombatSnapshotSubsystem* UCombatSnapshotSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatSnapshotSubsystem>() : nullptr;
+}
+
+bool UCombatSnapshotSubsystem::IsSnapshotEnabled()
+{
+	return CVarSnapshotEnabled.GetValueOnGameThread();
+}
+
+bool UCombatSnapshotSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCombatSnapshotSubsystem::RegisterActor(AActor* Actor)
+{
+	if (Cast<ICombatSnapshotable>(Actor))
+	{
+		Actors.AddUnique(Actor);
+	}
+}
+
+void UCombatSnapshotSubsystem::UnregisterActor(AActor* Actor)
+{
+	// keep the registration order stable
+	Actors.Remove(Actor);
+}
+
+void UCombatSnapshotSubsystem::CaptureSnapshot()
+{
+	if (!IsSnapshotEnabled())
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatSnapshotCapture);
+
+	// keep the buffer's memory around, the next snapshot is usually about the same size
+	Buffer.Reset();
+	Records.Reset();
+
+	// object references are written as paths, which stay valid for as long as the referenced actors are alive
+	FMemoryWriter Writer(Buffer);
+	FObjectAndNameAsStringProxyArchive Ar(Writer, false);
+
+	for (const TWeakObjectPtr<AActor>& Actor : Actors)
+	{
+		ICombatSnapshotable* Snapshotable = Cast<ICombatSnapshotable>(Actor.Get());
+
+		if (!Snapshotable)
+		{
+			continue;
+		}
+
+		FSnapshotRecord& Record = Records.AddDefaulted_GetRef();
+		Record.Actor = Actor;
+		Record.Offset = static_cast<int32>(Ar.Tell());
+
+		Snapshotable->SerializeSnapshot(Ar);
+
+		Record.Size = static_cast<int32>(Ar.Tell()) - Record.Offset;
+	}
+
+	SET_DWORD_STAT(STAT_CombatSnapshotBytes, Buffer.Num());
+
+	UE_LOG(LogNexusTrials, Verbose, TEXT("Captured arena snapshot: %d actors, %d bytes"), Records.Num(), Buffer.Num());
+}
+
+bool UCombatSnapshotSubsystem::RestoreSnapshot()
+{
+	if (!IsSnapshotEnabled() || !HasSnapshot())
+	{
+		return false;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_CombatSnapshotRestore);
+
+	// take out anything that came into play after the capture, e.g. enemies spawned since.
+	// Discarding can destroy actors and unregister them, so collect them first
+	TSet<const AActor*> CapturedActors;
+	CapturedActors.Reserve(Records.Num());
+
+	for (const FSnapshotRecord& Record : Records)
+	{
+		CapturedActors.Add(Record.Actor.Get());
+	}
+
+	TArray<ICombatSnapshotable*> Discarded;
+
+	for (const TWeakObjectPtr<AActor>& Actor : Actors)
+	{
+		if (Actor.IsValid() && !CapturedActors.Contains(Actor.Get()))
+		{
+			Discarded.Add(Cast<ICombatSnapshotable>(Actor.Get()));
+		}
+	}
+
+	for (ICombatSnapshotable* Snapshotable : Discarded)
+	{
+		if (Snapshotable)
+		{
+			Snapshotable->DiscardForSnapshot();
+		}
+	}
+
+	// load every captured actor's state in place
+	FMemoryReader Reader(Buffer);
+	FObjectAndNameAsStringProxyArchive Ar(Reader, false);
+
+	for (const FSnapshotRecord& Record : Records)
+	{
+		ICombatSnapshotable* Snapshotable = Cast<ICombatSnapshotable>(Record.Actor.Get());
+
+		if (!Snapshotable)
+		{
+			continue;
+		}
+
+		Ar.Seek(Record.Offset);
+		Snapshotable->SerializeSnapshot(Ar);
+
+		ensureMsgf(Ar.Tell() == Record.Offset + Record.Size, TEXT("%s read a different amount of snapshot data than it wrote"), *GetNameSafe(Record.Actor.Get()));
+	}
+
+	// now that everyone is back in place, let actors rebind to each other
+	for (const FSnapshotRecord& Record : Records)
+	{
+		if (ICombatSnapshotable* Snapshotable = Cast<ICombatSnapshotable>(Record.Actor.Get()))
+		{
+			Snapshotable->PostSnapshotRestore();
+		}
+	}
+
+	return true;
+}
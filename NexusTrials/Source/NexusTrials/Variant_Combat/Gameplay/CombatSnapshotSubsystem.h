@@ -0,0 +1,72 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatSnapshotSubsystem.generated.h"
+
+/**
+ *  Captures the mutable state of every registered ICombatSnapshotable actor into one contiguous buffer when a checkpoint is reached,
+ *  and restores it in place so a retry doesn't need a level reload.
+ *  Actors are kept alive across restores by pooling instead of being destroyed.
+ *  Actors that were destroyed since the capture can't be brought back, and are skipped.
+ */
+UCLASS()
+class UCombatSnapshotSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the snapshot subsystem for the world the provided object lives in, if any */
+	static UCombatSnapshotSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Returns true if checkpoints should capture and restore arena snapshots. Can be toggled with Combat.Snapshot.Enable */
+	static bool IsSnapshotEnabled();
+
+	/** Adds an ICombatSnapshotable actor to the snapshot. Actors are saved in registration order */
+	void RegisterActor(AActor* Actor);
+
+	/** Removes an actor from the snapshot */
+	void UnregisterActor(AActor* Actor);
+
+	/** Saves the state of every registered actor, replacing the previous snapshot */
+	UFUNCTION(BlueprintCallable, Category="Snapshot")
+	void CaptureSnapshot();
+
+	/**
+	 *  Puts every registered actor back into the state it had when the snapshot was captured.
+	 *  @return false if there's no snapshot to restore or snapshots are disabled
+	 */
+	UFUNCTION(BlueprintCallable, Category="Snapshot")
+	bool RestoreSnapshot();
+
+	/** Returns true if a snapshot has been captured */
+	bool HasSnapshot() const { return Records.Num() > 0; }
+
+	/** Returns the size of the snapshot buffer in bytes */
+	int32 GetSnapshotSize() const { return Buffer.Num(); }
+
+protected:
+
+	/** Only create the subsystem for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** Where one actor's state lives in the buffer */
+	struct FSnapshotRecord
+	{
+		TWeakObjectPtr<AActor> Actor;
+		int32 Offset = 0;
+		int32 Size = 0;
+	};
+
+	/** Registered actors, in registration order */
+	TArray<TWeakObjectPtr<AActor>> Actors;
+
+	/** Saved state of every captured actor, back to back */
+	TArray<uint8> Buffer;
+
+	/** Captured actors, in the order their state was written */
+	TArray<FSnapshotRecord> Records;
+};
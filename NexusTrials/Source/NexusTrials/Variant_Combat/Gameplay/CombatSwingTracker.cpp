@@ -0,0 +1,111 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSwingTracker.h"
+#include "Components/SkeletalMeshComponent.h"
+
+void FCombatSwingTracker::Begin(const USkeletalMeshComponent* Mesh, FName SocketName)
+{
+	Begin(Mesh->GetComponentTransform(), Mesh->GetSocketTransform(SocketName, RTS_Component).GetLocation());
+}
+
+void FCombatSwingTracker::Begin(const FTransform& MeshTransform, const FVector& ComponentLocation)
+{
+	bActive = true;
+	HitActors.Reset();
+
+	// save the starting sample
+	LastMeshTransform = MeshTransform;
+	LastComponentLocation = ComponentLocation;
+	LastWorldLocation = LastMeshTransform.TransformPosition(LastComponentLocation);
+}
+
+void FCombatSwingTracker::Advance(const USkeletalMeshComponent* Mesh, FName SocketName, float MaxSpacing, FSwingPath& OutPath)
+{
+	Advance(Mesh->GetComponentTransform(), Mesh->GetSocketTransform(SocketName, RTS_Component).GetLocation(), MaxSpacing, OutPath);
+}
+
+void FCombatSwingTracker::Advance(const FTransform& MeshTransform, const FVector& ComponentLocation, float MaxSpacing, FSwingPath& OutPath)
+{
+	OutPath.Reset();
+
+	// the path always starts where the last sample ended
+	OutPath.Add(LastWorldLocation);
+
+	const FVector WorldLocation = MeshTransform.TransformPosition(ComponentLocation);
+
+	// split the motion so no segment is longer than the max spacing
+	const float Distance = FVector::Dist(LastWorldLocation, WorldLocation);
+	const int32 NumSamples = FMath::Clamp(FMath::CeilToInt32(Distance / FMath::Max(MaxSpacing, 1.0f)), 1, MaxSubSamples);
+
+	// swings mostly rotate around the character, so interpolate the socket in polar coordinates around the mesh up axis
+	const float LastRadius = LastComponentLocation.Size2D();
+	const float Radius = ComponentLocation.Size2D();
+	const bool bUsePolar = LastRadius > UE_KINDA_SMALL_NUMBER && Radius > UE_KINDA_SMALL_NUMBER;
+
+	const float LastAngle = FMath::Atan2(LastComponentLocation.Y, LastComponentLocation.X);
+	const float DeltaAngle = FMath::FindDeltaAngleRadians(LastAngle, FMath::Atan2(ComponentLocation.Y, ComponentLocation.X));
+
+	for (int32 Sample = 1; Sample < NumSamples; ++Sample)
+	{
+		const float Alpha = static_cast<float>(Sample) / NumSamples;
+
+		FVector SampleLocation;
+
+		if (bUsePolar)
+		{
+			const float SampleAngle = LastAngle + DeltaAngle * Alpha;
+			const float SampleRadius = FMath::Lerp(LastRadius, Radius, Alpha);
+
+			SampleLocation.X = FMath::Cos(SampleAngle) * SampleRadius;
+			SampleLocation.Y = FMath::Sin(SampleAngle) * SampleRadius;
+			SampleLocation.Z = FMath::Lerp(LastComponentLocation.Z, ComponentLocation.Z, Alpha);
+		}
+		else
+		{
+			SampleLocation = FMath::Lerp(LastComponentLocation, ComponentLocation, Alpha);
+		}
+
+		// account for the character moving during the frame
+		FTransform SampleMeshTransform;
+		SampleMeshTransform.Blend(LastMeshTransform, MeshTransform, Alpha);
+
+		OutPath.Add(SampleMeshTransform.TransformPosition(SampleLocation));
+	}
+
+	// finish on the exact socket location
+	OutPath.Add(WorldLocation);
+
+	LastMeshTransform = MeshTransform;
+	LastComponentLocation = ComponentLocation;
+	LastWorldLocation = WorldLocation;
+}
+
+int32 FCombatSwingTracker::GetNumReachLayers(float Reach, float SweepRadius)
+{
+	if (Reach <= 0.0f)
+	{
+		return 0;
+	}
+
+	// neighboring layers can be up to one sphere diameter apart
+	return FMath::Max(1, FMath::CeilToInt32(Reach / FMath::Max(SweepRadius * 2.0f, 1.0f)));
+}
+
+void FCombatSwingTracker::End()
+{
+	bActive = false;
+}
+
+bool FCombatSwingTracker::RegisterHit(const AActor* Target, int32 Item)
+{
+	const TPair<const AActor*, int32> HitTarget(Target, Item);
+
+	if (!Target || HitActors.Contains(HitTarget))
+	{
+		return false;
+	}
+
+	HitActors.Add(HitTarget);
+	return true;
+}
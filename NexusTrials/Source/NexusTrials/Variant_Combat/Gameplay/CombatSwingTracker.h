@@ -0,0 +1,77 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeletalMeshComponent;
+
+/**
+ *  Tracks a single melee swing.
+ *  Samples the path of a weapon socket across frames and sub-samples between them, so fast swings
+ *  at low frame rates still produce a connected path to sweep against.
+ *  Also keeps the set of targets already hit this swing, so each target is damaged at most once.
+ *  A target is an actor plus a hit item, so actors made of many hit shapes (e.g. a box field) can be hit once per shape.
+ */
+struct FCombatSwingTracker
+{
+	/** Max number of segments a single frame's socket motion is split into */
+	static constexpr int32 MaxSubSamples = 8;
+
+	/** Path points for one frame: the previous sample plus up to MaxSubSamples new ones */
+	using FSwingPath = TArray<FVector, TInlineAllocator<MaxSubSamples + 1>>;
+
+	/** Starts a new swing window from the socket's current location. Clears the hit set */
+	void Begin(const USkeletalMeshComponent* Mesh, FName SocketName);
+
+	/** Starts a new swing window from a component space socket location and the mesh's world transform */
+	void Begin(const FTransform& MeshTransform, const FVector& ComponentLocation);
+
+	/**
+	 *  Samples the socket's current location and fills OutPath with the connected points from the last sample to it.
+	 *  Intermediate points are interpolated around the mesh's up axis to follow the arc of the swing.
+	 *  @param MaxSpacing Max distance between consecutive path points
+	 */
+	void Advance(const USkeletalMeshComponent* Mesh, FName SocketName, float MaxSpacing, FSwingPath& OutPath);
+
+	/** Same as above, from a component space socket location and the mesh's world transform */
+	void Advance(const FTransform& MeshTransform, const FVector& ComponentLocation, float MaxSpacing, FSwingPath& OutPath);
+
+	/**
+	 *  Returns how many times the reach has to be split so sweeping the path at every split, from the socket out to
+	 *  the full reach, leaves no gaps between the spheres. The path is swept NumLayers + 1 times
+	 */
+	static int32 GetNumReachLayers(float Reach, float SweepRadius);
+
+	/** Ends the swing window */
+	void End();
+
+	/** Returns true while a swing window is open */
+	bool IsActive() const { return bActive; }
+
+	/** Clears the hit set without affecting the swing window */
+	void ResetHits() { HitActors.Reset(); }
+
+	/**
+	 *  Records a hit on the provided actor. Returns false if the actor was already hit during this swing
+	 *  @param Item	Hit shape within the actor, e.g. FHitResult::Item from a damageable grid sweep. INDEX_NONE for the whole actor
+	 */
+	bool RegisterHit(const AActor* Target, int32 Item = INDEX_NONE);
+
+private:
+
+	/** Targets hit this swing. Actors are only used for identity checks, never dereferenced */
+	TArray<TPair<const AActor*, int32>, TInlineAllocator<8>> HitActors;
+
+	/** Component space socket location at the last sample */
+	FVector LastComponentLocation = FVector::ZeroVector;
+
+	/** World space socket location at the last sample */
+	FVector LastWorldLocation = FVector::ZeroVector;
+
+	/** Mesh world transform at the last sample */
+	FTransform LastMeshTransform;
+
+	/** True while a swing window is open */
+	bool bActive = false;
+};
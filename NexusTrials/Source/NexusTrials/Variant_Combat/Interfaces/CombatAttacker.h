@@ -26,6 +26,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void DoAttackTrace(FName DamageSourceBone) = 0;
 
+	/** Opens an attack window. The attack bone's path will be swept until the window ends. Usually called from a montage's AnimNotifyState */
+	UFUNCTION(BlueprintCallable, Category="Attacker")
+	virtual void BeginAttackWindow(FName DamageSourceBone) = 0;
+
+	/** Sweeps the attack bone's path since the last update of the attack window. Usually called from a montage's AnimNotifyState */
+	UFUNCTION(BlueprintCallable, Category="Attacker")
+	virtual void TickAttackWindow(FName DamageSourceBone) = 0;
+
+	/** Sweeps the remainder of the attack bone's path and closes the attack window. Usually called from a montage's AnimNotifyState */
+	UFUNCTION(BlueprintCallable, Category="Attacker")
+	virtual void EndAttackWindow(FName DamageSourceBone) = 0;
+
 	/** Performs a combo attack's check to continue the string. Usually called from a montage's AnimNotify */
 	UFUNCTION(BlueprintCallable, Category="Attacker")
 	virtual void CheckCombo() = 0;
@@ -0,0 +1,6 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatCachedEnvQueryContext.h"
+
+// Add default functionality here for any ICombatCachedEnvQueryContext functions that are not pure virtual.
@@ -0,0 +1,28 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "CombatCachedEnvQueryContext.generated.h"
+
+/**
+ *  CombatCachedEnvQueryContext interface
+ *  Lets an EnvQuery context report the location it would provide for a querier without running a query,
+ *  so the EQS result cache can key shared results on it
+ */
+UINTERFACE(MinimalAPI, NotBlueprintable)
+class UCombatCachedEnvQueryContext : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class ICombatCachedEnvQueryContext
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the location this context provides for the querier, or false if it provides nothing */
+	virtual bool GetContextLocation(const AActor* Querier, FVector& OutLocation) const = 0;
+};
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
+#include "Engine/HitResult.h"
+#include "CombatFaction.h"
 #include "CombatDamageable.generated.h"
 
 /**
@@ -27,6 +29,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Damageable")
 	virtual void ApplyDamage(float Damage, AActor* DamageCauser, const FVector& DamageLocation, const FVector& DamageImpulse) = 0;
 
+	/** Handles damage from a melee hit. Actors made of many hit shapes can override it to damage the exact shape in the hit */
+	virtual void ApplyHitDamage(float Damage, AActor* DamageCauser, const FHitResult& Hit, const FVector& DamageImpulse) { ApplyDamage(Damage, DamageCauser, Hit.ImpactPoint, DamageImpulse); }
+
 	/** Handles death events */
 	UFUNCTION(BlueprintCallable, Category="Damageable")
 	virtual void HandleDeath() = 0;
@@ -38,4 +43,7 @@ public:
 	/** Notifies the actor of impending danger such as an incoming hit, allowing it to react. */
 	UFUNCTION(BlueprintCallable, Category="Damageable")
 	virtual void NotifyDanger(const FVector& DangerLocation, AActor* DangerSource) = 0;
+
+	/** Returns the faction the actor fights for. Used to filter melee hits and danger through the hostility matrix */
+	virtual ECombatFaction GetFaction() const { return ECombatFaction::Neutral; }
 };
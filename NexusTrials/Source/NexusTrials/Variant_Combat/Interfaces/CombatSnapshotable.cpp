@@ -0,0 +1,6 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatSnapshotable.h"
+
+// Add default functionality here for any ICombatSnapshotable functions that are not pure virtual.
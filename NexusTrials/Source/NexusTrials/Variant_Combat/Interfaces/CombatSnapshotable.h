@@ -0,0 +1,34 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Interface.h"
+#include "CombatSnapshotable.generated.h"
+
+/**
+ *  CombatSnapshotable interface
+ *  Lets an actor write its mutable gameplay state into an arena snapshot and restore it in place
+ *  Actors opt in by registering with the snapshot subsystem on BeginPlay
+ */
+UINTERFACE(MinimalAPI, NotBlueprintable)
+class UCombatSnapshotable : public UInterface
+{
+	GENERATED_BODY()
+};
+
+class ICombatSnapshotable
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Saves or loads the actor's mutable state. When loading, the state is applied to the actor right away */
+	virtual void SerializeSnapshot(FArchive& Ar) = 0;
+
+	/** Called once every snapshotted actor has loaded its state, to rebuild links between actors such as delegate bindings */
+	virtual void PostSnapshotRestore() {}
+
+	/** Called on restore for actors that registered after the snapshot was captured, so they can take themselves out of play */
+	virtual void DiscardForSnapshot() {}
+};
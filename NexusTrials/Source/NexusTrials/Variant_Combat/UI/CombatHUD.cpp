@@ -0,0 +1,67 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHUD.h"
+#include "CombatHealthBarSubsystem.h"
+#include "Engine/Canvas.h"
+#include "CanvasItem.h"
+#include "SceneView.h"
+#include "TextureResource.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Health Bar Draw"), STAT_CombatHealthBarDraw, STATGROUP_NexusTrials);
+
+void ACombatHUD::DrawHUD()
+{
+	Super::DrawHUD();
+
+	DrawHealthBars();
+}
+
+void ACombatHUD::DrawHealthBars()
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHealthBarDraw);
+
+	// we need the scene view to project the bars
+	if (!Canvas || !Canvas->SceneView)
+	{
+		return;
+	}
+
+	UCombatHealthBarSubsystem* HealthBars = UCombatHealthBarSubsystem::Get(this);
+
+	if (!HealthBars || HealthBars->GetNumBars() == 0)
+	{
+		return;
+	}
+
+	const FSceneView* View = Canvas->SceneView;
+
+	const TArray<FCombatHealthBarDrawItem>& Items = HealthBars->GatherVisibleBars(View->ViewMatrices.GetViewProjectionMatrix(), View->UnscaledViewRect, View->ViewMatrices.GetViewOrigin(), HealthBarMaxDistance);
+
+	// every bar uses the same texture and blend mode, so the canvas batches them all into a single draw
+	FCanvasTileItem Tile(FVector2D::ZeroVector, GWhiteTexture, FVector2D::ZeroVector, FLinearColor::White);
+	Tile.BlendMode = SE_BLEND_Translucent;
+
+	for (const FCombatHealthBarDrawItem& Item : Items)
+	{
+		// shrink the bar with distance
+		const float Scale = FMath::Clamp(HealthBarReferenceDistance / FMath::Max(Item.Distance, 1.0f), HealthBarMinScale, 1.0f);
+		const FVector2D Size = HealthBarSize * Scale;
+		const FVector2D TopLeft = Item.ScreenPosition - Size * 0.5f;
+
+		// draw the background
+		Tile.Position = TopLeft;
+		Tile.Size = Size;
+		Tile.SetColor(HealthBarBackgroundColor);
+		Canvas->DrawItem(Tile);
+
+		// draw the fill
+		if (Item.Percent > 0.0f)
+		{
+			Tile.Size = FVector2D(Size.X * Item.Percent, Size.Y);
+			Tile.SetColor(Item.Color);
+			Canvas->DrawItem(Tile);
+		}
+	}
+}
@@ -0,0 +1,49 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "CombatHUD.generated.h"
+
+/**
+ *  Combat HUD.
+ *  Draws the health bars of every combatant in a single batched canvas pass
+ */
+UCLASS()
+class ACombatHUD : public AHUD
+{
+	GENERATED_BODY()
+
+protected:
+
+	/** Size of a health bar at the reference distance */
+	UPROPERTY(EditAnywhere, Category="Health Bars")
+	FVector2D HealthBarSize = FVector2D(80.0f, 8.0f);
+
+	/** Color of the empty part of a health bar */
+	UPROPERTY(EditAnywhere, Category="Health Bars")
+	FLinearColor HealthBarBackgroundColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.6f);
+
+	/** Distance at which health bars are drawn at their full size. Bars further away shrink */
+	UPROPERTY(EditAnywhere, Category="Health Bars", meta = (ClampMin = 1, ClampMax = 10000, Units = "cm"))
+	float HealthBarReferenceDistance = 600.0f;
+
+	/** Smallest scale a far away health bar shrinks to */
+	UPROPERTY(EditAnywhere, Category="Health Bars", meta = (ClampMin = 0, ClampMax = 1))
+	float HealthBarMinScale = 0.4f;
+
+	/** Health bars further than this from the camera aren't drawn */
+	UPROPERTY(EditAnywhere, Category="Health Bars", meta = (ClampMin = 0, ClampMax = 100000, Units = "cm"))
+	float HealthBarMaxDistance = 5000.0f;
+
+public:
+
+	/** Draws the HUD */
+	virtual void DrawHUD() override;
+
+protected:
+
+	/** Draws all visible health bars */
+	void DrawHealthBars();
+};
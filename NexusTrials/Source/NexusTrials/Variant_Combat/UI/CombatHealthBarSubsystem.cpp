@@ -0,0 +1,155 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+
+#include "CombatHealthBarSubsystem.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "SceneView.h"
+#include "NexusTrials.h"
+
+DECLARE_CYCLE_STAT(TEXT("Health Bar Gather"), STAT_CombatHealthBarGather, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Health Bars Drawn"), STAT_CombatHealthBarsDrawn, STATGROUP_NexusTrials);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Health Bars Projected"), STAT_CombatHealthBarsProjected, STATGROUP_NexusTrials);
+
+UCombatHealthBarSubsystem* UCombatHealthBarSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UCombatHealthBarSubsystem>() : nullptr;
+}
+
+bool UCombatHealthBarSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UCombatHealthBarSubsystem::RegisterBar(USceneComponent* Anchor, const FVector& Offset, const FLinearColor& Color)
+{
+	if (!IsValid(Anchor))
+	{
+		return INDEX_NONE;
+	}
+
+	FHealthBar Bar;
+	Bar.Anchor = Anchor;
+	Bar.Offset = Offset;
+	Bar.Color = Color;
+
+	return Bars.Add(MoveTemp(Bar));
+}
+
+void UCombatHealthBarSubsystem::UnregisterBar(int32& Handle)
+{
+	if (Bars.IsValidIndex(Handle))
+	{
+		Bars.RemoveAt(Handle);
+	}
+
+	Handle = INDEX_NONE;
+}
+
+void UCombatHealthBarSubsystem::SetPercent(int32 Handle, float Percent)
+{
+	// the fill amount doesn't affect the projection, so this stays a plain write
+	if (Bars.IsValidIndex(Handle))
+	{
+		Bars[Handle].Percent = FMath::Clamp(Percent, 0.0f, 1.0f);
+	}
+}
+
+void UCombatHealthBarSubsystem::SetColor(int32 Handle, const FLinearColor& Color)
+{
+	if (Bars.IsValidIndex(Handle))
+	{
+		Bars[Handle].Color = Color;
+	}
+}
+
+void UCombatHealthBarSubsystem::SetVisible(int32 Handle, bool bVisible)
+{
+	if (Bars.IsValidIndex(Handle))
+	{
+		FHealthBar& Bar = Bars[Handle];
+
+		// a bar that was hidden may have moved without being projected
+		if (bVisible && !Bar.bVisible)
+		{
+			Bar.bDirty = true;
+		}
+
+		Bar.bVisible = bVisible;
+	}
+}
+
+const TArray<FCombatHealthBarDrawItem>& UCombatHealthBarSubsystem::GatherVisibleBars(const FMatrix& ViewProjectionMatrix, const FIntRect& ViewRect, const FVector& ViewOrigin, float MaxDistance)
+{
+	SCOPE_CYCLE_COUNTER(STAT_CombatHealthBarGather);
+
+	DrawItems.Reset();
+
+	// a new view invalidates every cached projection
+	const bool bViewChanged = !ViewProjectionMatrix.Equals(CachedViewProjectionMatrix, 0.0f) || ViewRect != CachedViewRect || MaxDistance != CachedMaxDistance;
+
+	if (bViewChanged)
+	{
+		CachedViewProjectionMatrix = ViewProjectionMatrix;
+		CachedViewRect = ViewRect;
+		CachedMaxDistance = MaxDistance;
+	}
+
+	const float MaxDistanceSquared = FMath::Square(MaxDistance);
+	int32 NumProjected = 0;
+
+	for (FHealthBar& Bar : Bars)
+	{
+		if (!Bar.bVisible)
+		{
+			continue;
+		}
+
+		const USceneComponent* Anchor = Bar.Anchor.Get();
+
+		if (!Anchor)
+		{
+			continue;
+		}
+
+		const FVector Location = Anchor->GetComponentLocation() + Bar.Offset;
+
+		// only project bars that moved, or all of them if the view moved
+		if (bViewChanged || Bar.bDirty || !Location.Equals(Bar.CachedLocation, 0.0f))
+		{
+			++NumProjected;
+
+			Bar.CachedLocation = Location;
+			Bar.bDirty = false;
+
+			const float DistanceSquared = FVector::DistSquared(ViewOrigin, Location);
+			Bar.CachedDistance = FMath::Sqrt(DistanceSquared);
+
+			FVector2D ScreenPosition;
+			Bar.bCachedOnScreen = DistanceSquared <= MaxDistanceSquared
+				&& FSceneView::ProjectWorldToScreen(Location, ViewRect, ViewProjectionMatrix, ScreenPosition)
+				&& ScreenPosition.X >= ViewRect.Min.X && ScreenPosition.X <= ViewRect.Max.X
+				&& ScreenPosition.Y >= ViewRect.Min.Y && ScreenPosition.Y <= ViewRect.Max.Y;
+
+			Bar.CachedScreenPosition = ScreenPosition;
+		}
+
+		// cull off screen bars
+		if (!Bar.bCachedOnScreen)
+		{
+			continue;
+		}
+
+		FCombatHealthBarDrawItem& Item = DrawItems.AddUninitialized_GetRef();
+		Item.ScreenPosition = Bar.CachedScreenPosition;
+		Item.Distance = Bar.CachedDistance;
+		Item.Percent = Bar.Percent;
+		Item.Color = Bar.Color;
+	}
+
+	SET_DWORD_STAT(STAT_CombatHealthBarsDrawn, DrawItems.Num());
+	SET_DWORD_STAT(STAT_CombatHealthBarsProjected, NumProjected);
+
+	return DrawItems;
+}
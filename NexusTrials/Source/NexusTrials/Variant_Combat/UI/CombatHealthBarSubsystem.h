@@ -0,0 +1,105 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CombatHealthBarSubsystem.generated.h"
+
+class USceneComponent;
+
+/**
+ *  One health bar ready to be drawn this frame
+ */
+struct FCombatHealthBarDrawItem
+{
+	/** Screen position of the bar's center, in pixels */
+	FVector2D ScreenPosition;
+
+	/** Distance from the view, used to scale the bar */
+	float Distance;
+
+	/** Fill amount, 0-1 */
+	float Percent;
+
+	/** Fill color */
+	FLinearColor Color;
+};
+
+/**
+ *  Flat list of health bars for every combatant in the world.
+ *  Combatants push their HP percentage into it when it changes instead of owning a widget,
+ *  and the HUD draws all visible bars in a single batched pass.
+ *  Bars are only projected again when their anchor or the view has moved.
+ */
+UCLASS()
+class UCombatHealthBarSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Returns the health bar list for the world the provided object lives in, if any */
+	static UCombatHealthBarSubsystem* Get(const UObject* WorldContextObject);
+
+	/** Adds a health bar that follows the provided component at an offset. Returns a handle to update it with */
+	int32 RegisterBar(USceneComponent* Anchor, const FVector& Offset, const FLinearColor& Color);
+
+	/** Removes a health bar and resets the handle */
+	void UnregisterBar(int32& Handle);
+
+	/** Sets the fill amount of a health bar to the provided 0-1 percentage value */
+	void SetPercent(int32 Handle, float Percent);
+
+	/** Sets the fill color of a health bar */
+	void SetColor(int32 Handle, const FLinearColor& Color);
+
+	/** Shows or hides a health bar */
+	void SetVisible(int32 Handle, bool bVisible);
+
+	/** Returns the number of registered health bars */
+	int32 GetNumBars() const { return Bars.Num(); }
+
+	/**
+	 *  Projects the visible health bars for the provided view and returns the ones that are on screen.
+	 *  The returned array is reused every frame.
+	 */
+	const TArray<FCombatHealthBarDrawItem>& GatherVisibleBars(const FMatrix& ViewProjectionMatrix, const FIntRect& ViewRect, const FVector& ViewOrigin, float MaxDistance);
+
+protected:
+
+	/** Only create the health bar list for game worlds */
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	/** One registered health bar */
+	struct FHealthBar
+	{
+		TWeakObjectPtr<USceneComponent> Anchor;
+		FVector Offset = FVector::ZeroVector;
+		FLinearColor Color = FLinearColor::Red;
+		float Percent = 1.0f;
+		bool bVisible = true;
+
+		/** Anchor location the cached projection was computed for */
+		FVector CachedLocation = FVector::ZeroVector;
+
+		/** Cached projection */
+		FVector2D CachedScreenPosition = FVector2D::ZeroVector;
+		float CachedDistance = 0.0f;
+		bool bCachedOnScreen = false;
+
+		/** If true, the cached projection must be recomputed */
+		bool bDirty = true;
+	};
+
+	/** Registered health bars */
+	TSparseArray<FHealthBar> Bars;
+
+	/** Bars drawn this frame */
+	TArray<FCombatHealthBarDrawItem> DrawItems;
+
+	/** View the cached projections were computed for */
+	FMatrix CachedViewProjectionMatrix = FMatrix::Identity;
+	FIntRect CachedViewRect;
+	float CachedMaxDistance = 0.0f;
+};
@@ -13,6 +13,7 @@
 #include "EnhancedInputComponent.h"
 #include "TimerManager.h"
 #include "Engine/LocalPlayer.h"
+#include "Performance/NexusSignificanceSubsystem.h"
 
 APlatformingCharacter::APlatformingCharacter()
 {
@@ -311,12 +312,29 @@ bool APlatformingCharacter::HasWallJumped() const
 	return bHasWallJumped;
 }
 
+void APlatformingCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the significance manager. Player controlled pawns always stay at full tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this, false);
+	}
+}
+
 void APlatformingCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the wall jump reset timer
 	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
 }
 
 void APlatformingCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
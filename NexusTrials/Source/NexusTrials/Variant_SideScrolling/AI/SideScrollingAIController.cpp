@@ -3,6 +3,7 @@
 
 #include "SideScrollingAIController.h"
 #include "GameplayStateTreeModule/Public/Components/StateTreeAIComponent.h"
+#include "Performance/NexusAILODSubsystem.h"
 
 ASideScrollingAIController::ASideScrollingAIController()
 {
@@ -17,3 +18,25 @@ ASideScrollingAIController::ASideScrollingAIController()
 	// this is necessary for EnvQueries to work correctly
 	bAttachToPawn = true;
 }
+
+void ASideScrollingAIController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	// evaluate the StateTree less often while our pawn is distant or idle
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->RegisterController(this);
+	}
+}
+
+void ASideScrollingAIController::OnUnPossess()
+{
+	// stop managing our StateTree
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->UnregisterController(this);
+	}
+
+	Super::OnUnPossess();
+}
@@ -24,4 +24,12 @@ public:
 
 	/** Constructor */
 	ASideScrollingAIController();
+
+protected:
+
+	/** Hands the StateTree's evaluation rate to the AI LOD manager */
+	virtual void OnPossess(APawn* InPawn) override;
+
+	/** Takes the StateTree back from the AI LOD manager */
+	virtual void OnUnPossess() override;
 };
@@ -5,6 +5,10 @@
 #include "Engine/World.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "TimerManager.h"
+#include "Performance/NexusSignificanceSubsystem.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
+#include "Performance/NexusAILODSubsystem.h"
+#include "Performance/NexusMovementLODSubsystem.h"
 
 ASideScrollingNPC::ASideScrollingNPC()
 {
@@ -13,12 +17,51 @@ ASideScrollingNPC::ASideScrollingNPC()
 	GetCharacterMovement()->MaxWalkSpeed = 150.0f;
 }
 
+void ASideScrollingNPC::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// let the significance manager scale our tick rate with distance to the player
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this);
+	}
+
+	// follow the navmesh instead of running the full walking simulation while we're far from the player
+	if (UNexusMovementLODSubsystem* MovementLOD = UNexusMovementLODSubsystem::Get(this))
+	{
+		MovementLOD->RegisterCharacter(this);
+	}
+
+	// have our distance to the player computed with everyone else's once per frame
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->RegisterAgent(this);
+	}
+}
+
 void ASideScrollingNPC::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the deactivation timer
 	GetWorld()->GetTimerManager().ClearTimer(DeactivationTimer);
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
+
+	if (UNexusMovementLODSubsystem* MovementLOD = UNexusMovementLODSubsystem::Get(this))
+	{
+		MovementLOD->UnregisterCharacter(this);
+	}
+
+	if (UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(this))
+	{
+		TargetSnapshot->UnregisterAgent(this);
+	}
 }
 
 void ASideScrollingNPC::Interaction(AActor* Interactor)
@@ -42,6 +85,12 @@ void ASideScrollingNPC::Interaction(AActor* Interactor)
 
 	LaunchCharacter(LaunchVector, true, true);
 
+	// have the StateTree react to the hit this frame
+	if (UNexusAILODSubsystem* AILOD = UNexusAILODSubsystem::Get(this))
+	{
+		AILOD->RequestImmediateEvaluation(this);
+	}
+
 	// set up a timer to schedule reactivation
 	GetWorld()->GetTimerManager().SetTimer(DeactivationTimer, this, &ASideScrollingNPC::ResetDeactivation, DeactivationTime, false);
 }
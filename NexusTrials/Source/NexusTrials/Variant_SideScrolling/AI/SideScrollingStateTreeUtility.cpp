@@ -5,15 +5,35 @@
 #include "StateTreeExecutionContext.h"
 #include "StateTreeExecutionTypes.h"
 #include "AIController.h"
-#include "Kismet/GameplayStatics.h"
+#include "Performance/NexusTargetSnapshotSubsystem.h"
 
 EStateTreeRunStatus FStateTreeGetPlayerTask::Tick(FStateTreeExecutionContext& Context, const float DeltaTime) const
 {
 	// get the instance data
 	FInstanceDataType& InstanceData = Context.GetInstanceData(*this);
 
-	// set the player pawn as the target
-	InstanceData.TargetPlayer = UGameplayStatics::GetPlayerPawn(InstanceData.Controller.Get(), 0);
+	// read the nearest player from the shared per-frame snapshot
+	if (const UNexusTargetSnapshotSubsystem* TargetSnapshot = UNexusTargetSnapshotSubsystem::Get(InstanceData.NPC))
+	{
+		FNexusTargetInfo TargetInfo;
+
+		if (TargetSnapshot->GetTargetInfo(InstanceData.NPC, TargetInfo))
+		{
+			InstanceData.TargetPlayer = TargetInfo.Target.Get();
+			InstanceData.bValidTarget = InstanceData.TargetPlayer && TargetInfo.DistanceSquared < FMath::Square(InstanceData.RangeMax);
+
+			return EStateTreeRunStatus::Running;
+		}
+
+		// we haven't picked a target yet, so search the snapshot directly
+		InstanceData.TargetPlayer = IsValid(InstanceData.NPC) ? TargetSnapshot->FindNearestTarget(InstanceData.NPC->GetActorLocation(), MAX_uint32, InstanceData.RangeMax, InstanceData.NPC) : nullptr;
+
+	} else {
+
+		InstanceData.TargetPlayer = nullptr;
+	}
+
+	InstanceData.bValidTarget = false;
 
 	// are the NPC and target valid?
 	if (IsValid(InstanceData.TargetPlayer) && IsValid(InstanceData.NPC))
@@ -6,6 +6,7 @@
 #include "Components/StaticMeshComponent.h"
 #include "Components/BoxComponent.h"
 #include "SideScrollingCharacter.h"
+#include "Performance/NexusSignificanceSubsystem.h"
 
 ASideScrollingSoftPlatform::ASideScrollingSoftPlatform()
 {
@@ -36,6 +37,28 @@ ASideScrollingSoftPlatform::ASideScrollingSoftPlatform()
 	CollisionCheckBox->OnComponentBeginOverlap.AddDynamic(this, &ASideScrollingSoftPlatform::OnSoftCollisionOverlap);
 }
 
+void ASideScrollingSoftPlatform::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// overlaps don't need our tick, so let the significance manager put us to sleep when far away
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this);
+	}
+}
+
+void ASideScrollingSoftPlatform::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
+}
+
 void ASideScrollingSoftPlatform::OnSoftCollisionOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
 	// have we overlapped a character?
@@ -13,6 +13,7 @@
 #include "SideScrollingInteractable.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "TimerManager.h"
+#include "Performance/NexusSignificanceSubsystem.h"
 
 ASideScrollingCharacter::ASideScrollingCharacter()
 {
@@ -59,12 +60,29 @@ ASideScrollingCharacter::ASideScrollingCharacter()
 	JumpMaxCount = 3;
 }
 
+void ASideScrollingCharacter::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// register with the significance manager. Player controlled pawns always stay at full tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->RegisterActor(this, false);
+	}
+}
+
 void ASideScrollingCharacter::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
 	// clear the wall jump timer
 	GetWorld()->GetTimerManager().ClearTimer(WallJumpTimer);
+
+	// stop managing our tick rate
+	if (UNexusSignificanceSubsystem* Significance = UNexusSignificanceSubsystem::Get(this))
+	{
+		Significance->UnregisterActor(this);
+	}
 }
 
 void ASideScrollingCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)